@@ -5,7 +5,9 @@
 
 #include "dynarray.h"
 #include <assert.h>
+#include <pthread.h>
 #include <stdlib.h>
+#include <string.h>
 
 /*--------------------------------------------------------------------*/
 
@@ -13,6 +15,29 @@
 
 static const size_t MIN_PHYS_LENGTH = 2;
 
+/* The maximum physical length of a DynArray object, beyond which the
+   size of its array in bytes would overflow. */
+
+static const size_t MAX_PHYS_LENGTH = (size_t)-1 / sizeof(void*);
+
+/* The growth factor of a new DynArray object, as a percentage. */
+
+static const size_t DEFAULT_GROWTH_PERCENT = 200;
+
+/* A DynArray object shrinks once no more than 1/SHRINK_DIVISOR of its
+   physical length is in use. */
+
+static const size_t SHRINK_DIVISOR = 4;
+
+/* The size of a cache line. */
+
+enum { CACHE_LINE_BYTES = 64 };
+
+/* DynArray_mapParallel splits the array into about this many chunks
+   per thread. */
+
+enum { MAP_CHUNKS_PER_THREAD = 16 };
+
 /*--------------------------------------------------------------------*/
 
 /* A DynArray consists of an array, along with its logical and
@@ -30,6 +55,10 @@ struct DynArray
 
    /* The array that underlies the DynArray. */
    const void **ppvArray;
+
+   /* The factor by which the physical length grows when the array
+      is full, as a percentage. */
+   size_t uGrowthPercent;
 };
 
 /*--------------------------------------------------------------------*/
@@ -44,6 +73,7 @@ static int DynArray_isValid(DynArray_T oDynArray)
    if (oDynArray->uPhysLength < MIN_PHYS_LENGTH) return 0;
    if (oDynArray->uLength > oDynArray->uPhysLength) return 0;
    if (oDynArray->ppvArray == NULL) return 0;
+   if (oDynArray->uGrowthPercent <= 100) return 0;
    return 1;
 }
 
@@ -51,19 +81,23 @@ static int DynArray_isValid(DynArray_T oDynArray)
 
 /*--------------------------------------------------------------------*/
 
-/* Increase the physical length of oDynArray.  Return 1 (TRUE) if
-   successful and 0 (FALSE) if insufficient memory is available. */
+/* Change the physical length of oDynArray to uNewLength, which must
+   be at least its length and MIN_PHYS_LENGTH.  Return 1 (TRUE) if
+   successful and 0 (FALSE), leaving oDynArray unchanged, if
+   insufficient memory is available. */
 
-static int DynArray_grow(DynArray_T oDynArray)
+static int DynArray_resize(DynArray_T oDynArray, size_t uNewLength)
 {
-   const size_t GROWTH_FACTOR = 2;
-
-   size_t uNewLength;
    const void **ppvNewArray;
 
    assert(oDynArray != NULL);
+   assert(uNewLength >= oDynArray->uLength);
+   assert(uNewLength >= MIN_PHYS_LENGTH);
 
-   uNewLength = GROWTH_FACTOR * oDynArray->uPhysLength;
+   if (uNewLength == oDynArray->uPhysLength)
+      return 1;
+   if (uNewLength > MAX_PHYS_LENGTH)
+      return 0;
 
    ppvNewArray = (const void**)
       realloc(oDynArray->ppvArray, sizeof(void*) * uNewLength);
@@ -77,6 +111,65 @@ static int DynArray_grow(DynArray_T oDynArray)
 
 /*--------------------------------------------------------------------*/
 
+/* Increase the physical length of oDynArray to at least uMinLength,
+   by its growth factor as many times as needed.  Return 1 (TRUE) if
+   successful and 0 (FALSE) if insufficient memory is available. */
+
+static int DynArray_grow(DynArray_T oDynArray, size_t uMinLength)
+{
+   size_t uNewLength;
+   size_t uNextLength;
+
+   assert(oDynArray != NULL);
+
+   if (uMinLength > MAX_PHYS_LENGTH)
+      return 0;
+
+   uNewLength = oDynArray->uPhysLength;
+   while (uNewLength < uMinLength)
+   {
+      /* near the maximum, grow only as far as needed */
+      if (uNewLength / 100 >=
+          MAX_PHYS_LENGTH / oDynArray->uGrowthPercent)
+      {
+         uNewLength = uMinLength;
+         break;
+      }
+      uNextLength = uNewLength / 100 * oDynArray->uGrowthPercent +
+         uNewLength % 100 * oDynArray->uGrowthPercent / 100;
+      /* always grow by at least one element */
+      if (uNextLength <= uNewLength)
+         uNextLength = uNewLength + 1;
+      uNewLength = uNextLength;
+   }
+
+   return DynArray_resize(oDynArray, uNewLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Halve the physical length of oDynArray, as many times as needed,
+   while no more than 1/SHRINK_DIVISOR of it is in use. Since the
+   array is then at most half full, alternately adding and removing
+   elements does not make it grow and shrink repeatedly. If memory
+   cannot be reallocated, oDynArray keeps its physical length. */
+
+static void DynArray_shrink(DynArray_T oDynArray)
+{
+   size_t uNewLength;
+
+   assert(oDynArray != NULL);
+
+   uNewLength = oDynArray->uPhysLength;
+   while (uNewLength / 2 >= MIN_PHYS_LENGTH &&
+          oDynArray->uLength <= uNewLength / SHRINK_DIVISOR)
+      uNewLength /= 2;
+
+   (void) DynArray_resize(oDynArray, uNewLength);
+}
+
+/*--------------------------------------------------------------------*/
+
 DynArray_T DynArray_new(size_t uLength)
 {
    DynArray_T oDynArray;
@@ -90,6 +183,7 @@ DynArray_T DynArray_new(size_t uLength)
       oDynArray->uPhysLength = uLength;
    else
       oDynArray->uPhysLength = MIN_PHYS_LENGTH;
+   oDynArray->uGrowthPercent = DEFAULT_GROWTH_PERCENT;
 
    oDynArray->ppvArray =
       (const void**)calloc(oDynArray->uPhysLength, sizeof(void*));
@@ -161,7 +255,7 @@ int DynArray_add(DynArray_T oDynArray, const void *pvElement)
    assert(DynArray_isValid(oDynArray));
 
    if (oDynArray->uLength == oDynArray->uPhysLength)
-      if (! DynArray_grow(oDynArray))
+      if (! DynArray_grow(oDynArray, oDynArray->uLength + 1))
          return 0;
 
    oDynArray->ppvArray[oDynArray->uLength] = pvElement;
@@ -177,21 +271,113 @@ int DynArray_add(DynArray_T oDynArray, const void *pvElement)
 int DynArray_addAt(DynArray_T oDynArray, size_t uIndex,
                    const void *pvElement)
 {
-   size_t u;
+   assert(oDynArray != NULL);
+   assert(uIndex <= oDynArray->uLength);
+   assert(DynArray_isValid(oDynArray));
+
+   return DynArray_insertRange(oDynArray, uIndex,
+                               (void *const *)&pvElement, 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *DynArray_removeAt(DynArray_T oDynArray, size_t uIndex)
+{
+   const void *pvOldElement;
+
+   assert(oDynArray != NULL);
+   assert(uIndex < oDynArray->uLength);
+   assert(DynArray_isValid(oDynArray));
+
+   pvOldElement = oDynArray->ppvArray[uIndex];
+   DynArray_removeRange(oDynArray, uIndex, 1);
+
+   return (void*)pvOldElement;
+}
 
+/*--------------------------------------------------------------------*/
+
+int DynArray_insertRange(DynArray_T oDynArray, size_t uIndex,
+                         void *const *ppvElements, size_t uCount)
+{
    assert(oDynArray != NULL);
    assert(uIndex <= oDynArray->uLength);
+   assert(ppvElements != NULL || uCount == 0);
    assert(DynArray_isValid(oDynArray));
 
-   if (oDynArray->uLength == oDynArray->uPhysLength)
-      if (! DynArray_grow(oDynArray))
+   if (uCount == 0)
+      return 1;
+   if (uCount > MAX_PHYS_LENGTH - oDynArray->uLength)
+      return 0;
+
+   if (uCount > oDynArray->uPhysLength - oDynArray->uLength)
+      if (! DynArray_grow(oDynArray, oDynArray->uLength + uCount))
          return 0;
 
-   for (u = oDynArray->uLength; u > uIndex; u--)
-      oDynArray->ppvArray[u] = oDynArray->ppvArray[u-1];
+   memmove(&oDynArray->ppvArray[uIndex + uCount],
+           &oDynArray->ppvArray[uIndex],
+           sizeof(void*) * (oDynArray->uLength - uIndex));
+   memcpy(&oDynArray->ppvArray[uIndex], ppvElements,
+          sizeof(void*) * uCount);
+   oDynArray->uLength += uCount;
 
-   oDynArray->ppvArray[uIndex] = pvElement;
-   oDynArray->uLength++;
+   assert(DynArray_isValid(oDynArray));
+
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void DynArray_removeRange(DynArray_T oDynArray, size_t uIndex,
+                          size_t uCount)
+{
+   assert(oDynArray != NULL);
+   assert(uIndex <= oDynArray->uLength);
+   assert(uCount <= oDynArray->uLength - uIndex);
+   assert(DynArray_isValid(oDynArray));
+
+   memmove(&oDynArray->ppvArray[uIndex],
+           &oDynArray->ppvArray[uIndex + uCount],
+           sizeof(void*) * (oDynArray->uLength - uIndex - uCount));
+   oDynArray->uLength -= uCount;
+
+   if (oDynArray->uLength <= oDynArray->uPhysLength / SHRINK_DIVISOR)
+      DynArray_shrink(oDynArray);
+
+   assert(DynArray_isValid(oDynArray));
+}
+
+/*--------------------------------------------------------------------*/
+
+void DynArray_clear(DynArray_T oDynArray)
+{
+   assert(oDynArray != NULL);
+   assert(DynArray_isValid(oDynArray));
+
+   oDynArray->uLength = 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+int DynArray_appendArray(DynArray_T oDynArray, DynArray_T oOther)
+{
+   size_t uCount;
+
+   assert(oDynArray != NULL);
+   assert(oOther != NULL);
+   assert(DynArray_isValid(oDynArray));
+   assert(DynArray_isValid(oOther));
+
+   /* oOther may be oDynArray itself, so read its length before it
+      grows and its elements after */
+   uCount = oOther->uLength;
+   if (uCount > oDynArray->uPhysLength - oDynArray->uLength)
+      if (! DynArray_grow(oDynArray, oDynArray->uLength + uCount))
+         return 0;
+
+   memcpy(&oDynArray->ppvArray[oDynArray->uLength], oOther->ppvArray,
+          sizeof(void*) * uCount);
+   oDynArray->uLength += uCount;
 
    assert(DynArray_isValid(oDynArray));
 
@@ -200,25 +386,41 @@ int DynArray_addAt(DynArray_T oDynArray, size_t uIndex,
 
 /*--------------------------------------------------------------------*/
 
-void *DynArray_removeAt(DynArray_T oDynArray, size_t uIndex)
+int DynArray_reserve(DynArray_T oDynArray, size_t uLength)
 {
-   const void *pvOldElement;
-   size_t u;
+   assert(oDynArray != NULL);
+   assert(DynArray_isValid(oDynArray));
+
+   if (uLength <= oDynArray->uPhysLength)
+      return 1;
+
+   return DynArray_resize(oDynArray, uLength);
+}
 
+/*--------------------------------------------------------------------*/
+
+void DynArray_shrinkToFit(DynArray_T oDynArray)
+{
    assert(oDynArray != NULL);
-   assert(uIndex < oDynArray->uLength);
    assert(DynArray_isValid(oDynArray));
 
-   pvOldElement = oDynArray->ppvArray[uIndex];
+   if (oDynArray->uLength > MIN_PHYS_LENGTH)
+      (void) DynArray_resize(oDynArray, oDynArray->uLength);
+   else
+      (void) DynArray_resize(oDynArray, MIN_PHYS_LENGTH);
 
-   oDynArray->uLength--;
+   assert(DynArray_isValid(oDynArray));
+}
 
-   for (u = uIndex; u < oDynArray->uLength; u++)
-      oDynArray->ppvArray[u] = oDynArray->ppvArray[u+1];
+/*--------------------------------------------------------------------*/
 
+void DynArray_setGrowthPercent(DynArray_T oDynArray, size_t uPercent)
+{
+   assert(oDynArray != NULL);
+   assert(uPercent > 100);
    assert(DynArray_isValid(oDynArray));
 
-   return (void*)pvOldElement;
+   oDynArray->uGrowthPercent = uPercent;
 }
 
 /*--------------------------------------------------------------------*/
@@ -253,60 +455,769 @@ void DynArray_map(DynArray_T oDynArray,
 
 /*--------------------------------------------------------------------*/
 
-/* Sort the array of elements that resides in memory at
-   addresses ppvLo...ppvHi in ascending order, as determined
-   by *pfCompare.
+/* Return uTotal * uPart / uParts, rounded down, without overflow. */
+
+static size_t DynArray_share(size_t uTotal, size_t uPart, size_t uParts)
+{
+   assert(uParts != 0);
+   assert(uPart <= uParts);
+
+   return uTotal / uParts * uPart + uTotal % uParts * uPart / uParts;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Perform the uCount tasks of uTaskSize bytes each at pvTasks
+   concurrently by calling *pfRun with the address of each: one in the
+   calling thread and each other in a new thread whose handle is
+   stored in the corresponding element of paThreads. Tasks for which
+   no thread can be created are performed in the calling thread.
+   Return when all are done. */
+
+static void DynArray_runTasks(void *pvTasks, size_t uTaskSize,
+                              size_t uCount,
+                              void *(*pfRun)(void *pvTask),
+                              pthread_t *paThreads)
+{
+   char *pcTasks = (char*)pvTasks;
+   size_t uStarted;
+   size_t u;
+
+   assert(pvTasks != NULL);
+   assert(pfRun != NULL);
+   assert(paThreads != NULL);
+
+   for (uStarted = 1; uStarted < uCount; uStarted++)
+      if (pthread_create(&paThreads[uStarted], NULL, pfRun,
+                         pcTasks + uStarted * uTaskSize) != 0)
+         break;
+
+   for (u = 0; u < uCount; u++)
+      if (u == 0 || u >= uStarted)
+         (void) (*pfRun)(pcTasks + u * uTaskSize);
+
+   for (u = 1; u < uStarted; u++)
+      (void) pthread_join(paThreads[u], NULL);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The state that the threads of one DynArray_mapParallel call
+   share. */
+
+struct DynArray_MapState
+{
+   /* The DynArray being mapped. */
+   DynArray_T oDynArray;
+
+   /* The function to apply and its extra argument. */
+   void (*pfApply)(void *pvElement, void *pvExtra);
+   const void *pvExtra;
+
+   /* The number of elements that each thread claims at a time. */
+   size_t uChunkLength;
+
+   /* The index of the first element that no thread has claimed yet,
+      guarded by sMutex. */
+   size_t uNext;
+   pthread_mutex_t sMutex;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Apply the function of the DynArray_MapState pvState to the elements
+   of its DynArray, a chunk at a time, until no unclaimed chunks are
+   left. Return NULL. */
+
+static void *DynArray_runMapWorker(void *pvState)
+{
+   struct DynArray_MapState *psState =
+      *(struct DynArray_MapState**)pvState;
+   const void **ppvArray;
+   size_t uLength;
+   size_t uLo;
+   size_t uHi;
+
+   assert(psState != NULL);
+
+   ppvArray = psState->oDynArray->ppvArray;
+   uLength = psState->oDynArray->uLength;
+   for (;;)
+   {
+      (void) pthread_mutex_lock(&psState->sMutex);
+      uLo = psState->uNext;
+      if (uLength - uLo > psState->uChunkLength)
+         uHi = uLo + psState->uChunkLength;
+      else
+         uHi = uLength;
+      psState->uNext = uHi;
+      (void) pthread_mutex_unlock(&psState->sMutex);
+
+      if (uLo == uHi)
+         return NULL;
+      for (; uLo < uHi; uLo++)
+         (*psState->pfApply)((void*)ppvArray[uLo],
+                             (void*)psState->pvExtra);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+void DynArray_mapParallel(DynArray_T oDynArray,
+                          void (*pfApply)(void *pvElement,
+                                          void *pvExtra),
+                          const void *pvExtra, size_t uThreads)
+{
+   struct DynArray_MapState sState;
+   struct DynArray_MapState **ppsWorkers;
+   pthread_t *paThreads;
+   size_t u;
+
+   assert(oDynArray != NULL);
+   assert(pfApply != NULL);
+   assert(DynArray_isValid(oDynArray));
+
+   if (uThreads > oDynArray->uLength)
+      uThreads = oDynArray->uLength;
+   if (uThreads < 2)
+   {
+      DynArray_map(oDynArray, pfApply, pvExtra);
+      return;
+   }
+
+   ppsWorkers = (struct DynArray_MapState**)
+      malloc(sizeof(struct DynArray_MapState*) * uThreads);
+   paThreads = (pthread_t*)malloc(sizeof(pthread_t) * uThreads);
+   if (ppsWorkers == NULL || paThreads == NULL ||
+       pthread_mutex_init(&sState.sMutex, NULL) != 0)
+   {
+      free(ppsWorkers);
+      free(paThreads);
+      DynArray_map(oDynArray, pfApply, pvExtra);
+      return;
+   }
+
+   /* threads claim chunks as they go, so that ones given slower
+      elements do less; MAP_CHUNKS_PER_THREAD chunks each on average
+      keeps the claiming cheap */
+   sState.oDynArray = oDynArray;
+   sState.pfApply = pfApply;
+   sState.pvExtra = pvExtra;
+   sState.uChunkLength =
+      oDynArray->uLength / (uThreads * MAP_CHUNKS_PER_THREAD);
+   if (sState.uChunkLength == 0)
+      sState.uChunkLength = 1;
+   sState.uNext = 0;
+
+   /* every worker's task is the shared state */
+   for (u = 0; u < uThreads; u++)
+      ppsWorkers[u] = &sState;
+   DynArray_runTasks(ppsWorkers, sizeof(struct DynArray_MapState*),
+                     uThreads, DynArray_runMapWorker, paThreads);
+
+   (void) pthread_mutex_destroy(&sState.sMutex);
+   free(ppsWorkers);
+   free(paThreads);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The work of one thread of a DynArray_reduceParallel call. */
+
+struct DynArray_ReduceTask
+{
+   /* The elements to apply the function to. */
+   const void **ppvElements;
+
+   /* The number of elements at ppvElements. */
+   size_t uLength;
+
+   /* The function to apply. */
+   void (*pfApply)(void *pvElement, void *pvAccumulator);
+
+   /* This thread's accumulator. */
+   void *pvAccumulator;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Perform the DynArray_ReduceTask pvTask. Return NULL. */
+
+static void *DynArray_runReduceTask(void *pvTask)
+{
+   struct DynArray_ReduceTask *psTask =
+      (struct DynArray_ReduceTask*)pvTask;
+   size_t u;
+
+   assert(psTask != NULL);
+
+   for (u = 0; u < psTask->uLength; u++)
+      (*psTask->pfApply)((void*)psTask->ppvElements[u],
+                         psTask->pvAccumulator);
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void DynArray_reduceParallel(DynArray_T oDynArray,
+                             void (*pfApply)(void *pvElement,
+                                             void *pvAccumulator),
+                             void (*pfCombine)(void *pvAccumulator,
+                                               void *pvPartial),
+                             void *pvAccumulator,
+                             size_t uAccumulatorSize,
+                             size_t uThreads)
+{
+   struct DynArray_ReduceTask *psTasks;
+   pthread_t *paThreads;
+   char *pcPartials;
+   size_t uStride;
+   size_t uLo;
+   size_t uHi;
+   size_t u;
+
+   assert(oDynArray != NULL);
+   assert(pfApply != NULL);
+   assert(pfCombine != NULL);
+   assert(pvAccumulator != NULL);
+   assert(DynArray_isValid(oDynArray));
+
+   if (uThreads > oDynArray->uLength)
+      uThreads = oDynArray->uLength;
+   if (uThreads < 2)
+   {
+      DynArray_map(oDynArray, pfApply, pvAccumulator);
+      return;
+   }
+
+   /* give each partial accumulator cache lines of its own, so that
+      the threads do not slow each other down updating them */
+   uStride = (uAccumulatorSize + CACHE_LINE_BYTES - 1) /
+      CACHE_LINE_BYTES * CACHE_LINE_BYTES;
+   psTasks = (struct DynArray_ReduceTask*)
+      malloc(sizeof(struct DynArray_ReduceTask) * uThreads);
+   paThreads = (pthread_t*)malloc(sizeof(pthread_t) * uThreads);
+   pcPartials = (char*)malloc(uStride * uThreads);
+   if (psTasks == NULL || paThreads == NULL || pcPartials == NULL)
+   {
+      free(psTasks);
+      free(paThreads);
+      free(pcPartials);
+      DynArray_map(oDynArray, pfApply, pvAccumulator);
+      return;
+   }
+
+   /* each thread reduces a contiguous range into a copy of the
+      initial accumulator, and the partial results are combined in
+      the order of the ranges, so the result does not depend on the
+      timing of the threads */
+   for (u = 0; u < uThreads; u++)
+   {
+      uLo = DynArray_share(oDynArray->uLength, u, uThreads);
+      uHi = DynArray_share(oDynArray->uLength, u + 1, uThreads);
+      psTasks[u].ppvElements = oDynArray->ppvArray + uLo;
+      psTasks[u].uLength = uHi - uLo;
+      psTasks[u].pfApply = pfApply;
+      psTasks[u].pvAccumulator = pcPartials + u * uStride;
+      memcpy(psTasks[u].pvAccumulator, pvAccumulator,
+             uAccumulatorSize);
+   }
+   DynArray_runTasks(psTasks, sizeof(struct DynArray_ReduceTask),
+                     uThreads, DynArray_runReduceTask, paThreads);
+
+   for (u = 0; u < uThreads; u++)
+      (*pfCombine)(pvAccumulator, psTasks[u].pvAccumulator);
+
+   free(psTasks);
+   free(paThreads);
+   free(pcPartials);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The type of the comparison functions that order elements. */
+
+typedef int (*DynArray_CompareFn)(const void *pvElement1,
+                                  const void *pvElement2);
+
+/* Ranges shorter than INSERTION_SORT_LENGTH elements are sorted by
+   insertion sort; ranges longer than NINTHER_LENGTH choose their
+   pivot as the median of three medians of three. */
+
+enum { INSERTION_SORT_LENGTH = 24 };
+enum { NINTHER_LENGTH = 128 };
+
+/* A partial insertion sort gives up after moving elements this many
+   places in total. */
+
+enum { PARTIAL_INSERTION_LIMIT = 8 };
+
+/* DynArray_sortParallel sorts arrays shorter than this serially. */
+
+enum { PARALLEL_SORT_MIN_LENGTH = 16384 };
+
+/*--------------------------------------------------------------------*/
+
+/* Swap *ppvElement1 and *ppvElement2. */
+
+static void DynArray_swap(const void **ppvElement1,
+                          const void **ppvElement2)
+{
+   const void *pvTemp;
+
+   assert(ppvElement1 != NULL);
+   assert(ppvElement2 != NULL);
+
+   pvTemp = *ppvElement1;
+   *ppvElement1 = *ppvElement2;
+   *ppvElement2 = pvTemp;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Order *ppv1, *ppv2, and *ppv3 ascending, as determined by
+   *pfCompare. */
+
+static void DynArray_sort3(const void **ppv1, const void **ppv2,
+                           const void **ppv3,
+                           DynArray_CompareFn pfCompare)
+{
+   if ((*pfCompare)(*ppv2, *ppv1) < 0)
+      DynArray_swap(ppv1, ppv2);
+   if ((*pfCompare)(*ppv3, *ppv2) < 0)
+   {
+      DynArray_swap(ppv2, ppv3);
+      if ((*pfCompare)(*ppv2, *ppv1) < 0)
+         DynArray_swap(ppv1, ppv2);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Sort the elements at addresses ppvLo...ppvHi-1 by insertion sort,
+   as determined by *pfCompare. */
+
+static void DynArray_insertionSort(const void **ppvLo,
+                                   const void **ppvHi,
+                                   DynArray_CompareFn pfCompare)
+{
+   const void **ppvCurr;
+   const void **ppvHole;
+   const void *pvElement;
+
+   assert(ppvLo != NULL);
+   assert(ppvHi != NULL);
+
+   for (ppvCurr = ppvLo + 1; ppvCurr < ppvHi; ppvCurr++)
+   {
+      pvElement = *ppvCurr;
+      for (ppvHole = ppvCurr;
+           ppvHole > ppvLo &&
+              (*pfCompare)(pvElement, *(ppvHole - 1)) < 0;
+           ppvHole--)
+         *ppvHole = *(ppvHole - 1);
+      *ppvHole = pvElement;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Try to sort the elements at addresses ppvLo...ppvHi-1 by insertion
+   sort, as determined by *pfCompare, giving up once elements have
+   moved PARTIAL_INSERTION_LIMIT places. Return 1 (TRUE) if the range
+   is then sorted, or 0 (FALSE) if the sort gave up. */
+
+static int DynArray_partialInsertionSort(const void **ppvLo,
+                                         const void **ppvHi,
+                                         DynArray_CompareFn pfCompare)
+{
+   const void **ppvCurr;
+   const void **ppvHole;
+   const void *pvElement;
+   size_t uMoves = 0;
+
+   assert(ppvLo != NULL);
+   assert(ppvHi != NULL);
+
+   for (ppvCurr = ppvLo + 1; ppvCurr < ppvHi; ppvCurr++)
+   {
+      pvElement = *ppvCurr;
+      for (ppvHole = ppvCurr;
+           ppvHole > ppvLo &&
+              (*pfCompare)(pvElement, *(ppvHole - 1)) < 0;
+           ppvHole--)
+         *ppvHole = *(ppvHole - 1);
+      *ppvHole = pvElement;
+
+      uMoves += (size_t)(ppvCurr - ppvHole);
+      if (uMoves > PARTIAL_INSERTION_LIMIT)
+         return 0;
+   }
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Restore the heap order of the max-heap of uLength elements at
+   ppvBase below index uRoot, as determined by *pfCompare. */
+
+static void DynArray_siftDown(const void **ppvBase, size_t uRoot,
+                              size_t uLength,
+                              DynArray_CompareFn pfCompare)
+{
+   size_t uChild;
+
+   assert(ppvBase != NULL);
+
+   while ((uChild = 2 * uRoot + 1) < uLength)
+   {
+      if (uChild + 1 < uLength &&
+          (*pfCompare)(ppvBase[uChild], ppvBase[uChild + 1]) < 0)
+         uChild++;
+      if ((*pfCompare)(ppvBase[uRoot], ppvBase[uChild]) >= 0)
+         return;
+      DynArray_swap(&ppvBase[uRoot], &ppvBase[uChild]);
+      uRoot = uChild;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Sort the elements at addresses ppvLo...ppvHi-1 by heapsort, as
+   determined by *pfCompare. */
+
+static void DynArray_heapSort(const void **ppvLo, const void **ppvHi,
+                              DynArray_CompareFn pfCompare)
+{
+   size_t uLength;
+   size_t u;
+
+   assert(ppvLo != NULL);
+   assert(ppvHi != NULL);
+
+   uLength = (size_t)(ppvHi - ppvLo);
+   for (u = uLength / 2; u > 0; u--)
+      DynArray_siftDown(ppvLo, u - 1, uLength, pfCompare);
+   for (u = uLength; u > 1; u--)
+   {
+      DynArray_swap(&ppvLo[0], &ppvLo[u - 1]);
+      DynArray_siftDown(ppvLo, 0, u - 1, pfCompare);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Partition the elements at addresses ppvLo...ppvHi-1 around the
+   pivot *ppvLo, as determined by *pfCompare: elements less than the
+   pivot end up before it and the others after it. Some element after
+   *ppvLo must not be less than the pivot. Return the pivot's final
+   address, and set *pbAlreadyPartitioned to 1 (TRUE) if no elements
+   had to be swapped. */
+
+static const void **DynArray_partition(const void **ppvLo,
+                                       const void **ppvHi,
+                                       DynArray_CompareFn pfCompare,
+                                       int *pbAlreadyPartitioned)
+{
+   const void *pvPivot;
+   const void **ppvFirst;
+   const void **ppvLast;
+
+   assert(ppvLo != NULL);
+   assert(ppvHi != NULL);
+   assert(pbAlreadyPartitioned != NULL);
+
+   pvPivot = *ppvLo;
+   ppvFirst = ppvLo;
+   ppvLast = ppvHi;
+
+   /* find the first element not less than the pivot, which exists */
+   do
+      ppvFirst++;
+   while ((*pfCompare)(*ppvFirst, pvPivot) < 0);
+
+   /* find the last element less than the pivot; unless an element
+      was skipped above, there may be none */
+   if (ppvFirst - 1 == ppvLo)
+   {
+      while (ppvFirst < ppvLast &&
+             (*pfCompare)(*--ppvLast, pvPivot) >= 0)
+         ;
+   }
+   else
+   {
+      while ((*pfCompare)(*--ppvLast, pvPivot) >= 0)
+         ;
+   }
+
+   *pbAlreadyPartitioned = ppvFirst >= ppvLast;
+
+   while (ppvFirst < ppvLast)
+   {
+      DynArray_swap(ppvFirst, ppvLast);
+      do
+         ppvFirst++;
+      while ((*pfCompare)(*ppvFirst, pvPivot) < 0);
+      do
+         ppvLast--;
+      while ((*pfCompare)(*ppvLast, pvPivot) >= 0);
+   }
+
+   ppvFirst--;
+   *ppvLo = *ppvFirst;
+   *ppvFirst = pvPivot;
+   return ppvFirst;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Sort the elements at addresses ppvLo...ppvHi-1 in ascending order,
+   as determined by *pfCompare, falling back to heapsort once
+   uBadAllowed more partitions have been badly unbalanced.
    *pfCompare must return <0, 0, or >0 depending upon whether
    *pvElement1 is less than, equal to, or greater than *pvElement2,
    respectively. */
 
-static void DynArray_qsort(
-   const void **ppvLo,
-   const void **ppvHi,
-   int (*pfCompare) (const void *pvElement1, const void *pvElement2))
+static void DynArray_introSort(const void **ppvLo, const void **ppvHi,
+                               DynArray_CompareFn pfCompare,
+                               size_t uBadAllowed)
 {
-   /* This function implements a variation of the quicksort algorithm
-      shown in the book "Algorithms + Data Structures = Programs" by
-      Niklaus Wirth. */
-
-   /* This function uses pointers instead of indices to avoid
-      complications with using unsigned integers as array indices. */
+   /* This function implements a variation of pattern-defeating
+      quicksort, shown in the paper "Pattern-defeating Quicksort" by
+      Orson Peters: an introsort whose partitions detect sorted
+      input and break up patterns that unbalance them. */
 
-   const void **ppvRight;
-   const void **ppvLeft;
-   const void *pvPivot;
-   const void *pvTemp;
+   size_t uLength;
+   size_t uHalf;
+   size_t uLeft;
+   size_t uRight;
+   const void **ppvPivot;
+   int bAlreadyPartitioned;
 
    assert(ppvLo != NULL);
    assert(ppvHi != NULL);
    assert(pfCompare != NULL);
 
-   ppvRight = ppvLo;
-   ppvLeft = ppvHi;
-   pvPivot = *(ppvLo + ((ppvHi - ppvLo) / 2));
-
-   while (ppvRight <= ppvLeft)
+   for (;;)
    {
-      while ((*pfCompare)(*ppvRight, pvPivot) < 0)
-         ppvRight++;
-      while ((*pfCompare)(pvPivot, *ppvLeft) < 0)
-         ppvLeft--;
-      if (ppvRight <= ppvLeft)
+      uLength = (size_t)(ppvHi - ppvLo);
+      if (uLength < INSERTION_SORT_LENGTH)
+      {
+         DynArray_insertionSort(ppvLo, ppvHi, pfCompare);
+         return;
+      }
+
+      /* move the pivot to *ppvLo, with an element not less than it
+         at *(ppvHi - 1) */
+      uHalf = uLength / 2;
+      if (uLength > NINTHER_LENGTH)
       {
-         /* Swap *ppvRight and *ppvLeft. */
-         pvTemp = *ppvRight;
-         *ppvRight = *ppvLeft;
-         *ppvLeft = pvTemp;
+         DynArray_sort3(ppvLo, ppvLo + uHalf, ppvHi - 1, pfCompare);
+         DynArray_sort3(ppvLo + 1, ppvLo + uHalf - 1, ppvHi - 2,
+                        pfCompare);
+         DynArray_sort3(ppvLo + 2, ppvLo + uHalf + 1, ppvHi - 3,
+                        pfCompare);
+         DynArray_sort3(ppvLo + uHalf - 1, ppvLo + uHalf,
+                        ppvLo + uHalf + 1, pfCompare);
+         DynArray_swap(ppvLo, ppvLo + uHalf);
+      }
+      else
+         DynArray_sort3(ppvLo + uHalf, ppvLo, ppvHi - 1, pfCompare);
+
+      ppvPivot = DynArray_partition(ppvLo, ppvHi, pfCompare,
+                                    &bAlreadyPartitioned);
+      uLeft = (size_t)(ppvPivot - ppvLo);
+      uRight = (size_t)(ppvHi - (ppvPivot + 1));
 
-         ppvRight++;
-         ppvLeft--;
+      if (uLeft < uLength / 8 || uRight < uLength / 8)
+      {
+         /* a badly unbalanced partition: after too many, finish with
+            heapsort's guaranteed O(n log n); otherwise swap some
+            elements around to break up the pattern that caused it */
+         if (--uBadAllowed == 0)
+         {
+            DynArray_heapSort(ppvLo, ppvHi, pfCompare);
+            return;
+         }
+         if (uLeft >= INSERTION_SORT_LENGTH)
+         {
+            DynArray_swap(ppvLo, ppvLo + uLeft / 4);
+            DynArray_swap(ppvPivot - 1, ppvPivot - uLeft / 4);
+            if (uLeft > NINTHER_LENGTH)
+            {
+               DynArray_swap(ppvLo + 1, ppvLo + (uLeft / 4 + 1));
+               DynArray_swap(ppvLo + 2, ppvLo + (uLeft / 4 + 2));
+               DynArray_swap(ppvPivot - 2, ppvPivot - (uLeft / 4 + 1));
+               DynArray_swap(ppvPivot - 3, ppvPivot - (uLeft / 4 + 2));
+            }
+         }
+         if (uRight >= INSERTION_SORT_LENGTH)
+         {
+            DynArray_swap(ppvPivot + 1, ppvPivot + 1 + uRight / 4);
+            DynArray_swap(ppvHi - 1, ppvHi - uRight / 4);
+            if (uRight > NINTHER_LENGTH)
+            {
+               DynArray_swap(ppvPivot + 2, ppvPivot + (2 + uRight / 4));
+               DynArray_swap(ppvPivot + 3, ppvPivot + (3 + uRight / 4));
+               DynArray_swap(ppvHi - 2, ppvHi - (1 + uRight / 4));
+               DynArray_swap(ppvHi - 3, ppvHi - (2 + uRight / 4));
+            }
+         }
+      }
+      /* a partition that swapped nothing suggests sorted input */
+      else if (bAlreadyPartitioned &&
+               DynArray_partialInsertionSort(ppvLo, ppvPivot,
+                                             pfCompare) &&
+               DynArray_partialInsertionSort(ppvPivot + 1, ppvHi,
+                                             pfCompare))
+         return;
+
+      /* recurse into the smaller side and loop on the larger, so the
+         recursion is at most logarithmically deep */
+      if (uLeft < uRight)
+      {
+         DynArray_introSort(ppvLo, ppvPivot, pfCompare, uBadAllowed);
+         ppvLo = ppvPivot + 1;
+      }
+      else
+      {
+         DynArray_introSort(ppvPivot + 1, ppvHi, pfCompare,
+                            uBadAllowed);
+         ppvHi = ppvPivot;
       }
    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Sort the uLength elements at ppvArray in ascending order, as
+   determined by *pfCompare, in O(n log n) time even in the worst
+   case. */
+
+static void DynArray_sortRange(const void **ppvArray, size_t uLength,
+                               DynArray_CompareFn pfCompare)
+{
+   size_t uBadAllowed = 1;
+   size_t u;
 
-   if (ppvLo < ppvLeft)
-      DynArray_qsort(ppvLo, ppvLeft, pfCompare);
-   if (ppvRight < ppvHi)
-      DynArray_qsort(ppvRight, ppvHi, pfCompare);
+   assert(ppvArray != NULL);
+
+   /* allow about log2(uLength) badly unbalanced partitions */
+   for (u = uLength; u > 1; u >>= 1)
+      uBadAllowed++;
+
+   DynArray_introSort(ppvArray, ppvArray + uLength, pfCompare,
+                      uBadAllowed);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Merge the uALength sorted elements at ppvA and the uBLength sorted
+   elements at ppvB into ppvOut, as determined by *pfCompare, taking
+   equal elements from ppvA first. */
+
+static void DynArray_merge(const void **ppvA, size_t uALength,
+                           const void **ppvB, size_t uBLength,
+                           const void **ppvOut,
+                           DynArray_CompareFn pfCompare)
+{
+   const void **ppvAEnd = ppvA + uALength;
+   const void **ppvBEnd = ppvB + uBLength;
+
+   assert(ppvA != NULL);
+   assert(ppvB != NULL);
+   assert(ppvOut != NULL);
+
+   while (ppvA < ppvAEnd && ppvB < ppvBEnd)
+   {
+      if ((*pfCompare)(*ppvB, *ppvA) < 0)
+         *ppvOut++ = *ppvB++;
+      else
+         *ppvOut++ = *ppvA++;
+   }
+   memcpy(ppvOut, ppvA, sizeof(void*) * (size_t)(ppvAEnd - ppvA));
+   ppvOut += ppvAEnd - ppvA;
+   memcpy(ppvOut, ppvB, sizeof(void*) * (size_t)(ppvBEnd - ppvB));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return how many of the first uOut elements that DynArray_merge
+   would write, given the same arguments, come from ppvA. */
+
+static size_t DynArray_coRank(size_t uOut,
+                              const void **ppvA, size_t uALength,
+                              const void **ppvB, size_t uBLength,
+                              DynArray_CompareFn pfCompare)
+{
+   size_t uLo;
+   size_t uHi;
+   size_t uMid;
+
+   assert(ppvA != NULL);
+   assert(ppvB != NULL);
+   assert(uOut <= uALength + uBLength);
+
+   /* the answer is in [uLo, uHi]: it is the number of elements of
+      ppvA that come before the element of ppvB they are paired
+      with */
+   uLo = (uOut > uBLength) ? uOut - uBLength : 0;
+   uHi = (uOut < uALength) ? uOut : uALength;
+   while (uLo < uHi)
+   {
+      uMid = uLo + (uHi - uLo) / 2;
+      if ((*pfCompare)(ppvA[uMid], ppvB[uOut - uMid - 1]) <= 0)
+         uLo = uMid + 1;
+      else
+         uHi = uMid;
+   }
+   return uLo;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A piece of the work of DynArray_sortParallel, for one thread: a
+   range of elements to sort, or parts of two sorted runs to merge. */
+
+struct DynArray_SortTask
+{
+   /* The elements to sort, or the part of the first run to merge. */
+   const void **ppvA;
+
+   /* The number of elements at ppvA. */
+   size_t uALength;
+
+   /* The part of the second run to merge. */
+   const void **ppvB;
+
+   /* The number of elements at ppvB. */
+   size_t uBLength;
+
+   /* Where to write the merged elements, or NULL to sort ppvA. */
+   const void **ppvOut;
+
+   /* The function that orders elements. */
+   DynArray_CompareFn pfCompare;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Perform the DynArray_SortTask pvTask. Return NULL. */
+
+static void *DynArray_runSortTask(void *pvTask)
+{
+   struct DynArray_SortTask *psTask = (struct DynArray_SortTask*)pvTask;
+
+   assert(psTask != NULL);
+
+   if (psTask->ppvOut == NULL)
+      DynArray_sortRange(psTask->ppvA, psTask->uALength,
+                         psTask->pfCompare);
+   else
+      DynArray_merge(psTask->ppvA, psTask->uALength,
+                     psTask->ppvB, psTask->uBLength,
+                     psTask->ppvOut, psTask->pfCompare);
+   return NULL;
 }
 
 /*--------------------------------------------------------------------*/
@@ -319,13 +1230,160 @@ void DynArray_sort(DynArray_T oDynArray,
    assert(pfCompare != NULL);
    assert(DynArray_isValid(oDynArray));
 
-   if (oDynArray->uLength < 2)
+   DynArray_sortRange(oDynArray->ppvArray, oDynArray->uLength,
+                      pfCompare);
+
+   assert(DynArray_isValid(oDynArray));
+}
+
+/*--------------------------------------------------------------------*/
+
+void DynArray_sortParallel(DynArray_T oDynArray,
+                           int (*pfCompare)(const void *pvElement1,
+                                            const void *pvElement2),
+                           size_t uThreads)
+{
+   size_t uLength;
+   size_t uRuns;
+   size_t uParts;
+   size_t uTasks;
+   size_t uRun;
+   size_t uPart;
+   size_t uALength;
+   size_t uTotal;
+   size_t uOutLo;
+   size_t uOutHi;
+   size_t uALo;
+   size_t uAHi;
+   size_t *puBounds;
+   const void **ppvSrc;
+   const void **ppvDst;
+   const void **ppvSwap;
+   const void **ppvTemp;
+   struct DynArray_SortTask *psTasks;
+   struct DynArray_SortTask *psTask;
+   pthread_t *paThreads;
+
+   assert(oDynArray != NULL);
+   assert(pfCompare != NULL);
+   assert(DynArray_isValid(oDynArray));
+
+   /* one sorted run per thread, but none much shorter than
+      PARALLEL_SORT_MIN_LENGTH / 2; as in DynArray_mapParallel, no
+      more threads than elements, which also keeps the sizes of the
+      task and thread arrays from overflowing */
+   uLength = oDynArray->uLength;
+   if (uThreads > uLength)
+      uThreads = uLength;
+   uRuns = uLength / (PARALLEL_SORT_MIN_LENGTH / 2);
+   if (uThreads < uRuns)
+      uRuns = uThreads;
+   if (uRuns < 2)
+   {
+      DynArray_sort(oDynArray, pfCompare);
       return;
+   }
 
-   DynArray_qsort(
-      &oDynArray->ppvArray[0],
-      &oDynArray->ppvArray[oDynArray->uLength-1],
-      pfCompare);
+   /* no round has more than uThreads tasks */
+   ppvTemp = (const void**)malloc(sizeof(void*) * uLength);
+   puBounds = (size_t*)malloc(sizeof(size_t) * (uRuns + 1));
+   psTasks = (struct DynArray_SortTask*)
+      malloc(sizeof(struct DynArray_SortTask) * uThreads);
+   paThreads = (pthread_t*)malloc(sizeof(pthread_t) * uThreads);
+   if (ppvTemp == NULL || puBounds == NULL || psTasks == NULL ||
+       paThreads == NULL)
+   {
+      free(ppvTemp);
+      free(puBounds);
+      free(psTasks);
+      free(paThreads);
+      DynArray_sort(oDynArray, pfCompare);
+      return;
+   }
+
+   /* sort the runs concurrently */
+   for (uRun = 0; uRun <= uRuns; uRun++)
+      puBounds[uRun] = DynArray_share(uLength, uRun, uRuns);
+   for (uRun = 0; uRun < uRuns; uRun++)
+   {
+      psTask = &psTasks[uRun];
+      psTask->ppvA = oDynArray->ppvArray + puBounds[uRun];
+      psTask->uALength = puBounds[uRun + 1] - puBounds[uRun];
+      psTask->ppvOut = NULL;
+      psTask->pfCompare = pfCompare;
+   }
+   DynArray_runTasks(psTasks, sizeof(struct DynArray_SortTask), uRuns,
+                     DynArray_runSortTask, paThreads);
+
+   /* merge pairs of runs, back and forth between the array and
+      ppvTemp, until one is left; each merge is split at the outputs'
+      co-ranks into as many parts as the threads allow, after one is
+      kept for copying an odd run out (uRuns <= uThreads, so each
+      pair gets at least one) */
+   ppvSrc = oDynArray->ppvArray;
+   ppvDst = ppvTemp;
+   while (uRuns > 1)
+   {
+      uParts = (uThreads - uRuns % 2) / (uRuns / 2);
+      uTasks = 0;
+      for (uRun = 0; uRun < uRuns; uRun += 2)
+      {
+         uALength = puBounds[uRun + 1] - puBounds[uRun];
+         if (uRun + 1 == uRuns)
+         {
+            /* an odd run out is copied as is */
+            psTask = &psTasks[uTasks++];
+            psTask->ppvA = ppvSrc + puBounds[uRun];
+            psTask->uALength = uALength;
+            psTask->ppvB = psTask->ppvA;
+            psTask->uBLength = 0;
+            psTask->ppvOut = ppvDst + puBounds[uRun];
+            psTask->pfCompare = pfCompare;
+            break;
+         }
+
+         uTotal = puBounds[uRun + 2] - puBounds[uRun];
+         uALo = 0;
+         for (uPart = 0; uPart < uParts; uPart++)
+         {
+            uOutLo = DynArray_share(uTotal, uPart, uParts);
+            uOutHi = DynArray_share(uTotal, uPart + 1, uParts);
+            uAHi = DynArray_coRank(uOutHi, ppvSrc + puBounds[uRun],
+                                   uALength,
+                                   ppvSrc + puBounds[uRun + 1],
+                                   uTotal - uALength, pfCompare);
+            psTask = &psTasks[uTasks++];
+            psTask->ppvA = ppvSrc + puBounds[uRun] + uALo;
+            psTask->uALength = uAHi - uALo;
+            psTask->ppvB =
+               ppvSrc + puBounds[uRun + 1] + (uOutLo - uALo);
+            psTask->uBLength = (uOutHi - uAHi) - (uOutLo - uALo);
+            psTask->ppvOut = ppvDst + puBounds[uRun] + uOutLo;
+            psTask->pfCompare = pfCompare;
+            uALo = uAHi;
+         }
+      }
+      DynArray_runTasks(psTasks, sizeof(struct DynArray_SortTask),
+                        uTasks, DynArray_runSortTask, paThreads);
+
+      /* the merged runs start where the first of each pair did */
+      for (uRun = 0; uRun < uRuns; uRun += 2)
+         puBounds[uRun / 2] = puBounds[uRun];
+      uRuns = (uRuns + 1) / 2;
+      puBounds[uRuns] = uLength;
+
+      ppvSwap = ppvSrc;
+      ppvSrc = ppvDst;
+      ppvDst = ppvSwap;
+   }
+
+   if (ppvSrc != oDynArray->ppvArray)
+      memcpy(oDynArray->ppvArray, ppvSrc, sizeof(void*) * uLength);
+
+   free(ppvTemp);
+   free(puBounds);
+   free(psTasks);
+   free(paThreads);
 
    assert(DynArray_isValid(oDynArray));
 }
@@ -71,6 +71,66 @@ void *DynArray_removeAt(DynArray_T oDynArray, size_t uIndex);
 
 /*--------------------------------------------------------------------*/
 
+/* Add the uCount elements of ppvElements to oDynArray such that the
+   first of them is the uIndex'th element, keeping their order, and
+   moving the elements already at and after uIndex only once. Return 1
+   (TRUE) if successful, or 0 (FALSE) if insufficient memory is
+   available, in which case oDynArray is unchanged. */
+
+int DynArray_insertRange(DynArray_T oDynArray, size_t uIndex,
+                         void *const *ppvElements, size_t uCount);
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the uCount elements of oDynArray starting at the uIndex'th
+   one, moving the elements after them only once. The removed
+   elements are not returned; fetch them first if they are needed. */
+
+void DynArray_removeRange(DynArray_T oDynArray, size_t uIndex,
+                          size_t uCount);
+
+/*--------------------------------------------------------------------*/
+
+/* Remove all elements of oDynArray, keeping its memory for reuse. */
+
+void DynArray_clear(DynArray_T oDynArray);
+
+/*--------------------------------------------------------------------*/
+
+/* Add the elements of oOther, in order, to the end of oDynArray.
+   oOther may be oDynArray itself. Return 1 (TRUE) if successful, or 0
+   (FALSE) if insufficient memory is available, in which case
+   oDynArray is unchanged. */
+
+int DynArray_appendArray(DynArray_T oDynArray, DynArray_T oOther);
+
+/*--------------------------------------------------------------------*/
+
+/* Make the physical length of oDynArray at least uLength, so that it
+   can hold that many elements without reallocating its memory. Return
+   1 (TRUE) if successful, or 0 (FALSE) if insufficient memory is
+   available. Removing elements may give up the reserved memory. */
+
+int DynArray_reserve(DynArray_T oDynArray, size_t uLength);
+
+/*--------------------------------------------------------------------*/
+
+/* Give up as much of oDynArray's unused memory as possible. */
+
+void DynArray_shrinkToFit(DynArray_T oDynArray);
+
+/*--------------------------------------------------------------------*/
+
+/* Set the factor by which the physical length of oDynArray grows
+   when it is full to uPercent percent, which must be more than 100.
+   The factor of a new DynArray_T object is 200 percent: its memory
+   doubles. Whatever the factor, a DynArray_T object halves its memory
+   once no more than a quarter of it is in use. */
+
+void DynArray_setGrowthPercent(DynArray_T oDynArray, size_t uPercent);
+
+/*--------------------------------------------------------------------*/
+
 /* Fill ppvArray with the elements of oDynArray.  ppvArray must point
    to an area of memory that is large enough to hold all elements of
    oDynArray. */
@@ -89,7 +149,45 @@ void DynArray_map(DynArray_T oDynArray,
 
 /*--------------------------------------------------------------------*/
 
-/* Sort oDynArray in the order determined by *pfCompare.
+/* Apply function *pfApply to each element of oDynArray, passing
+   pvExtra as an extra argument, as DynArray_map does, but using up to
+   uThreads threads, which take chunks of the array as they become
+   free, and in no particular order. *pfApply must be safe to call
+   from several threads at once. If threads or memory cannot be
+   obtained, fewer threads are used. */
+
+void DynArray_mapParallel(DynArray_T oDynArray,
+                          void (*pfApply)(void *pvElement,
+                                          void *pvExtra),
+                          const void *pvExtra, size_t uThreads);
+
+/*--------------------------------------------------------------------*/
+
+/* Fold the elements of oDynArray into the object of uAccumulatorSize
+   bytes at pvAccumulator, using up to uThreads threads. Each thread
+   takes a contiguous range of the array and a private copy of
+   *pvAccumulator, which must initially be the identity of the
+   reduction (such as a zero count), and calls
+   (*pfApply)(pvElement, pvPartial) for each element pvElement of its
+   range with its copy pvPartial. Then the copies are folded into
+   *pvAccumulator, in the order of the ranges, by calling
+   (*pfCombine)(pvAccumulator, pvPartial). The result thus does not
+   depend on timing as long as *pfCombine is associative. If threads
+   or memory cannot be obtained, fewer threads are used. */
+
+void DynArray_reduceParallel(DynArray_T oDynArray,
+                             void (*pfApply)(void *pvElement,
+                                             void *pvAccumulator),
+                             void (*pfCombine)(void *pvAccumulator,
+                                               void *pvPartial),
+                             void *pvAccumulator,
+                             size_t uAccumulatorSize,
+                             size_t uThreads);
+
+/*--------------------------------------------------------------------*/
+
+/* Sort oDynArray in the order determined by *pfCompare, in
+   O(n log n) time even in the worst case.
    *pfCompare must return <0, 0, or >0 depending upon whether
    *pvElement1 is less than, equal to, or greater than *pvElement2,
    respectively. */
@@ -100,6 +198,21 @@ void DynArray_sort(DynArray_T oDynArray,
 
 /*--------------------------------------------------------------------*/
 
+/* Sort oDynArray as DynArray_sort does, using up to uThreads threads:
+   each sorts a part of the array, and then the sorted parts are
+   merged pairwise, with each merge also split among the threads.
+   Arrays too short to gain from it, and arrays for which the
+   temporary memory (as much again as oDynArray) or threads cannot be
+   obtained, are sorted with fewer threads or just one. *pfCompare
+   must be safe to call from several threads at once. */
+
+void DynArray_sortParallel(DynArray_T oDynArray,
+                           int (*pfCompare)(const void *pvElement1,
+                                            const void *pvElement2),
+                           size_t uThreads);
+
+/*--------------------------------------------------------------------*/
+
 /* Linear search oDynArray for *pvSoughtElement using *pfCompare to
    determine equality.  If the element is found, then assign its
    index to *puIndex and return 1.  If the element is not found, then
@@ -0,0 +1,225 @@
+/*--------------------------------------------------------------------*/
+/* intern.c                                                           */
+/* Author: Josh Schoenberg and Jack Toubes                            */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "intern.h"
+
+/* The FNV-1a parameters for the width of an unsigned long */
+#if ULONG_MAX > 0xffffffffUL
+#define INTERN_FNV_BASIS 0xcbf29ce484222325UL
+#define INTERN_FNV_PRIME 0x100000001b3UL
+#else
+#define INTERN_FNV_BASIS 0x811c9dc5UL
+#define INTERN_FNV_PRIME 0x01000193UL
+#endif
+
+/* The number of buckets in a newly created table */
+enum { INITIAL_BUCKET_COUNT = 64 };
+
+/* A string in the pool */
+struct internEntry {
+   /* the next entry in the same bucket */
+   struct internEntry *psNext;
+   /* the hash of the string */
+   unsigned long ulHash;
+   /* the number of references to the string */
+   size_t ulRefCount;
+   /* the length of the string */
+   size_t ulLength;
+   /* the string itself; the entry is allocated with room for all
+      ulLength+1 bytes */
+   char acString[1];
+};
+
+/* 1. the hash table of entries, or NULL while the pool is empty */
+static struct internEntry **ppsBuckets;
+/* 2. the number of buckets in ppsBuckets, a power of 2 */
+static size_t ulBucketCount;
+/* 3. the number of entries in the pool */
+static size_t ulEntryCount;
+
+/*--------------------------------------------------------------------*/
+
+/*
+  Returns the entry holding pcInterned.
+*/
+static struct internEntry *Intern_getEntry(const char *pcInterned) {
+   assert(pcInterned != NULL);
+
+   return (struct internEntry *)
+      (pcInterned - offsetof(struct internEntry, acString));
+}
+
+/*
+  Doubles the number of buckets, redistributing the entries. Leaves
+  the table unchanged if memory could not be allocated.
+*/
+static void Intern_grow(void) {
+   struct internEntry **ppsNew;
+   size_t ulNewCount = 2 * ulBucketCount;
+   size_t i;
+
+   ppsNew = calloc(ulNewCount, sizeof(struct internEntry *));
+   if(ppsNew == NULL)
+      return;
+
+   for(i = 0; i < ulBucketCount; i++) {
+      struct internEntry *psEntry = ppsBuckets[i];
+      while(psEntry != NULL) {
+         struct internEntry *psNext = psEntry->psNext;
+         size_t ulIndex = psEntry->ulHash & (ulNewCount - 1);
+         psEntry->psNext = ppsNew[ulIndex];
+         ppsNew[ulIndex] = psEntry;
+         psEntry = psNext;
+      }
+   }
+
+   free(ppsBuckets);
+   ppsBuckets = ppsNew;
+   ulBucketCount = ulNewCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+unsigned long Intern_hash(const char *pcStr, size_t ulLength) {
+   assert(pcStr != NULL);
+
+   return Intern_extendHash(INTERN_FNV_BASIS, pcStr, ulLength);
+}
+
+unsigned long Intern_extendHash(unsigned long ulHash, const char *pcStr,
+                                size_t ulLength) {
+   size_t i;
+
+   assert(pcStr != NULL);
+
+   for(i = 0; i < ulLength; i++) {
+      ulHash ^= (unsigned char) pcStr[i];
+      ulHash *= INTERN_FNV_PRIME;
+   }
+   return ulHash;
+}
+
+const char *Intern_find(const char *pcStr, size_t ulLength) {
+   struct internEntry *psEntry;
+   unsigned long ulHash;
+
+   assert(pcStr != NULL);
+
+   if(ppsBuckets == NULL)
+      return NULL;
+
+   ulHash = Intern_hash(pcStr, ulLength);
+   for(psEntry = ppsBuckets[ulHash & (ulBucketCount - 1)];
+       psEntry != NULL; psEntry = psEntry->psNext) {
+      if(psEntry->ulHash == ulHash && psEntry->ulLength == ulLength &&
+         !memcmp(psEntry->acString, pcStr, ulLength))
+         return psEntry->acString;
+   }
+   return NULL;
+}
+
+const char *Intern_acquire(const char *pcStr, size_t ulLength) {
+   struct internEntry *psEntry;
+   unsigned long ulHash;
+   size_t ulIndex;
+
+   assert(pcStr != NULL);
+
+   if(ppsBuckets == NULL) {
+      ppsBuckets = calloc(INITIAL_BUCKET_COUNT,
+                          sizeof(struct internEntry *));
+      if(ppsBuckets == NULL)
+         return NULL;
+      ulBucketCount = INITIAL_BUCKET_COUNT;
+   }
+
+   ulHash = Intern_hash(pcStr, ulLength);
+   ulIndex = ulHash & (ulBucketCount - 1);
+
+   /* already in the pool? */
+   for(psEntry = ppsBuckets[ulIndex]; psEntry != NULL;
+       psEntry = psEntry->psNext) {
+      if(psEntry->ulHash == ulHash && psEntry->ulLength == ulLength &&
+         !memcmp(psEntry->acString, pcStr, ulLength)) {
+         psEntry->ulRefCount++;
+         return psEntry->acString;
+      }
+   }
+
+   /* no: add it */
+   psEntry = malloc(offsetof(struct internEntry, acString)
+                    + ulLength + 1);
+   if(psEntry == NULL) {
+      if(ulEntryCount == 0) {
+         free(ppsBuckets);
+         ppsBuckets = NULL;
+         ulBucketCount = 0;
+      }
+      return NULL;
+   }
+   psEntry->ulHash = ulHash;
+   psEntry->ulRefCount = 1;
+   psEntry->ulLength = ulLength;
+   memcpy(psEntry->acString, pcStr, ulLength);
+   psEntry->acString[ulLength] = '\0';
+
+   if(ulEntryCount >= ulBucketCount) {
+      Intern_grow();
+      ulIndex = ulHash & (ulBucketCount - 1);
+   }
+   psEntry->psNext = ppsBuckets[ulIndex];
+   ppsBuckets[ulIndex] = psEntry;
+   ulEntryCount++;
+
+   return psEntry->acString;
+}
+
+const char *Intern_retain(const char *pcInterned) {
+   assert(pcInterned != NULL);
+
+   Intern_getEntry(pcInterned)->ulRefCount++;
+   return pcInterned;
+}
+
+void Intern_release(const char *pcInterned) {
+   struct internEntry *psEntry;
+   struct internEntry **ppsLink;
+
+   if(pcInterned == NULL)
+      return;
+
+   psEntry = Intern_getEntry(pcInterned);
+   assert(psEntry->ulRefCount > 0);
+   if(--psEntry->ulRefCount > 0)
+      return;
+
+   /* unlink the entry from its bucket */
+   ppsLink = &ppsBuckets[psEntry->ulHash & (ulBucketCount - 1)];
+   while(*ppsLink != psEntry) {
+      assert(*ppsLink != NULL);
+      ppsLink = &(*ppsLink)->psNext;
+   }
+   *ppsLink = psEntry->psNext;
+   free(psEntry);
+   ulEntryCount--;
+
+   /* an empty pool holds no memory */
+   if(ulEntryCount == 0) {
+      free(ppsBuckets);
+      ppsBuckets = NULL;
+      ulBucketCount = 0;
+   }
+}
+
+size_t Intern_getLength(const char *pcInterned) {
+   assert(pcInterned != NULL);
+
+   return Intern_getEntry(pcInterned)->ulLength;
+}
@@ -0,0 +1,67 @@
+/*--------------------------------------------------------------------*/
+/* intern.h                                                           */
+/* Author: Josh Schoenberg and Jack Toubes                            */
+/*--------------------------------------------------------------------*/
+
+#ifndef INTERN_INCLUDED
+#define INTERN_INCLUDED
+
+#include <stddef.h>
+
+/*
+  The intern pool stores one reference-counted copy of each distinct
+  string placed in it, so that strings obtained from the pool are
+  equal if and only if they are the same pointer.
+*/
+
+/*
+  Returns the pool's copy of the ulLength bytes at pcStr (which need
+  not be '\0'-terminated, but must not contain '\0'), adding one to
+  its reference count, or adding it with a count of one if it is not
+  yet in the pool. Returns NULL if memory could not be allocated.
+*/
+const char *Intern_acquire(const char *pcStr, size_t ulLength);
+
+/*
+  Returns the pool's copy of the ulLength bytes at pcStr without adding
+  a reference to it, or NULL if the pool has no such string. Allocates
+  no memory.
+*/
+const char *Intern_find(const char *pcStr, size_t ulLength);
+
+/*
+  Adds one to the reference count of pcInterned, which must have been
+  returned by Intern_acquire and not yet fully released. Returns
+  pcInterned.
+*/
+const char *Intern_retain(const char *pcInterned);
+
+/*
+  Subtracts one from the reference count of pcInterned, which must
+  have been returned by Intern_acquire and not yet fully released,
+  and frees it once no references remain. Does nothing if pcInterned
+  is NULL.
+*/
+void Intern_release(const char *pcInterned);
+
+/*
+  Returns the length of pcInterned, which must have been returned by
+  Intern_acquire and not yet fully released.
+*/
+size_t Intern_getLength(const char *pcInterned);
+
+/*
+  Returns a hash of the ulLength bytes at pcStr, as wide as an
+  unsigned long (64 bits on LP64 platforms).
+*/
+unsigned long Intern_hash(const char *pcStr, size_t ulLength);
+
+/*
+  Returns the hash of the bytes that Intern_hash hashed to ulHash
+  followed by the ulLength bytes at pcStr, in time proportional to
+  ulLength alone.
+*/
+unsigned long Intern_extendHash(unsigned long ulHash, const char *pcStr,
+                                size_t ulLength);
+
+#endif
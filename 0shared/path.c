@@ -7,9 +7,15 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include "dynarray.h"
+#include "intern.h"
+#include "pathscan.h"
+#include "vec.h"
 #include "path.h"
 
+/* A vector of interned component strings, which are compared by
+   strcmp */
+DEFINE_VEC(ComponentVec, const char *, strcmp)
+
 /* An absolute path */
 struct path {
    /* The string representation of the path,
@@ -17,23 +23,158 @@ struct path {
    const char *pcPath;
    /* The string length of pcPath */
    size_t ulLength;
-   /* The ordered collection of component strings in the path */
-   DynArray_T oDComponents;
+   /* The ordered collection of component strings in the path, each
+      obtained from the intern pool */
+   ComponentVec sComponents;
+   /* The hash of pcPath */
+   unsigned long ulHash;
+   /* The number of references to a canonical path, or 0 if the path
+      is not canonical */
+   size_t ulRefCount;
+   /* The next canonical path in the same bucket */
+   struct path *psNext;
 };
 
+/* The number of buckets in a newly created table of canonical paths */
+enum { INITIAL_BUCKET_COUNT = 64 };
+
+/* 1. whether new paths are hash-consed */
+static boolean bHashConsing;
+/* 2. the hash table of canonical paths, or NULL while there are none */
+static struct path **ppsCanonical;
+/* 3. the number of buckets in ppsCanonical, a power of 2 */
+static size_t ulBucketCount;
+/* 4. the number of canonical paths */
+static size_t ulCanonicalCount;
+
+/*
+  Returns the canonical path whose pathname, which hashes to ulHash, is
+  the ulLength bytes at pcPath, followed by a '/' and the ulTailLength
+  bytes at pcTail unless pcTail is NULL. Returns NULL if there is no
+  such path.
+*/
+static struct path *Path_findCanonical(const char *pcPath,
+                                       size_t ulLength,
+                                       const char *pcTail,
+                                       size_t ulTailLength,
+                                       unsigned long ulHash) {
+   struct path *psPath;
+   size_t ulTotal = ulLength;
+
+   assert(pcPath != NULL);
+
+   if(ppsCanonical == NULL)
+      return NULL;
+
+   if(pcTail != NULL)
+      ulTotal += 1 + ulTailLength;
+
+   for(psPath = ppsCanonical[ulHash & (ulBucketCount - 1)];
+       psPath != NULL; psPath = psPath->psNext) {
+      if(psPath->ulHash != ulHash || psPath->ulLength != ulTotal ||
+         memcmp(psPath->pcPath, pcPath, ulLength))
+         continue;
+      if(pcTail == NULL ||
+         (psPath->pcPath[ulLength] == '/' &&
+          !memcmp(psPath->pcPath + ulLength + 1, pcTail, ulTailLength)))
+         return psPath;
+   }
+   return NULL;
+}
+
+/*
+  Makes psPath, which must be a new path that is equal to no canonical
+  path, canonical with a reference count of 1. Leaves psPath not
+  canonical if memory could not be allocated for the table.
+*/
+static void Path_addCanonical(struct path *psPath) {
+   size_t ulIndex;
+
+   assert(psPath != NULL);
+   assert(psPath->ulRefCount == 0);
+
+   if(ppsCanonical == NULL) {
+      ppsCanonical = calloc(INITIAL_BUCKET_COUNT,
+                            sizeof(struct path *));
+      if(ppsCanonical == NULL)
+         return;
+      ulBucketCount = INITIAL_BUCKET_COUNT;
+   }
+
+   /* keep the chains short by doubling the number of buckets */
+   if(ulCanonicalCount >= ulBucketCount) {
+      struct path **ppsNew;
+      size_t i;
+
+      ppsNew = calloc(2 * ulBucketCount, sizeof(struct path *));
+      if(ppsNew != NULL) {
+         for(i = 0; i < ulBucketCount; i++) {
+            while(ppsCanonical[i] != NULL) {
+               struct path *psMoved = ppsCanonical[i];
+               ppsCanonical[i] = psMoved->psNext;
+               ulIndex = psMoved->ulHash & (2 * ulBucketCount - 1);
+               psMoved->psNext = ppsNew[ulIndex];
+               ppsNew[ulIndex] = psMoved;
+            }
+         }
+         free(ppsCanonical);
+         ppsCanonical = ppsNew;
+         ulBucketCount *= 2;
+      }
+   }
+
+   ulIndex = psPath->ulHash & (ulBucketCount - 1);
+   psPath->psNext = ppsCanonical[ulIndex];
+   ppsCanonical[ulIndex] = psPath;
+   psPath->ulRefCount = 1;
+   ulCanonicalCount++;
+}
+
+/*
+  Removes canonical path psPath, which has no references left, from
+  the table of canonical paths.
+*/
+static void Path_removeCanonical(struct path *psPath) {
+   struct path **ppsLink;
+
+   assert(psPath != NULL);
+   assert(ppsCanonical != NULL);
+
+   ppsLink = &ppsCanonical[psPath->ulHash & (ulBucketCount - 1)];
+   while(*ppsLink != psPath) {
+      assert(*ppsLink != NULL);
+      ppsLink = &(*ppsLink)->psNext;
+   }
+   *ppsLink = psPath->psNext;
+   ulCanonicalCount--;
+
+   /* no canonical paths, no table */
+   if(ulCanonicalCount == 0) {
+      free(ppsCanonical);
+      ppsCanonical = NULL;
+      ulBucketCount = 0;
+   }
+}
+
 /*
-  Frees pcStr. This wrapper is used to match the requirements of the
-  callback function pointer passed to DynArray_map. pvExtra is unused.
+  Releases each interned string in *psComponents, and then frees
+  *psComponents itself, which may be uninitialized (all bits zero).
 */
-static void Path_freeString(char *pcStr, void *pvExtra) {
-   /* pcStr may be NULL, as this is a no-op to free.
-      pvExtra may be NULL, as it is unused. */
-   free(pcStr);
+static void Path_releaseComponents(ComponentVec *psComponents) {
+   size_t ulIndex;
+
+   assert(psComponents != NULL);
+
+   for(ulIndex = 0; ulIndex < ComponentVec_getLength(psComponents);
+       ulIndex++)
+      Intern_release(ComponentVec_get(psComponents, ulIndex));
+   ComponentVec_free(psComponents);
 }
 
 /*
-  Sets *poDComponents to be an ordered collection of component strings
-  in pcPath, or NULL if an error occurs.
+  Makes *psComponents an ordered collection of component strings in
+  pcPath, or leaves it uninitialized if an error occurs, and sets
+  *pulLength to the length of pcPath.
   Returns one of the following statuses:
   * SUCCESS if no error occurrs
   * BAD_PATH if pcPath is the empty string,
@@ -41,82 +182,158 @@ static void Path_freeString(char *pcStr, void *pvExtra) {
              or contains consecutive '/' delimiters
   * MEMORY_ERROR if memory could not be allocated to complete request
 */
-static int Path_split(const char *pcPath, DynArray_T *poDComponents) {
-   const char *pcStart = pcPath;
-   const char *pcEnd = pcPath;
-   char *pcCopy;
-   DynArray_T oDSubstrings;
+static int Path_split(const char *pcPath, ComponentVec *psComponents,
+                      size_t *pulLength) {
+   enum { MAX_SCAN_DEPTH = 32 };
+   size_t aulScanOffsets[MAX_SCAN_DEPTH];
+   size_t *pulOffsets = aulScanOffsets;
+   size_t ulLength = 0;
+   size_t ulDepth = 0;
+   size_t ulIndex;
+   int iStatus;
 
    assert(pcPath != NULL);
-   assert(poDComponents != NULL);
-
-   /* path cannot be empty string */
-   if(*pcPath == '\0') {
-      *poDComponents = NULL;
-      return BAD_PATH;
+   assert(psComponents != NULL);
+   assert(pulLength != NULL);
+
+   /* validate pcPath and locate its components */
+   iStatus = PathScan_scan(pcPath, aulScanOffsets, MAX_SCAN_DEPTH,
+                           &ulLength, &ulDepth);
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   /* rarely, there are too many components for the local array */
+   if(ulDepth > MAX_SCAN_DEPTH) {
+      pulOffsets = malloc(ulDepth * sizeof(size_t));
+      if(pulOffsets == NULL)
+         return MEMORY_ERROR;
+      (void) PathScan_scan(pcPath, pulOffsets, ulDepth, &ulLength,
+                           &ulDepth);
    }
 
-   oDSubstrings = DynArray_new(0);
-   if(oDSubstrings == NULL) {
-      *poDComponents = NULL;
+   if(!ComponentVec_init(psComponents, ulDepth)) {
+      if(pulOffsets != aulScanOffsets)
+         free(pulOffsets);
       return MEMORY_ERROR;
    }
 
-   /* validate and split pcPath */
-   while(*pcEnd != '\0') {
-      pcEnd = pcStart;
-      /* component can't start with delimiter */
-      if(*pcEnd == '/') {
-         DynArray_map(oDSubstrings,
-                      (void (*)(void*, void*)) Path_freeString, NULL);
-         DynArray_free(oDSubstrings);
-         *poDComponents = NULL;
-         return BAD_PATH;
+   /* intern each component, which ends one byte before the next one
+      starts (or at the end of pcPath) */
+   for(ulIndex = 0; ulIndex < ulDepth; ulIndex++) {
+      size_t ulEnd = ulLength;
+      const char *pcComponent;
+
+      if(ulIndex + 1 < ulDepth)
+         ulEnd = pulOffsets[ulIndex + 1] - 1;
+
+      pcComponent = Intern_acquire(pcPath + pulOffsets[ulIndex],
+                                   ulEnd - pulOffsets[ulIndex]);
+      if(pcComponent == NULL) {
+         Path_releaseComponents(psComponents);
+         if(pulOffsets != aulScanOffsets)
+            free(pulOffsets);
+         return MEMORY_ERROR;
       }
+      (void) ComponentVec_set(psComponents, ulIndex, pcComponent);
+   }
 
-      /* advance pcEnd to end of next token */
-      while(*pcEnd != '/' && *pcEnd != '\0')
-         pcEnd++;
-
-      /* final component can't end with slash */
-      if(*pcEnd == '\0' && *(pcEnd-1) == '/') {
-         DynArray_map(oDSubstrings,
-                      (void (*)(void*, void*)) Path_freeString, NULL);
-         DynArray_free(oDSubstrings);
-         *poDComponents = NULL;
-         return BAD_PATH;
-      }
+   if(pulOffsets != aulScanOffsets)
+      free(pulOffsets);
+   *pulLength = ulLength;
+   return SUCCESS;
+}
 
-      pcCopy = calloc((size_t)(pcEnd-pcStart+1), sizeof(char));
-      if(pcCopy == NULL) {
-         DynArray_map(oDSubstrings,
-                      (void (*)(void*, void*)) Path_freeString, NULL);
-         DynArray_free(oDSubstrings);
-         *poDComponents = NULL;
-         return MEMORY_ERROR;
-      }
 
-      if( DynArray_add(oDSubstrings, pcCopy) == 0) {
-         DynArray_map(oDSubstrings,
-                      (void (*)(void*, void*)) Path_freeString, NULL);
-         DynArray_free(oDSubstrings);
-         *poDComponents = NULL;
-         return MEMORY_ERROR;
-      }
+int Path_parseInto(const char *pcPath, PathView *psView) {
+   size_t aulOffsets[PATH_VIEW_DEPTH + 1];
+   size_t ulLength = 0;
+   size_t ulDepth = 0;
+   size_t ulIndex;
+   int iStatus;
 
-      while(pcStart != pcEnd) {
-         *pcCopy = *pcStart;
-         pcCopy++;
-         pcStart++;
-      }
+   assert(pcPath != NULL);
+   assert(psView != NULL);
+
+   iStatus = PathScan_scan(pcPath, aulOffsets, PATH_VIEW_DEPTH + 1,
+                           &ulLength, &ulDepth);
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   psView->pcPath = pcPath;
+   psView->ulDepth = ulDepth;
+   psView->ulTailOffset = ulLength;
+   if(ulDepth > PATH_VIEW_DEPTH)
+      psView->ulTailOffset = aulOffsets[PATH_VIEW_DEPTH];
+   psView->ulCursorLevel = PATH_VIEW_DEPTH;
+   psView->ulCursorOffset = psView->ulTailOffset;
+
+   /* look up (but don't add) each component in the intern pool */
+   for(ulIndex = 0; ulIndex < ulDepth && ulIndex < PATH_VIEW_DEPTH;
+       ulIndex++) {
+      size_t ulEnd = ulLength;
+      if(ulIndex + 1 < ulDepth)
+         ulEnd = aulOffsets[ulIndex + 1] - 1;
+      psView->apcComponents[ulIndex] =
+         Intern_find(pcPath + aulOffsets[ulIndex],
+                     ulEnd - aulOffsets[ulIndex]);
+   }
+   return SUCCESS;
+}
+
+void Path_getView(Path_T oPPath, PathView *psView) {
+   size_t ulIndex;
 
-      pcStart++;
+   assert(oPPath != NULL);
+   assert(psView != NULL);
+
+   psView->pcPath = oPPath->pcPath;
+   psView->ulDepth = Path_getDepth(oPPath);
+   psView->ulTailOffset = 0;
+   for(ulIndex = 0; ulIndex < psView->ulDepth &&
+          ulIndex < PATH_VIEW_DEPTH; ulIndex++) {
+      psView->apcComponents[ulIndex] =
+         Path_getComponent(oPPath, ulIndex);
+      psView->ulTailOffset +=
+         Intern_getLength(psView->apcComponents[ulIndex]) + 1;
    }
+   if(psView->ulDepth <= PATH_VIEW_DEPTH)
+      psView->ulTailOffset = oPPath->ulLength;
+   psView->ulCursorLevel = PATH_VIEW_DEPTH;
+   psView->ulCursorOffset = psView->ulTailOffset;
+}
 
-   *poDComponents = oDSubstrings;
-   return SUCCESS;
+size_t Path_getViewDepth(const PathView *psView) {
+   assert(psView != NULL);
+
+   return psView->ulDepth;
+}
+
+const char *Path_getViewComponent(PathView *psView, size_t ulLevel) {
+   const char *pcComponent;
+
+   assert(psView != NULL);
+
+   if(ulLevel >= psView->ulDepth)
+      return NULL;
+   if(ulLevel < PATH_VIEW_DEPTH)
+      return psView->apcComponents[ulLevel];
+
+   /* find a deeper component by skipping delimiters, from the last
+      one found if it is no deeper, or else from the first */
+   if(ulLevel < psView->ulCursorLevel) {
+      psView->ulCursorLevel = PATH_VIEW_DEPTH;
+      psView->ulCursorOffset = psView->ulTailOffset;
+   }
+   pcComponent = psView->pcPath + psView->ulCursorOffset;
+   for(; psView->ulCursorLevel < ulLevel; psView->ulCursorLevel++)
+      pcComponent = strchr(pcComponent, '/') + 1;
+   psView->ulCursorOffset = (size_t) (pcComponent - psView->pcPath);
+   return Intern_find(pcComponent, strcspn(pcComponent, "/"));
 }
 
+void Path_setHashConsing(boolean bEnabled) {
+   bHashConsing = bEnabled;
+}
 
 int Path_new(const char *pcPath, Path_T *poPResult) {
    struct path *psNew;
@@ -125,6 +342,19 @@ int Path_new(const char *pcPath, Path_T *poPResult) {
    assert(pcPath != NULL);
    assert(poPResult != NULL);
 
+   /* share the canonical path if there is one: it is known to be
+      well-formatted, so there is no need to split pcPath */
+   if(bHashConsing) {
+      size_t ulLength = strlen(pcPath);
+      psNew = Path_findCanonical(pcPath, ulLength, NULL, 0,
+                                 Intern_hash(pcPath, ulLength));
+      if(psNew != NULL) {
+         psNew->ulRefCount++;
+         *poPResult = psNew;
+         return SUCCESS;
+      }
+   }
+
    psNew = calloc(1, sizeof(struct path));
    if(psNew == NULL) {
       *poPResult = NULL;
@@ -132,21 +362,25 @@ int Path_new(const char *pcPath, Path_T *poPResult) {
    }
 
    /* instantiate and fill list of components */
-   iSplitResult = Path_split(pcPath, &psNew->oDComponents);
+   iSplitResult = Path_split(pcPath, &psNew->sComponents,
+                             &psNew->ulLength);
    if(iSplitResult != SUCCESS) {
       Path_free(psNew);
       *poPResult = NULL;
       return iSplitResult;
    }
 
-   psNew->ulLength = strlen(pcPath);
    psNew->pcPath = malloc(psNew->ulLength+1);
    if(psNew->pcPath == NULL) {
       Path_free(psNew);
       *poPResult = NULL;
       return MEMORY_ERROR;
    }
-   strcpy((char *)psNew->pcPath, pcPath);
+   memcpy((char *)psNew->pcPath, pcPath, psNew->ulLength+1);
+   psNew->ulHash = Intern_hash(pcPath, psNew->ulLength);
+
+   if(bHashConsing)
+      Path_addCanonical(psNew);
 
    *poPResult = psNew;
    return SUCCESS;
@@ -154,11 +388,9 @@ int Path_new(const char *pcPath, Path_T *poPResult) {
 
 int Path_prefix(Path_T oPPath, size_t ulDepth, Path_T *poPResult) {
    struct path *psNew;
-   size_t ulIndex, ulLength, ulSum;
-   const char *pcComponent;
-   char *pcCopy;
+   size_t ulIndex, ulLength;
+   unsigned long ulHash;
    char *pcBuild;
-   char *pcInsert;
 
    assert(oPPath != NULL);
    assert(poPResult != NULL);
@@ -175,60 +407,139 @@ int Path_prefix(Path_T oPPath, size_t ulDepth, Path_T *poPResult) {
       return NO_SUCH_PATH;
    }
 
+   /* the prefix's pathname is the start of oPPath's, up to the end of
+      its last component */
+   ulLength = ulDepth - 1;
+   for(ulIndex = 0; ulIndex < ulDepth; ulIndex++)
+      ulLength += Intern_getLength(Path_getComponent(oPPath, ulIndex));
+   ulHash = Intern_hash(oPPath->pcPath, ulLength);
+
+   if(bHashConsing) {
+      psNew = Path_findCanonical(oPPath->pcPath, ulLength, NULL, 0,
+                                 ulHash);
+      if(psNew != NULL) {
+         psNew->ulRefCount++;
+         *poPResult = psNew;
+         return SUCCESS;
+      }
+   }
+
    psNew = calloc(1, sizeof(struct path));
    if(psNew == NULL) {
       *poPResult = NULL;
       return MEMORY_ERROR;
    }
 
-   psNew->oDComponents = DynArray_new(ulDepth);
-   if(psNew->oDComponents == NULL) {
+   if(!ComponentVec_init(&psNew->sComponents, ulDepth)) {
       Path_free(psNew);
       *poPResult = NULL;
       return MEMORY_ERROR;
    }
 
-   pcBuild = calloc(Path_getStrLength(oPPath)+1, sizeof(char));
+   pcBuild = malloc(ulLength + 1);
    if(pcBuild == NULL) {
       Path_free(psNew);
       *poPResult = NULL;
       return MEMORY_ERROR;
    }
+   memcpy(pcBuild, oPPath->pcPath, ulLength);
+   pcBuild[ulLength] = '\0';
+   psNew->pcPath = pcBuild;
+   psNew->ulLength = ulLength;
+   psNew->ulHash = ulHash;
 
-   pcInsert = pcBuild;
-   ulSum = 0;
+   /* share each interned component with the new path */
+   for(ulIndex = 0; ulIndex < ulDepth; ulIndex++)
+      (void) ComponentVec_set(&psNew->sComponents, ulIndex,
+                              Intern_retain(
+                                 Path_getComponent(oPPath, ulIndex)));
 
-   for(ulIndex = 0; ulIndex < ulDepth; ulIndex++) {
-      /* deep copy each component to new DynArray */
-      pcComponent = Path_getComponent(oPPath, ulIndex);
-      ulLength = strlen(pcComponent);
-      pcCopy = calloc(ulLength + 1, sizeof(char));
-      if(pcCopy == NULL) {
-         free(pcBuild);
-         Path_free(psNew);
-         *poPResult = NULL;
-         return MEMORY_ERROR;
+   if(bHashConsing)
+      Path_addCanonical(psNew);
+
+   *poPResult = psNew;
+   return SUCCESS;
+}
+
+int Path_child(Path_T oPParent, const char *pcComponent,
+               Path_T *poPResult) {
+   struct path *psNew;
+   size_t ulParentDepth, ulComponentLength, ulIndex;
+   unsigned long ulHash;
+   const char *pcInterned;
+   char *pcBuild;
+
+   assert(oPParent != NULL);
+   assert(pcComponent != NULL);
+   assert(poPResult != NULL);
+
+   /* a component can't be empty or contain a delimiter */
+   ulComponentLength = strlen(pcComponent);
+   if(ulComponentLength == 0 ||
+      memchr(pcComponent, '/', ulComponentLength) != NULL) {
+      *poPResult = NULL;
+      return BAD_PATH;
+   }
+
+   /* the child's hash continues from the parent's */
+   ulHash = Intern_extendHash(oPParent->ulHash, "/", 1);
+   ulHash = Intern_extendHash(ulHash, pcComponent, ulComponentLength);
+
+   if(bHashConsing) {
+      psNew = Path_findCanonical(oPParent->pcPath, oPParent->ulLength,
+                                 pcComponent, ulComponentLength,
+                                 ulHash);
+      if(psNew != NULL) {
+         psNew->ulRefCount++;
+         *poPResult = psNew;
+         return SUCCESS;
       }
-      strcpy(pcCopy, pcComponent);
-      (void) DynArray_set(psNew->oDComponents, ulIndex, pcCopy);
-      /* construct prefix's pathname string */
-      strcpy(pcInsert, pcComponent);
-      pcInsert[ulLength] = '/';
-      ulSum += ulLength + 1;
-      pcInsert += ulLength + 1;
    }
-   pcBuild[ulSum-1] = '\0';
 
-   /* shrink allocation to fit prefix's pathname string if needed */
-   pcInsert = realloc(pcBuild, ulSum);
-   if(pcInsert == NULL) {
-      free(pcBuild);
+   psNew = calloc(1, sizeof(struct path));
+   if(psNew == NULL) {
+      *poPResult = NULL;
+      return MEMORY_ERROR;
+   }
+
+   ulParentDepth = Path_getDepth(oPParent);
+   if(!ComponentVec_init(&psNew->sComponents, ulParentDepth + 1)) {
+      Path_free(psNew);
+      *poPResult = NULL;
+      return MEMORY_ERROR;
+   }
+
+   pcInterned = Intern_acquire(pcComponent, ulComponentLength);
+   if(pcInterned == NULL) {
       Path_free(psNew);
       *poPResult = NULL;
       return MEMORY_ERROR;
    }
-   psNew->ulLength = ulSum-1;
-   psNew->pcPath = pcInsert;
+   (void) ComponentVec_set(&psNew->sComponents, ulParentDepth,
+                           pcInterned);
+
+   psNew->ulLength = oPParent->ulLength + 1 + ulComponentLength;
+   pcBuild = malloc(psNew->ulLength + 1);
+   if(pcBuild == NULL) {
+      Path_free(psNew);
+      *poPResult = NULL;
+      return MEMORY_ERROR;
+   }
+   memcpy(pcBuild, oPParent->pcPath, oPParent->ulLength);
+   pcBuild[oPParent->ulLength] = '/';
+   memcpy(pcBuild + oPParent->ulLength + 1, pcComponent,
+          ulComponentLength + 1);
+   psNew->pcPath = pcBuild;
+   psNew->ulHash = ulHash;
+
+   /* share the parent's interned components */
+   for(ulIndex = 0; ulIndex < ulParentDepth; ulIndex++)
+      (void) ComponentVec_set(&psNew->sComponents, ulIndex,
+                              Intern_retain(
+                                 Path_getComponent(oPParent, ulIndex)));
+
+   if(bHashConsing)
+      Path_addCanonical(psNew);
 
    *poPResult = psNew;
    return SUCCESS;
@@ -238,18 +549,27 @@ int Path_dup(Path_T oPPath, Path_T *poPResult) {
    assert(oPPath != NULL);
    assert(poPResult != NULL);
 
+   /* a canonical path is shared rather than copied */
+   if(oPPath->ulRefCount > 0) {
+      ((struct path *) oPPath)->ulRefCount++;
+      *poPResult = oPPath;
+      return SUCCESS;
+   }
+
    return Path_prefix(oPPath, Path_getDepth(oPPath), poPResult);
 }
 
 void Path_free(Path_T oPPath) {
+   /* a canonical path is freed with its last reference */
+   if(oPPath != NULL && oPPath->ulRefCount > 0) {
+      if(--((struct path *) oPPath)->ulRefCount > 0)
+         return;
+      Path_removeCanonical((struct path *) oPPath);
+   }
+
    if(oPPath != NULL) {
       free((char *)oPPath->pcPath);
-
-      if(oPPath->oDComponents != NULL) {
-         DynArray_map(oPPath->oDComponents,
-                      (void (*)(void*, void*)) Path_freeString, NULL);
-         DynArray_free(oPPath->oDComponents);
-      }
+      Path_releaseComponents(&((struct path *) oPPath)->sComponents);
    }
    free((struct path*) oPPath);
 }
@@ -270,9 +590,28 @@ int Path_comparePath(Path_T oPPath1, Path_T oPPath2) {
    assert(oPPath1 != NULL);
    assert(oPPath2 != NULL);
 
+   if(oPPath1 == oPPath2)
+      return 0;
+
    return strcmp(oPPath1->pcPath, oPPath2->pcPath);
 }
 
+boolean Path_equals(Path_T oPPath1, Path_T oPPath2) {
+   assert(oPPath1 != NULL);
+   assert(oPPath2 != NULL);
+
+   if(oPPath1 == oPPath2)
+      return TRUE;
+   /* distinct canonical paths are never equal */
+   if(oPPath1->ulRefCount > 0 && oPPath2->ulRefCount > 0)
+      return FALSE;
+   if(oPPath1->ulHash != oPPath2->ulHash ||
+      oPPath1->ulLength != oPPath2->ulLength)
+      return FALSE;
+   return (boolean) !memcmp(oPPath1->pcPath, oPPath2->pcPath,
+                            oPPath1->ulLength);
+}
+
 int Path_compareString(Path_T oPPath, const char *pcStr) {
    assert(oPPath != NULL);
    assert(pcStr != NULL);
@@ -280,10 +619,16 @@ int Path_compareString(Path_T oPPath, const char *pcStr) {
    return strcmp(oPPath->pcPath, pcStr);
 }
 
+unsigned long Path_getHash(Path_T oPPath) {
+   assert(oPPath != NULL);
+
+   return oPPath->ulHash;
+}
+
 size_t Path_getDepth(Path_T oPPath) {
    assert(oPPath != NULL);
 
-   return DynArray_getLength(oPPath->oDComponents);
+   return ComponentVec_getLength(&oPPath->sComponents);
 }
 
 size_t Path_getSharedPrefixDepth(Path_T oPPath1, Path_T oPPath2) {
@@ -298,9 +643,10 @@ size_t Path_getSharedPrefixDepth(Path_T oPPath1, Path_T oPPath2) {
       ulMin = ulDepth1;
    else
       ulMin = ulDepth2;
+   /* interned components are equal exactly when they are the same
+      string */
    for(i = 0; i < ulMin; i++) {
-      if(strcmp(Path_getComponent(oPPath1, i),
-                Path_getComponent(oPPath2, i)))
+      if(Path_getComponent(oPPath1, i) != Path_getComponent(oPPath2, i))
          return i;
    }
    return ulMin;
@@ -312,5 +658,5 @@ const char *Path_getComponent(Path_T oPPath, size_t ulLevel) {
    if(ulLevel >= Path_getDepth(oPPath))
       return NULL;
 
-   return DynArray_get(oPPath->oDComponents, ulLevel);
+   return ComponentVec_get(&oPPath->sComponents, ulLevel);
 }
@@ -12,6 +12,45 @@
 /* An object representing an absolute path in a tree */
 typedef const struct path * Path_T;
 
+/* The number of components that a PathView locates in advance; any
+   deeper components are found by scanning on from the last one asked
+   for when they are asked for */
+enum { PATH_VIEW_DEPTH = 32 };
+
+/*
+  A read-only view of an absolute path whose string belongs to the
+  caller. A PathView is meant to be declared on the stack and filled in
+  by Path_parseInto or Path_getView, neither of which allocates memory,
+  and stays valid as long as that string (or path object) does. Its
+  fields are private to the path module.
+*/
+typedef struct PathView {
+   /* The string representation of the path */
+   const char *pcPath;
+   /* The number of components in the path */
+   size_t ulDepth;
+   /* The interned string of each of the first PATH_VIEW_DEPTH
+      components, or NULL for a component that is in no path object */
+   const char *apcComponents[PATH_VIEW_DEPTH];
+   /* The offset in pcPath of component PATH_VIEW_DEPTH, if any */
+   size_t ulTailOffset;
+   /* The level, at least PATH_VIEW_DEPTH, and the offset in pcPath of
+      the deeper component last asked for, or of component
+      PATH_VIEW_DEPTH if none has been */
+   size_t ulCursorLevel;
+   size_t ulCursorOffset;
+} PathView;
+
+/*
+  Turns hash-consing of new paths on (if bEnabled) or off. While it is
+  on, Path_new, Path_dup, and Path_prefix return the one canonical path
+  object for each pathname, shared by reference count, so that equal
+  canonical paths are the same pointer; each path so obtained must
+  still be passed to Path_free exactly once. Paths that already exist
+  are unaffected. Hash-consing is off until this is first called.
+*/
+void Path_setHashConsing(boolean bEnabled);
+
 /*
   Creates a new path object representing the absolute path in pcPath.
   Returns an int SUCCESS status and sets *poPResult to be the new path
@@ -23,6 +62,34 @@ typedef const struct path * Path_T;
 */
 int Path_new(const char *pcPath, Path_T *poPResult);
 
+/*
+  Fills in *psView to view the absolute path in pcPath, without
+  allocating memory. Returns SUCCESS if successful. Otherwise, leaves
+  *psView undefined and returns status:
+  * BAD_PATH if the string argument is the empty string
+             or begins with or ends with a '/'
+             or contains consecutive '/' delimiters
+*/
+int Path_parseInto(const char *pcPath, PathView *psView);
+
+/* Fills in *psView to view oPPath, without allocating memory. */
+void Path_getView(Path_T oPPath, PathView *psView);
+
+/* Returns the number of components in the path that psView views. */
+size_t Path_getViewDepth(const PathView *psView);
+
+/*
+  Returns the component at level ulLevel of the path that psView views
+  as the same interned string that Path_getComponent would return for
+  it, so that it can be compared with path objects' components by
+  pointer. Returns NULL if no path object has such a component, or if
+  ulLevel is greater than the path's maximum level. Asking for the
+  components below PATH_VIEW_DEPTH in increasing order takes time
+  proportional to their total length, as *psView remembers where the
+  last one was.
+*/
+const char *Path_getViewComponent(PathView *psView, size_t ulLevel);
+
 /*
   Creates a "deep copy" of oPPath, duplicating all its contents.
   Returns an int SUCCESS status and sets *poPResult to be the new path
@@ -43,6 +110,19 @@ int Path_dup(Path_T oPPath, Path_T *poPResult);
 */
 int Path_prefix(Path_T oPPath, size_t ulDepth, Path_T *poPResult);
 
+/*
+  Creates a new path object representing the child of oPParent named
+  pcComponent, checking only pcComponent and reusing oPParent's
+  components. While hash-consing is on, finding an existing child takes
+  time proportional to the length of pcComponent to hash it.
+  Returns an int SUCCESS status and sets *poPResult to be the new path
+  if successful. Otherwise, sets *poPResult to NULL and returns status:
+  * MEMORY_ERROR if memory could not be allocated to complete request
+  * BAD_PATH if pcComponent is the empty string or contains a '/'
+*/
+int Path_child(Path_T oPParent, const char *pcComponent,
+               Path_T *poPResult);
+
 /* Destroys and frees all memory allocated for oPPath. */
 void Path_free(Path_T oPPath);
 
@@ -62,6 +142,13 @@ size_t Path_getStrLength(Path_T oPPath);
 */
 int Path_comparePath(Path_T oPPath1, Path_T oPPath2);
 
+/*
+  Returns TRUE if oPPath1 and oPPath2 have the same pathname, or FALSE
+  otherwise. Two hash-consed paths are compared by pointer; other paths
+  are compared by their stored hashes first.
+*/
+boolean Path_equals(Path_T oPPath1, Path_T oPPath2);
+
 /*
   Compares oPPath's pathname with pcStr lexicographically.
   Returns <0, 0, or >0 if oPPath is "less than", "equal to", or
@@ -69,6 +156,13 @@ int Path_comparePath(Path_T oPPath1, Path_T oPPath2);
 */
 int Path_compareString(Path_T oPPath, const char *pcStr);
 
+/*
+  Returns a 64-bit (on LP64 platforms) hash of oPPath's pathname,
+  computed when oPPath was created. Paths with equal pathnames have
+  equal hashes.
+*/
+unsigned long Path_getHash(Path_T oPPath);
+
 /*
   Returns the number of separate levels (components) in oPPath.
   For example, the absolute path "someRoot" has depth 1, and
@@ -90,6 +184,8 @@ size_t Path_getSharedPrefixDepth(Path_T oPPath1, Path_T oPPath2);
   ulLevel. This count is from 0, so with level 0 the root of oPPath
   would be returned.
   Returns NULL if ulLevel is greater than oPPath's maxium level.
+  Components are interned: the components of any two paths are equal
+  strings if and only if they are the same pointer.
 */
 const char *Path_getComponent(Path_T oPPath, size_t ulLevel);
 
@@ -0,0 +1,259 @@
+/*--------------------------------------------------------------------*/
+/* pathscan.c                                                         */
+/* Author: Josh Schoenberg and Jack Toubes                            */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stddef.h>
+
+#include "pathscan.h"
+
+/* The vectorized scans use GCC's x86 intrinsics and builtins; other
+   compilers and targets use the scalar scan only. */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PATHSCAN_X86
+#include <immintrin.h>
+#endif
+
+/* The vectorized scans deliberately read the whole aligned chunks that
+   hold pcPath, which AddressSanitizer would report as overflows. */
+#if defined(__SANITIZE_ADDRESS__)
+#define PATHSCAN_NO_ASAN __attribute__((no_sanitize_address))
+#else
+#define PATHSCAN_NO_ASAN
+#endif
+
+/* A function that implements PathScan_scan. */
+typedef int (*PathScan_Fn)(const char *pcPath, size_t *pulOffsets,
+                           size_t ulCapacity, size_t *pulLength,
+                           size_t *pulDepth);
+
+/*--------------------------------------------------------------------*/
+
+/*
+  Implements PathScan_scan one byte at a time.
+*/
+static int PathScan_scalar(const char *pcPath, size_t *pulOffsets,
+                           size_t ulCapacity, size_t *pulLength,
+                           size_t *pulDepth) {
+   size_t ulDepth = 0;
+   size_t i;
+   /* whether the previous character was a delimiter, or there was no
+      previous character */
+   boolean bAfterDelimiter = TRUE;
+
+   assert(pcPath != NULL);
+   assert(pulLength != NULL);
+   assert(pulDepth != NULL);
+
+   for(i = 0; pcPath[i] != '\0'; i++) {
+      if(pcPath[i] == '/') {
+         /* component can't be empty */
+         if(bAfterDelimiter)
+            return BAD_PATH;
+         bAfterDelimiter = TRUE;
+      }
+      else if(bAfterDelimiter) {
+         if(ulDepth < ulCapacity)
+            pulOffsets[ulDepth] = i;
+         ulDepth++;
+         bAfterDelimiter = FALSE;
+      }
+   }
+
+   /* path can't be empty or end with a delimiter */
+   if(bAfterDelimiter)
+      return BAD_PATH;
+
+   *pulLength = i;
+   *pulDepth = ulDepth;
+   return SUCCESS;
+}
+
+#ifdef PATHSCAN_X86
+
+/*
+  Given the bit masks uiSlash and uiNul of the '/' and '\0' bytes in
+  a chunk of ulWidth bytes starting at pcChunk, and uiAfter, the mask
+  of positions in the chunk whose previous byte was a delimiter or
+  precedes pcPath, processes the chunk for PathScan_scan: records the
+  components starting in it in pulOffsets and *pulDepth, and sets
+  *pbDone if it holds the end of pcPath. Returns BAD_PATH if the chunk
+  shows pcPath to be badly formatted and SUCCESS otherwise.
+*/
+static int PathScan_chunk(const char *pcPath, const char *pcChunk,
+                          unsigned int uiSlash, unsigned int uiNul,
+                          unsigned int uiAfter, size_t *pulOffsets,
+                          size_t ulCapacity, size_t *pulLength,
+                          size_t *pulDepth, boolean *pbDone) {
+   if(uiNul != 0) {
+      unsigned int uiEnd = (unsigned int) __builtin_ctz(uiNul);
+
+      /* path can't be empty or end with a delimiter */
+      if(uiAfter & (1u << uiEnd))
+         return BAD_PATH;
+      /* ignore whatever follows the terminator */
+      uiSlash &= (1u << uiEnd) - 1;
+      *pulLength = (size_t) (pcChunk + uiEnd - pcPath);
+      *pbDone = TRUE;
+   }
+
+   /* component can't start with (or be) a delimiter */
+   if(uiSlash & uiAfter)
+      return BAD_PATH;
+
+   /* each delimiter begins a component at the next byte */
+   while(uiSlash != 0) {
+      unsigned int uiBit = (unsigned int) __builtin_ctz(uiSlash);
+      if(*pulDepth < ulCapacity)
+         pulOffsets[*pulDepth] = (size_t) (pcChunk + uiBit + 1 - pcPath);
+      (*pulDepth)++;
+      uiSlash &= uiSlash - 1;
+   }
+   return SUCCESS;
+}
+
+/*
+  Implements PathScan_scan 16 bytes at a time with SSE2. Loads are
+  aligned, so they never cross into a page that pcPath does not
+  touch.
+*/
+__attribute__((target("sse2"))) PATHSCAN_NO_ASAN
+static int PathScan_sse2(const char *pcPath, size_t *pulOffsets,
+                         size_t ulCapacity, size_t *pulLength,
+                         size_t *pulDepth) {
+   enum { WIDTH = 16 };
+   const __m128i vSlash = _mm_set1_epi8('/');
+   const __m128i vNul = _mm_setzero_si128();
+   size_t ulSkip = (size_t) pcPath % WIDTH;
+   const char *pcChunk = pcPath - ulSkip;
+   unsigned int uiAfter = 1u << ulSkip;
+   size_t ulLength = 0;
+   size_t ulDepth = 1;
+   boolean bDone = FALSE;
+
+   assert(pcPath != NULL);
+   assert(pulLength != NULL);
+   assert(pulDepth != NULL);
+
+   /* a well-formatted path's first component starts at its start */
+   if(ulCapacity > 0)
+      pulOffsets[0] = 0;
+
+   while(!bDone) {
+      __m128i vChunk = _mm_load_si128((const __m128i *) pcChunk);
+      unsigned int uiSlash = (unsigned int)
+         _mm_movemask_epi8(_mm_cmpeq_epi8(vChunk, vSlash));
+      unsigned int uiNul = (unsigned int)
+         _mm_movemask_epi8(_mm_cmpeq_epi8(vChunk, vNul));
+
+      /* ignore whatever precedes pcPath in the first chunk */
+      uiSlash &= ~0u << ulSkip;
+      uiNul &= ~0u << ulSkip;
+      ulSkip = 0;
+
+      if(PathScan_chunk(pcPath, pcChunk, uiSlash, uiNul,
+                        uiAfter | (uiSlash << 1), pulOffsets,
+                        ulCapacity, &ulLength, &ulDepth, &bDone)
+         != SUCCESS)
+         return BAD_PATH;
+
+      uiAfter = (uiSlash >> (WIDTH - 1)) & 1u;
+      pcChunk += WIDTH;
+   }
+
+   *pulLength = ulLength;
+   *pulDepth = ulDepth;
+   return SUCCESS;
+}
+
+/*
+  Implements PathScan_scan 32 bytes at a time with AVX2. Loads are
+  aligned, so they never cross into a page that pcPath does not
+  touch.
+*/
+__attribute__((target("avx2"))) PATHSCAN_NO_ASAN
+static int PathScan_avx2(const char *pcPath, size_t *pulOffsets,
+                         size_t ulCapacity, size_t *pulLength,
+                         size_t *pulDepth) {
+   enum { WIDTH = 32 };
+   const __m256i vSlash = _mm256_set1_epi8('/');
+   const __m256i vNul = _mm256_setzero_si256();
+   size_t ulSkip = (size_t) pcPath % WIDTH;
+   const char *pcChunk = pcPath - ulSkip;
+   unsigned int uiAfter = 1u << ulSkip;
+   size_t ulLength = 0;
+   size_t ulDepth = 1;
+   boolean bDone = FALSE;
+
+   assert(pcPath != NULL);
+   assert(pulLength != NULL);
+   assert(pulDepth != NULL);
+
+   /* a well-formatted path's first component starts at its start */
+   if(ulCapacity > 0)
+      pulOffsets[0] = 0;
+
+   while(!bDone) {
+      __m256i vChunk = _mm256_load_si256((const __m256i *) pcChunk);
+      unsigned int uiSlash = (unsigned int)
+         _mm256_movemask_epi8(_mm256_cmpeq_epi8(vChunk, vSlash));
+      unsigned int uiNul = (unsigned int)
+         _mm256_movemask_epi8(_mm256_cmpeq_epi8(vChunk, vNul));
+
+      /* ignore whatever precedes pcPath in the first chunk */
+      uiSlash &= ~0u << ulSkip;
+      uiNul &= ~0u << ulSkip;
+      ulSkip = 0;
+
+      if(PathScan_chunk(pcPath, pcChunk, uiSlash, uiNul,
+                        uiAfter | (uiSlash << 1), pulOffsets,
+                        ulCapacity, &ulLength, &ulDepth, &bDone)
+         != SUCCESS)
+         return BAD_PATH;
+
+      uiAfter = (uiSlash >> (WIDTH - 1)) & 1u;
+      pcChunk += WIDTH;
+   }
+
+   *pulLength = ulLength;
+   *pulDepth = ulDepth;
+   return SUCCESS;
+}
+
+#endif
+
+/*
+  Returns the fastest implementation of PathScan_scan that the CPU
+  supports.
+*/
+static PathScan_Fn PathScan_choose(void) {
+#ifdef PATHSCAN_X86
+   __builtin_cpu_init();
+   if(__builtin_cpu_supports("avx2"))
+      return PathScan_avx2;
+   if(__builtin_cpu_supports("sse2"))
+      return PathScan_sse2;
+#endif
+   return PathScan_scalar;
+}
+
+/*--------------------------------------------------------------------*/
+
+int PathScan_scan(const char *pcPath, size_t *pulOffsets,
+                  size_t ulCapacity, size_t *pulLength,
+                  size_t *pulDepth) {
+   /* the implementation in use, chosen at the first call */
+   static PathScan_Fn pfScan = NULL;
+
+   assert(pcPath != NULL);
+   assert(pulOffsets != NULL || ulCapacity == 0);
+   assert(pulLength != NULL);
+   assert(pulDepth != NULL);
+
+   if(pfScan == NULL)
+      pfScan = PathScan_choose();
+
+   return (*pfScan)(pcPath, pulOffsets, ulCapacity, pulLength,
+                    pulDepth);
+}
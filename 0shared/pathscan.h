@@ -0,0 +1,30 @@
+/*--------------------------------------------------------------------*/
+/* pathscan.h                                                         */
+/* Author: Josh Schoenberg and Jack Toubes                            */
+/*--------------------------------------------------------------------*/
+
+#ifndef PATHSCAN_INCLUDED
+#define PATHSCAN_INCLUDED
+
+#include <stddef.h>
+#include "a4def.h"
+
+/*
+  Validates pcPath as a '/'-delimited path and locates its components
+  in one pass over the string. Where the CPU supports it, the scan
+  examines 16 or 32 bytes at a time; the implementation is chosen once,
+  at the first call.
+  Returns SUCCESS, sets *pulLength to the length of pcPath and
+  *pulDepth to its number of components, and stores the offset of the
+  first character of component i in pulOffsets[i] for each i less than
+  both *pulDepth and ulCapacity. (When *pulDepth exceeds ulCapacity,
+  the scan can be repeated with a large enough array.)
+  Otherwise returns BAD_PATH, leaving *pulLength and *pulDepth
+  unchanged, if pcPath is the empty string, or begins or ends with a
+  '/', or contains consecutive '/' delimiters.
+*/
+int PathScan_scan(const char *pcPath, size_t *pulOffsets,
+                  size_t ulCapacity, size_t *pulLength,
+                  size_t *pulDepth);
+
+#endif
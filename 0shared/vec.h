@@ -0,0 +1,311 @@
+/*--------------------------------------------------------------------*/
+/* vec.h                                                              */
+/* Author: Josh Schoenberg and Jack Toubes                            */
+/*--------------------------------------------------------------------*/
+
+#ifndef VEC_INCLUDED
+#define VEC_INCLUDED
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* DEFINE_VEC(Name, Type, Compare) defines a vector type Name, a
+   DynArray whose elements have type Type rather than void*, together
+   with its functions Name_init, Name_free, Name_getLength, Name_get,
+   Name_set, Name_add, Name_addAt, Name_removeAt, Name_bsearch, and
+   Name_sort.  Compare(tElement1, tElement2) must return <0, 0, or >0
+   depending upon whether tElement1 is less than, equal to, or greater
+   than tElement2; it may be a macro or a function, and the compiler
+   sees it at each use, so it is not called through a pointer.
+
+   A Name object is a structure that its client owns (typically as a
+   member of another structure or a local variable) and passes by
+   address.  Its functions are static, and inline where the compiler
+   supports it, in each file that uses DEFINE_VEC. */
+
+/*--------------------------------------------------------------------*/
+
+/* How the functions of a vector are declared. */
+
+#if defined(__GNUC__)
+#define VEC_FUNCTION static __inline__
+#else
+#define VEC_FUNCTION static
+#endif
+
+/* The minimum physical length of a vector. */
+
+#define VEC_MIN_PHYS_LENGTH 2
+
+/* Ranges no longer than this are sorted by insertion. */
+
+#define VEC_INSERTION_SORT_LENGTH 16
+
+/*--------------------------------------------------------------------*/
+
+#define DEFINE_VEC(Name, Type, Compare)                                 \
+                                                                        \
+/* A Name consists of an array of Type, along with its logical and      \
+   physical lengths. */                                                 \
+                                                                        \
+typedef struct Name                                                     \
+{                                                                       \
+   size_t uLength;                                                      \
+   size_t uPhysLength;                                                  \
+   Type *ptElements;                                                    \
+} Name;                                                                 \
+                                                                        \
+/* Make *psVec a vector whose length is uLength and whose elements      \
+   are all bits zero.  Return 1 (TRUE) if successful, or 0 (FALSE) if   \
+   insufficient memory is available. */                                 \
+                                                                        \
+VEC_FUNCTION int Name##_init(Name *psVec, size_t uLength)               \
+{                                                                       \
+   assert(psVec != NULL);                                               \
+                                                                        \
+   psVec->uLength = uLength;                                            \
+   psVec->uPhysLength = uLength;                                        \
+   if (psVec->uPhysLength < VEC_MIN_PHYS_LENGTH)                        \
+      psVec->uPhysLength = VEC_MIN_PHYS_LENGTH;                         \
+   psVec->ptElements =                                                  \
+      (Type*)calloc(psVec->uPhysLength, sizeof(Type));                  \
+   return psVec->ptElements != NULL;                                    \
+}                                                                       \
+                                                                        \
+/* Free the elements of *psVec, which may not be used again until it    \
+   is initialized again. */                                             \
+                                                                        \
+VEC_FUNCTION void Name##_free(Name *psVec)                              \
+{                                                                       \
+   assert(psVec != NULL);                                               \
+                                                                        \
+   free(psVec->ptElements);                                             \
+   psVec->ptElements = NULL;                                            \
+   psVec->uLength = 0;                                                  \
+   psVec->uPhysLength = 0;                                              \
+}                                                                       \
+                                                                        \
+/* Return the length of *psVec. */                                      \
+                                                                        \
+VEC_FUNCTION size_t Name##_getLength(const Name *psVec)                 \
+{                                                                       \
+   assert(psVec != NULL);                                               \
+                                                                        \
+   return psVec->uLength;                                               \
+}                                                                       \
+                                                                        \
+/* Return the uIndex'th element of *psVec. */                           \
+                                                                        \
+VEC_FUNCTION Type Name##_get(const Name *psVec, size_t uIndex)          \
+{                                                                       \
+   assert(psVec != NULL);                                               \
+   assert(uIndex < psVec->uLength);                                     \
+                                                                        \
+   return psVec->ptElements[uIndex];                                    \
+}                                                                       \
+                                                                        \
+/* Assign tElement to the uIndex'th element of *psVec.  Return the      \
+   old element. */                                                      \
+                                                                        \
+VEC_FUNCTION Type Name##_set(Name *psVec, size_t uIndex, Type tElement) \
+{                                                                       \
+   Type tOldElement;                                                    \
+                                                                        \
+   assert(psVec != NULL);                                               \
+   assert(uIndex < psVec->uLength);                                     \
+                                                                        \
+   tOldElement = psVec->ptElements[uIndex];                             \
+   psVec->ptElements[uIndex] = tElement;                                \
+   return tOldElement;                                                  \
+}                                                                       \
+                                                                        \
+/* Double the physical length of *psVec.  Return 1 (TRUE) if            \
+   successful, or 0 (FALSE) if insufficient memory is available. */     \
+                                                                        \
+VEC_FUNCTION int Name##_grow(Name *psVec)                               \
+{                                                                       \
+   Type *ptNewElements;                                                 \
+                                                                        \
+   assert(psVec != NULL);                                               \
+                                                                        \
+   ptNewElements = (Type*)realloc(psVec->ptElements,                    \
+      sizeof(Type) * 2 * psVec->uPhysLength);                           \
+   if (ptNewElements == NULL)                                           \
+      return 0;                                                         \
+   psVec->ptElements = ptNewElements;                                   \
+   psVec->uPhysLength *= 2;                                             \
+   return 1;                                                            \
+}                                                                       \
+                                                                        \
+/* Add tElement to *psVec such that it is the uIndex'th element.        \
+   Return 1 (TRUE) if successful, or 0 (FALSE) if insufficient memory   \
+   is available. */                                                     \
+                                                                        \
+VEC_FUNCTION int Name##_addAt(Name *psVec, size_t uIndex,               \
+                              Type tElement)                            \
+{                                                                       \
+   assert(psVec != NULL);                                               \
+   assert(uIndex <= psVec->uLength);                                    \
+                                                                        \
+   if (psVec->uLength == psVec->uPhysLength)                            \
+      if (! Name##_grow(psVec))                                         \
+         return 0;                                                      \
+                                                                        \
+   memmove(&psVec->ptElements[uIndex + 1], &psVec->ptElements[uIndex],  \
+           sizeof(Type) * (psVec->uLength - uIndex));                   \
+   psVec->ptElements[uIndex] = tElement;                                \
+   psVec->uLength++;                                                    \
+   return 1;                                                            \
+}                                                                       \
+                                                                        \
+/* Add tElement to the end of *psVec.  Return 1 (TRUE) if successful,   \
+   or 0 (FALSE) if insufficient memory is available. */                 \
+                                                                        \
+VEC_FUNCTION int Name##_add(Name *psVec, Type tElement)                 \
+{                                                                       \
+   assert(psVec != NULL);                                               \
+                                                                        \
+   return Name##_addAt(psVec, psVec->uLength, tElement);                \
+}                                                                       \
+                                                                        \
+/* Remove the uIndex'th element from *psVec.  Return the removed        \
+   element. */                                                          \
+                                                                        \
+VEC_FUNCTION Type Name##_removeAt(Name *psVec, size_t uIndex)           \
+{                                                                       \
+   Type tOldElement;                                                    \
+                                                                        \
+   assert(psVec != NULL);                                               \
+   assert(uIndex < psVec->uLength);                                     \
+                                                                        \
+   tOldElement = psVec->ptElements[uIndex];                             \
+   psVec->uLength--;                                                    \
+   memmove(&psVec->ptElements[uIndex], &psVec->ptElements[uIndex + 1],  \
+           sizeof(Type) * (psVec->uLength - uIndex));                   \
+   return tOldElement;                                                  \
+}                                                                       \
+                                                                        \
+/* Binary search *psVec, which must be sorted, for tSought.  If it is   \
+   found, then assign its index to *puIndex and return 1.  Otherwise    \
+   assign the index where it would belong to *puIndex and return 0. */  \
+                                                                        \
+VEC_FUNCTION int Name##_bsearch(const Name *psVec, Type tSought,        \
+                                size_t *puIndex)                        \
+{                                                                       \
+   size_t uLo = 0;                                                      \
+   size_t uHi;                                                          \
+   size_t uMid;                                                         \
+   int iCompare;                                                        \
+                                                                        \
+   assert(psVec != NULL);                                               \
+   assert(puIndex != NULL);                                             \
+                                                                        \
+   uHi = psVec->uLength;                                                \
+   while (uLo < uHi)                                                    \
+   {                                                                    \
+      uMid = uLo + (uHi - uLo) / 2;                                     \
+      iCompare = Compare(psVec->ptElements[uMid], tSought);             \
+      if (iCompare > 0)                                                 \
+         uHi = uMid;                                                    \
+      else if (iCompare < 0)                                            \
+         uLo = uMid + 1;                                                \
+      else                                                              \
+      {                                                                 \
+         *puIndex = uMid;                                               \
+         return 1;                                                      \
+      }                                                                 \
+   }                                                                    \
+   *puIndex = uLo;                                                      \
+   return 0;                                                            \
+}                                                                       \
+                                                                        \
+/* Sort the uLength elements at ptElements by insertion. */             \
+                                                                        \
+VEC_FUNCTION void Name##_insertionSort(Type *ptElements,                \
+                                       size_t uLength)                  \
+{                                                                       \
+   size_t u, v;                                                         \
+   Type tElement;                                                       \
+                                                                        \
+   for (u = 1; u < uLength; u++)                                        \
+   {                                                                    \
+      tElement = ptElements[u];                                         \
+      for (v = u; v > 0 && Compare(ptElements[v - 1], tElement) > 0;    \
+           v--)                                                         \
+         ptElements[v] = ptElements[v - 1];                             \
+      ptElements[v] = tElement;                                         \
+   }                                                                    \
+}                                                                       \
+                                                                        \
+/* Sort the uLength elements at ptElements by quicksort, recurring      \
+   on the shorter side of each partition so that the depth of           \
+   recursion is logarithmic. */                                         \
+                                                                        \
+VEC_FUNCTION void Name##_quickSort(Type *ptElements, size_t uLength)    \
+{                                                                       \
+   size_t uLo, uHi;                                                     \
+   Type tPivot;                                                         \
+   Type tSwap;                                                          \
+                                                                        \
+   while (uLength > VEC_INSERTION_SORT_LENGTH)                          \
+   {                                                                    \
+      /* the median of the first, middle, and last elements */          \
+      size_t uMid = uLength / 2;                                        \
+      if (Compare(ptElements[uMid], ptElements[0]) < 0)                 \
+         { tSwap = ptElements[uMid]; ptElements[uMid] = ptElements[0];  \
+           ptElements[0] = tSwap; }                                     \
+      if (Compare(ptElements[uLength - 1], ptElements[0]) < 0)          \
+         { tSwap = ptElements[uLength - 1];                             \
+           ptElements[uLength - 1] = ptElements[0];                     \
+           ptElements[0] = tSwap; }                                     \
+      if (Compare(ptElements[uLength - 1], ptElements[uMid]) < 0)       \
+         { tSwap = ptElements[uLength - 1];                             \
+           ptElements[uLength - 1] = ptElements[uMid];                  \
+           ptElements[uMid] = tSwap; }                                  \
+      tPivot = ptElements[uMid];                                        \
+                                                                        \
+      /* Hoare partition: [0, uHi] <= tPivot <= [uHi + 1, uLength) */   \
+      uLo = 0;                                                          \
+      uHi = uLength - 1;                                                \
+      for (;;)                                                          \
+      {                                                                 \
+         while (Compare(ptElements[uLo], tPivot) < 0)                   \
+            uLo++;                                                      \
+         while (Compare(ptElements[uHi], tPivot) > 0)                   \
+            uHi--;                                                      \
+         if (uLo >= uHi)                                                \
+            break;                                                      \
+         tSwap = ptElements[uLo];                                       \
+         ptElements[uLo] = ptElements[uHi];                             \
+         ptElements[uHi] = tSwap;                                       \
+         uLo++;                                                         \
+         uHi--;                                                         \
+      }                                                                 \
+                                                                        \
+      if (uHi + 1 < uLength - uHi - 1)                                  \
+      {                                                                 \
+         Name##_quickSort(ptElements, uHi + 1);                         \
+         ptElements += uHi + 1;                                         \
+         uLength -= uHi + 1;                                            \
+      }                                                                 \
+      else                                                              \
+      {                                                                 \
+         Name##_quickSort(ptElements + uHi + 1, uLength - uHi - 1);     \
+         uLength = uHi + 1;                                             \
+      }                                                                 \
+   }                                                                    \
+   Name##_insertionSort(ptElements, uLength);                           \
+}                                                                       \
+                                                                        \
+/* Sort *psVec in the order determined by Compare. */                   \
+                                                                        \
+VEC_FUNCTION void Name##_sort(Name *psVec)                              \
+{                                                                       \
+   assert(psVec != NULL);                                               \
+                                                                        \
+   Name##_quickSort(psVec->ptElements, psVec->uLength);                 \
+}
+
+#endif
@@ -0,0 +1 @@
+../0shared/pathscan.h
\ No newline at end of file
@@ -0,0 +1 @@
+../0shared/vec.h
\ No newline at end of file
@@ -22,6 +22,7 @@ boolean CheckerFT_Node_isValid(Node_T oNNode) {
    size_t i;
    int numberOfEquivalences;
    size_t childID = 0;
+   size_t ulFiles;
 
    oPNPath = Node_getPath(oNNode);
    ulDepth = Path_getDepth(oPNPath);
@@ -65,10 +66,12 @@ boolean CheckerFT_Node_isValid(Node_T oNNode) {
    }
 
 
-   /* If it is not the root, it must have a parent */
+   /* A node must be deeper than its parent; a parentless node is the
+      root, which may stand for a chain of directories above it */
    oNParent = Node_getParent(oNNode);
-   if (ulDepth > 1 && oNParent == NULL) {
-      fprintf(stderr, "There is a node that does not have a parent\n");
+   if (oNParent != NULL &&
+       ulDepth <= Path_getDepth(Node_getPath(oNParent))) {
+      fprintf(stderr, "There is a node that is not below its parent\n");
       return FALSE;
    }
 
@@ -89,13 +92,27 @@ boolean CheckerFT_Node_isValid(Node_T oNNode) {
       Node_hasChild(oNParent, Node_getPath(oNNode), &childID);
       i = 0;
       numberOfEquivalences = 0;
+      /* files directly below the parent come first, then the
+         directories, each group in order */
+      ulFiles = Node_getNumFiles(oNParent);
+      if ((childID < ulFiles) !=
+          (Node_isFile(oNNode) && Node_getEdgeDepth(oNNode) == 1)) {
+         fprintf(stderr, "A child is among the wrong kind of siblings\n");
+         return FALSE;
+      }
       while (i < Node_getNumChildren(oNParent)) {
          Node_getChild(oNParent, i, &oNSibling);
          if (oNSibling != NULL) {
             int siblingComparison;
-            siblingComparison = strcmp(Path_getPathname(Node_getPath(oNNode)), 
-                              Path_getPathname(Node_getPath(oNSibling)));
-            /* Two siblings should not have the same name */
+            boolean bSameKind = (childID < ulFiles) == (i < ulFiles);
+            size_t ulLevel = Path_getDepth(Node_getPath(oNParent));
+            /* siblings are ordered by their first component below
+               the parent */
+            siblingComparison = strcmp(
+                     Path_getComponent(Node_getPath(oNNode), ulLevel),
+                     Path_getComponent(Node_getPath(oNSibling), ulLevel));
+            /* Two siblings should not have the same name (or share
+               the first directory of a chain) */
             if (!siblingComparison) {
                numberOfEquivalences++;
                if (numberOfEquivalences > 1) {
@@ -104,14 +121,18 @@ boolean CheckerFT_Node_isValid(Node_T oNNode) {
                }
             }
 
-            /* Siblings before this node should be earlier lexicographically */
-            else if ( (childID > i) && (siblingComparison < 0) ) {
+            /* Siblings of the same kind before this node should be
+               earlier lexicographically */
+            else if ( bSameKind && (childID > i) &&
+                      (siblingComparison < 0) ) {
                fprintf(stderr, "Siblings are not in alphabetical order\n");
                fprintf(stderr, "%lu%lu", childID, i);
                return FALSE;
             }
-            /* Siblings after this node should be later lexicographically */
-            else if ( (childID < i) && (siblingComparison > 0) ) {
+            /* Siblings of the same kind after this node should be
+               later lexicographically */
+            else if ( bSameKind && (childID < i) &&
+                      (siblingComparison > 0) ) {
                
                fprintf(stderr, "Siblings are not in alphabetical order\n");
                return FALSE;
@@ -0,0 +1,1831 @@
+/*--------------------------------------------------------------------*/
+/* childarray.c                                                       */
+/* Author: Josh Schoenberg and Jack Toubes                            */
+/*--------------------------------------------------------------------*/
+
+#include "childarray.h"
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The number of leading key bytes stored inline in each element. */
+
+enum { PREFIX_BYTES = sizeof(unsigned long) };
+
+/* The growth factor of a new ChildArray object, as a percentage. */
+
+enum { DEFAULT_GROWTH_PERCENT = 200 };
+
+/* A ChildArray object shrinks once no more than 1/SHRINK_DIVISOR of
+   its physical length is in use. */
+
+enum { SHRINK_DIVISOR = 4 };
+
+/* The sizes below are those of the B+tree and index of a ChildArray
+   that the FT uses. The test client builds this module with
+   CHILDARRAY_SMALL_NODES defined, which shrinks them so that a few
+   dozen elements make a tree and a few hundred make a deep one. */
+
+/* A flat ChildArray is given a search index once it has at least
+   INDEX_MIN_LENGTH elements and has been searched INDEX_MIN_SEARCHES
+   times since it last changed, so that arrays that change between
+   most searches never pay for building one. A ChildArray with more
+   than TREE_MIN_LENGTH elements is a B+tree, which is searched
+   through its branches and never has an index, so only arrays of
+   INDEX_MIN_LENGTH to TREE_MIN_LENGTH elements are ever indexed. */
+
+#ifndef CHILDARRAY_SMALL_NODES
+enum { INDEX_MIN_LENGTH = 512 };
+enum { INDEX_MIN_SEARCHES = 32 };
+#else
+enum { INDEX_MIN_LENGTH = 16 };
+enum { INDEX_MIN_SEARCHES = 4 };
+#endif
+
+/* A search of the index fetches the prefixes PREFETCH_LEVELS levels
+   below its current position, which are 1 << PREFETCH_LEVELS
+   consecutive prefixes, ahead of time. */
+
+enum { PREFETCH_LEVELS = 3 };
+
+/* The size of a cache line, at whose boundaries the index starts so
+   that each prefetch brings in whole levels. */
+
+enum { CACHE_LINE_BYTES = 64 };
+
+/* A ChildArray becomes a B+tree once it would have more than
+   TREE_MIN_LENGTH elements, and an array again once it has no more
+   than FLAT_MAX_LENGTH; the gap keeps a ChildArray whose length hovers
+   around either from converting back and forth. */
+
+#ifndef CHILDARRAY_SMALL_NODES
+enum { TREE_MIN_LENGTH = 4096 };
+enum { FLAT_MAX_LENGTH = 1024 };
+#else
+enum { TREE_MIN_LENGTH = 40 };
+enum { FLAT_MAX_LENGTH = 10 };
+#endif
+
+/* The number of elements in a leaf, and of subtrees in a branch, of
+   a full node of the B+tree. */
+
+#ifndef CHILDARRAY_SMALL_NODES
+enum { LEAF_CAPACITY = 256 };
+enum { BRANCH_CAPACITY = 64 };
+#else
+enum { LEAF_CAPACITY = 4 };
+enum { BRANCH_CAPACITY = 4 };
+#endif
+
+/* A node of the B+tree that is less than 1/MIN_FILL_DIVISOR full is
+   merged with a neighbor when the two fit in one node. A tree built
+   from an array starts with its nodes LEAF_FILL and BRANCH_FILL full,
+   leaving room to grow without splitting at once. */
+
+enum { MIN_FILL_DIVISOR = 4 };
+enum { LEAF_FILL = LEAF_CAPACITY * 3 / 4 };
+enum { BRANCH_FILL = BRANCH_CAPACITY * 3 / 4 };
+
+/* The greatest height of the B+tree, far above what memory allows. */
+
+enum { MAX_TREE_HEIGHT = 16 };
+
+/* Searches prefetch with GCC's builtin; other compilers do not
+   prefetch. */
+#if defined(__GNUC__)
+#define CHILDARRAY_PREFETCH(pv) __builtin_prefetch(pv)
+#else
+#define CHILDARRAY_PREFETCH(pv) ((void)0)
+#endif
+
+/*--------------------------------------------------------------------*/
+
+#ifndef NDEBUG
+
+/* Check the invariants of oChildArray.  Return 1 (TRUE) iff
+   oChildArray is in a valid state. */
+
+static int ChildArray_isValid(ChildArray_T oChildArray)
+{
+   if (oChildArray->uPhysLength < CHILDARRAY_INLINE_LENGTH) return 0;
+   if (oChildArray->psTree == NULL &&
+       oChildArray->uLength > oChildArray->uPhysLength) return 0;
+   if (oChildArray->psEntries == NULL) return 0;
+   /* the inline buffer is in use exactly until the first spill */
+   if ((oChildArray->psEntries == oChildArray->asInline) !=
+       (oChildArray->uPhysLength == CHILDARRAY_INLINE_LENGTH)) return 0;
+   if (oChildArray->uGrowthPercent <= 100) return 0;
+   if (oChildArray->pulIndex != NULL &&
+       oChildArray->uLength < INDEX_MIN_LENGTH) return 0;
+   /* a tree holds all of the elements itself, and has no index */
+   if (oChildArray->psTree != NULL &&
+       (oChildArray->psEntries != oChildArray->asInline ||
+        oChildArray->pulIndex != NULL ||
+        oChildArray->uLength == 0)) return 0;
+   return 1;
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Return the packed prefix of pcKey, and assign the length of pcKey
+   to *puLength. */
+
+static unsigned long ChildArray_pack(const char *pcKey,
+                                     size_t *puLength)
+{
+   unsigned long ulPrefix = 0;
+   size_t uRead = 0;
+   size_t u;
+
+   assert(pcKey != NULL);
+   assert(puLength != NULL);
+
+   for (u = 0; u < PREFIX_BYTES; u++)
+   {
+      ulPrefix <<= CHAR_BIT;
+      if (pcKey[uRead] != '\0')
+      {
+         ulPrefix |= (unsigned char)pcKey[uRead];
+         uRead++;
+      }
+   }
+
+   *puLength = uRead + strlen(pcKey + uRead);
+   return ulPrefix;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Compare the key of *psEntry with pcKey, whose packed prefix is
+   ulPrefix and whose length is uKeyLength. Return <0, 0, or >0 if the
+   entry's key is less than, equal to, or greater than pcKey. */
+
+static int ChildArray_compare(const struct ChildEntry *psEntry,
+                              unsigned long ulPrefix,
+                              size_t uKeyLength, const char *pcKey)
+{
+   assert(psEntry != NULL);
+   assert(pcKey != NULL);
+
+   if (psEntry->ulPrefix != ulPrefix)
+      return (psEntry->ulPrefix < ulPrefix) ? -1 : 1;
+
+   /* Equal prefixes of keys that fit in them are equal keys, as are
+      keys at the same address (such as two uses of an interned
+      string). */
+   if ((psEntry->uKeyLength <= PREFIX_BYTES &&
+        uKeyLength <= PREFIX_BYTES) || psEntry->pcKey == pcKey)
+      return 0;
+
+   /* Otherwise both keys are at least PREFIX_BYTES long and share
+      their first PREFIX_BYTES bytes. */
+   return strcmp(psEntry->pcKey + PREFIX_BYTES, pcKey + PREFIX_BYTES);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free the search index of oChildArray, if it has one, and restart
+   the count of searches toward building one. Every change to the
+   elements or their order must call this. */
+
+static void ChildArray_dropIndex(ChildArray_T oChildArray)
+{
+   assert(oChildArray != NULL);
+
+   free(oChildArray->pulIndex);
+   oChildArray->pulIndex = NULL;
+   oChildArray->uSearches = 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Fill the subtree rooted at node uNode of the index pulPrefixes,
+   pulRanks of oChildArray with the elements of oChildArray in order,
+   starting at the uRank'th. Return the rank of the element after the
+   last one used. */
+
+static size_t ChildArray_fillIndex(ChildArray_T oChildArray,
+                                   unsigned long *pulPrefixes,
+                                   unsigned long *pulRanks,
+                                   size_t uNode, size_t uRank)
+{
+   assert(oChildArray != NULL);
+   assert(pulPrefixes != NULL);
+   assert(pulRanks != NULL);
+
+   if (uNode > oChildArray->uLength)
+      return uRank;
+
+   uRank = ChildArray_fillIndex(oChildArray, pulPrefixes, pulRanks,
+                                2 * uNode, uRank);
+   pulPrefixes[uNode] = oChildArray->psEntries[uRank].ulPrefix;
+   pulRanks[uNode] = (unsigned long)uRank;
+   return ChildArray_fillIndex(oChildArray, pulPrefixes, pulRanks,
+                               2 * uNode + 1, uRank + 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the packed prefixes of the index of oChildArray, which
+   start at the first cache line boundary in the index's memory and
+   are followed by the ranks. */
+
+static unsigned long *ChildArray_getIndex(ChildArray_T oChildArray)
+{
+   size_t uMisalignment;
+
+   assert(oChildArray != NULL);
+   assert(oChildArray->pulIndex != NULL);
+
+   uMisalignment = (size_t)oChildArray->pulIndex % CACHE_LINE_BYTES;
+   return oChildArray->pulIndex +
+      (CACHE_LINE_BYTES - uMisalignment) % CACHE_LINE_BYTES /
+      sizeof(unsigned long);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Build the search index of oChildArray. The index holds the packed
+   prefixes of the elements in Eytzinger order: that of a binary
+   search tree stored breadth first, with the children of node k at
+   2k and 2k+1, so that each level of a search reads memory next to
+   the previous one and the next few levels can be prefetched. Next to
+   the prefixes it holds the rank of the element at each node. If
+   memory is not available, oChildArray stays without an index. */
+
+static void ChildArray_buildIndex(ChildArray_T oChildArray)
+{
+   size_t uLength;
+   unsigned long *pulPrefixes;
+
+   assert(oChildArray != NULL);
+   assert(oChildArray->pulIndex == NULL);
+
+   /* nodes are numbered from 1, so each half has a slot 0 unused */
+   uLength = oChildArray->uLength;
+   oChildArray->pulIndex = (unsigned long*)
+      malloc(sizeof(unsigned long) * 2 * (uLength + 1) +
+             CACHE_LINE_BYTES);
+   if (oChildArray->pulIndex == NULL)
+      return;
+
+   pulPrefixes = ChildArray_getIndex(oChildArray);
+   (void) ChildArray_fillIndex(oChildArray, pulPrefixes,
+                               pulPrefixes + uLength + 1, 1, 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the rank of the first element of oChildArray, which must
+   have an index, whose packed prefix is not less than ulPrefix, or
+   the length of oChildArray if there is none. */
+
+static size_t ChildArray_lowerBound(ChildArray_T oChildArray,
+                                    unsigned long ulPrefix)
+{
+   const unsigned long *pulPrefixes;
+   size_t uLength;
+   size_t uNode = 1;
+
+   assert(oChildArray != NULL);
+   assert(oChildArray->pulIndex != NULL);
+
+   pulPrefixes = ChildArray_getIndex(oChildArray);
+   uLength = oChildArray->uLength;
+
+   /* descend without branching on the comparison: go right past
+      smaller prefixes and left otherwise, until falling off */
+   while (uNode <= uLength)
+   {
+      CHILDARRAY_PREFETCH(pulPrefixes + (uNode << PREFETCH_LEVELS));
+      uNode = 2 * uNode + (size_t)(pulPrefixes[uNode] < ulPrefix);
+   }
+
+   /* the answer is where the search last went left: undo the right
+      turns after it, then that turn */
+   while ((uNode & 1) != 0)
+      uNode >>= 1;
+   uNode >>= 1;
+
+   if (uNode == 0)
+      return uLength;
+   return (size_t)pulPrefixes[uLength + 1 + uNode];
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Narrow [*puLo, *puHi), the range of oChildArray in which an element
+   with packed prefix ulPrefix would be, using oChildArray's index to
+   find the elements with that prefix. */
+
+static void ChildArray_narrow(ChildArray_T oChildArray,
+                              unsigned long ulPrefix,
+                              size_t *puLo, size_t *puHi)
+{
+   const struct ChildEntry *psEntries;
+   size_t uLength;
+   size_t uLo;
+
+   assert(oChildArray != NULL);
+   assert(puLo != NULL);
+   assert(puHi != NULL);
+
+   psEntries = oChildArray->psEntries;
+   uLength = oChildArray->uLength;
+
+   uLo = ChildArray_lowerBound(oChildArray, ulPrefix);
+   *puLo = uLo;
+   if (uLo == uLength || psEntries[uLo].ulPrefix != ulPrefix)
+      *puHi = uLo;
+   else if (uLo + 1 == uLength ||
+            psEntries[uLo + 1].ulPrefix != ulPrefix)
+      *puHi = uLo + 1;
+   /* several keys share the prefix: find where they end */
+   else if (ulPrefix == ULONG_MAX)
+      *puHi = uLength;
+   else
+      *puHi = ChildArray_lowerBound(oChildArray, ulPrefix + 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Change the physical length of oChildArray to uNewLength, which must
+   be at least its length and CHILDARRAY_INLINE_LENGTH, moving its
+   elements between the inline buffer and the heap as needed.  Return
+   1 (TRUE) if successful and 0 (FALSE), leaving oChildArray
+   unchanged, if insufficient memory is available. */
+
+static int ChildArray_resize(ChildArray_T oChildArray,
+                             size_t uNewLength)
+{
+   struct ChildEntry *psNewEntries;
+
+   assert(oChildArray != NULL);
+   assert(uNewLength >= oChildArray->uLength);
+   assert(uNewLength >= CHILDARRAY_INLINE_LENGTH);
+
+   if (uNewLength == oChildArray->uPhysLength)
+      return 1;
+
+   if (uNewLength == CHILDARRAY_INLINE_LENGTH)
+   {
+      /* move back into the inline buffer */
+      psNewEntries = oChildArray->asInline;
+      memcpy(psNewEntries, oChildArray->psEntries,
+             sizeof(struct ChildEntry) * oChildArray->uLength);
+      free(oChildArray->psEntries);
+   }
+   else if (oChildArray->psEntries == oChildArray->asInline)
+   {
+      /* spill the inline buffer to the heap */
+      psNewEntries = (struct ChildEntry*)
+         malloc(sizeof(struct ChildEntry) * uNewLength);
+      if (psNewEntries == NULL)
+         return 0;
+      memcpy(psNewEntries, oChildArray->asInline,
+             sizeof(struct ChildEntry) * oChildArray->uLength);
+   }
+   else
+   {
+      psNewEntries = (struct ChildEntry*)
+         realloc(oChildArray->psEntries,
+                 sizeof(struct ChildEntry) * uNewLength);
+      if (psNewEntries == NULL)
+         return 0;
+   }
+
+   oChildArray->uPhysLength = uNewLength;
+   oChildArray->psEntries = psNewEntries;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Increase the physical length of oChildArray to at least
+   uMinLength, by its growth factor as many times as needed.  Return 1
+   (TRUE) if successful and 0 (FALSE) if insufficient memory is
+   available. */
+
+static int ChildArray_grow(ChildArray_T oChildArray, size_t uMinLength)
+{
+   size_t uNewLength;
+   size_t uNextLength;
+
+   assert(oChildArray != NULL);
+
+   uNewLength = oChildArray->uPhysLength;
+   while (uNewLength < uMinLength)
+   {
+      uNextLength = uNewLength / 100 * oChildArray->uGrowthPercent +
+         uNewLength % 100 * oChildArray->uGrowthPercent / 100;
+      /* always grow by at least one element */
+      if (uNextLength <= uNewLength)
+         uNextLength = uNewLength + 1;
+      uNewLength = uNextLength;
+   }
+
+   return ChildArray_resize(oChildArray, uNewLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Halve the physical length of oChildArray, as many times as needed
+   but not below the inline buffer, while no more than
+   1/SHRINK_DIVISOR of it is in use. The array is then at most half
+   full, so it does not grow and shrink repeatedly as elements are
+   added and removed. If memory cannot be reallocated, oChildArray
+   keeps its physical length. */
+
+static void ChildArray_shrink(ChildArray_T oChildArray)
+{
+   size_t uNewLength;
+
+   assert(oChildArray != NULL);
+
+   uNewLength = oChildArray->uPhysLength;
+   while (uNewLength / 2 >= CHILDARRAY_INLINE_LENGTH &&
+          oChildArray->uLength <= uNewLength / SHRINK_DIVISOR)
+      uNewLength /= 2;
+
+   (void) ChildArray_resize(oChildArray, uNewLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Binary search the elements of psEntries at indices uLo...uHi-1,
+   which are in ascending key order, for an element with key pcKey,
+   whose packed prefix is ulPrefix and whose length is uKeyLength. If
+   the element is found, then assign its index to *puIndex and return
+   1. If not, then assign the index where it would belong to *puIndex
+   and return 0. */
+
+static int ChildArray_searchEntries(const struct ChildEntry *psEntries,
+                                    size_t uLo, size_t uHi,
+                                    unsigned long ulPrefix,
+                                    size_t uKeyLength,
+                                    const char *pcKey, size_t *puIndex)
+{
+   size_t uMid;
+   int iCompare;
+
+   assert(psEntries != NULL || uLo == uHi);
+   assert(pcKey != NULL);
+   assert(puIndex != NULL);
+
+   /* The sought element, if present, is at an index in [uLo, uHi). */
+   while (uLo < uHi)
+   {
+      uMid = uLo + (uHi - uLo) / 2;
+      iCompare = ChildArray_compare(&psEntries[uMid], ulPrefix,
+                                    uKeyLength, pcKey);
+      if (iCompare > 0)
+         uHi = uMid;
+      else if (iCompare < 0)
+         uLo = uMid + 1;
+      else
+      {
+         *puIndex = uMid;
+         return 1;
+      }
+   }
+
+   *puIndex = uLo;
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A leaf of a ChildArray's B+tree: a run of consecutive elements. */
+
+struct ChildLeaf
+{
+   /* The number of elements in the leaf. */
+   size_t uLength;
+
+   /* The elements, in ascending key order. */
+   struct ChildEntry asEntries[LEAF_CAPACITY];
+};
+
+/* A branch of a ChildArray's B+tree: the roots of consecutive
+   subtrees, all of the same height. */
+
+struct ChildBranch
+{
+   /* The number of subtrees. */
+   size_t uLength;
+
+   /* The number of elements in each subtree. */
+   size_t auCounts[BRANCH_CAPACITY];
+
+   /* The first element of each subtree, whose key separates it from
+      the subtree before it. Keeping the first element itself, rather
+      than any key between the two, means that no key outlives the
+      element it came from. */
+   struct ChildEntry asKeys[BRANCH_CAPACITY];
+
+   /* The subtrees: leaves if the branch is at height 1, and branches
+      otherwise. */
+   void *apvChildren[BRANCH_CAPACITY];
+};
+
+/* The B+tree that holds the elements of a large ChildArray. It counts
+   the elements below each branch, so that elements can be found by
+   index as well as by key. */
+
+struct ChildTree
+{
+   /* The root: a leaf if uHeight is 0, and a branch otherwise. */
+   void *pvRoot;
+
+   /* The number of levels of branches above the leaves. */
+   size_t uHeight;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of elements or subtrees in pvNode, a node of a
+   ChildTree at height uHeight. */
+
+static size_t ChildArray_getNodeLength(const void *pvNode,
+                                       size_t uHeight)
+{
+   assert(pvNode != NULL);
+
+   if (uHeight == 0)
+      return ((const struct ChildLeaf*)pvNode)->uLength;
+   return ((const struct ChildBranch*)pvNode)->uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the address of the first element below pvNode, a non-empty
+   node of a ChildTree at height uHeight. */
+
+static const struct ChildEntry *ChildArray_getFirst(const void *pvNode,
+                                                    size_t uHeight)
+{
+   assert(pvNode != NULL);
+   assert(ChildArray_getNodeLength(pvNode, uHeight) > 0);
+
+   if (uHeight == 0)
+      return &((const struct ChildLeaf*)pvNode)->asEntries[0];
+   return &((const struct ChildBranch*)pvNode)->asKeys[0];
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the subtree of psBranch in which an element with
+   key pcKey, whose packed prefix is ulPrefix and whose length is
+   uKeyLength, is or would be: the last one whose first key is not
+   greater than pcKey, or the first one if there is none. */
+
+static size_t ChildArray_findSubtree(const struct ChildBranch *psBranch,
+                                     unsigned long ulPrefix,
+                                     size_t uKeyLength,
+                                     const char *pcKey)
+{
+   size_t uLo = 1;
+   size_t uHi;
+   size_t uMid;
+
+   assert(psBranch != NULL);
+   assert(pcKey != NULL);
+
+   /* The answer is uLo - 1 once no key in [uLo, uHi) is left to
+      compare. */
+   uHi = psBranch->uLength;
+   while (uLo < uHi)
+   {
+      uMid = uLo + (uHi - uLo) / 2;
+      if (ChildArray_compare(&psBranch->asKeys[uMid], ulPrefix,
+                             uKeyLength, pcKey) <= 0)
+         uLo = uMid + 1;
+      else
+         uHi = uMid;
+   }
+   return uLo - 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the subtree of psBranch that holds its
+   *puIndex'th element, and subtract the number of elements in the
+   subtrees before it from *puIndex. */
+
+static size_t ChildArray_findCount(const struct ChildBranch *psBranch,
+                                   size_t *puIndex)
+{
+   size_t uSlot = 0;
+
+   assert(psBranch != NULL);
+   assert(puIndex != NULL);
+
+   while (*puIndex >= psBranch->auCounts[uSlot])
+   {
+      *puIndex -= psBranch->auCounts[uSlot];
+      uSlot++;
+      assert(uSlot < psBranch->uLength);
+   }
+   return uSlot;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the address of the uIndex'th element of psTree. If apvPath
+   is not NULL, then also assign the nodes on the way to it, from the
+   leaf at height 0 up to the root, to apvPath, and the index taken in
+   each to auSlot. */
+
+static struct ChildEntry *ChildArray_treeGet(struct ChildTree *psTree,
+                                             size_t uIndex,
+                                             void **apvPath,
+                                             size_t *auSlot)
+{
+   void *pvNode;
+   size_t uHeight;
+   size_t uSlot;
+   struct ChildBranch *psBranch;
+
+   assert(psTree != NULL);
+
+   pvNode = psTree->pvRoot;
+   for (uHeight = psTree->uHeight; uHeight > 0; uHeight--)
+   {
+      psBranch = (struct ChildBranch*)pvNode;
+      uSlot = ChildArray_findCount(psBranch, &uIndex);
+      if (apvPath != NULL)
+      {
+         apvPath[uHeight] = psBranch;
+         auSlot[uHeight] = uSlot;
+      }
+      pvNode = psBranch->apvChildren[uSlot];
+   }
+
+   assert(uIndex < ((struct ChildLeaf*)pvNode)->uLength);
+   if (apvPath != NULL)
+   {
+      apvPath[0] = pvNode;
+      auSlot[0] = uIndex;
+   }
+   return &((struct ChildLeaf*)pvNode)->asEntries[uIndex];
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Search psTree for an element with key pcKey, whose packed prefix is
+   ulPrefix and whose length is uKeyLength, as ChildArray_bsearch
+   does. */
+
+static int ChildArray_treeSearch(const struct ChildTree *psTree,
+                                 unsigned long ulPrefix,
+                                 size_t uKeyLength, const char *pcKey,
+                                 size_t *puIndex)
+{
+   const void *pvNode;
+   size_t uHeight;
+   const struct ChildBranch *psBranch;
+   const struct ChildLeaf *psLeaf;
+   size_t uBefore = 0;
+   size_t uSlot;
+   size_t u;
+   int iFound;
+
+   assert(psTree != NULL);
+   assert(pcKey != NULL);
+   assert(puIndex != NULL);
+
+   pvNode = psTree->pvRoot;
+   for (uHeight = psTree->uHeight; uHeight > 0; uHeight--)
+   {
+      psBranch = (const struct ChildBranch*)pvNode;
+      uSlot = ChildArray_findSubtree(psBranch, ulPrefix, uKeyLength,
+                                     pcKey);
+      for (u = 0; u < uSlot; u++)
+         uBefore += psBranch->auCounts[u];
+      pvNode = psBranch->apvChildren[uSlot];
+   }
+
+   psLeaf = (const struct ChildLeaf*)pvNode;
+   iFound = ChildArray_searchEntries(psLeaf->asEntries, 0,
+                                     psLeaf->uLength, ulPrefix,
+                                     uKeyLength, pcKey, puIndex);
+   *puIndex += uBefore;
+   return iFound;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Insert the subtree whose root is pvChild, whose first element is
+   *psFirst, and which has uCount elements, into psBranch as its
+   uSlot'th subtree. psBranch must not be full. */
+
+static void ChildArray_branchInsert(struct ChildBranch *psBranch,
+                                    size_t uSlot, void *pvChild,
+                                    const struct ChildEntry *psFirst,
+                                    size_t uCount)
+{
+   size_t uMoved;
+
+   assert(psBranch != NULL);
+   assert(pvChild != NULL);
+   assert(psFirst != NULL);
+   assert(uSlot <= psBranch->uLength);
+   assert(psBranch->uLength < BRANCH_CAPACITY);
+
+   uMoved = psBranch->uLength - uSlot;
+   memmove(&psBranch->auCounts[uSlot + 1], &psBranch->auCounts[uSlot],
+           sizeof(size_t) * uMoved);
+   memmove(&psBranch->asKeys[uSlot + 1], &psBranch->asKeys[uSlot],
+           sizeof(struct ChildEntry) * uMoved);
+   memmove(&psBranch->apvChildren[uSlot + 1],
+           &psBranch->apvChildren[uSlot], sizeof(void*) * uMoved);
+   psBranch->auCounts[uSlot] = uCount;
+   psBranch->asKeys[uSlot] = *psFirst;
+   psBranch->apvChildren[uSlot] = pvChild;
+   psBranch->uLength++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the uSlot'th subtree from psBranch, without freeing it. */
+
+static void ChildArray_branchRemove(struct ChildBranch *psBranch,
+                                    size_t uSlot)
+{
+   size_t uMoved;
+
+   assert(psBranch != NULL);
+   assert(uSlot < psBranch->uLength);
+
+   psBranch->uLength--;
+   uMoved = psBranch->uLength - uSlot;
+   memmove(&psBranch->auCounts[uSlot], &psBranch->auCounts[uSlot + 1],
+           sizeof(size_t) * uMoved);
+   memmove(&psBranch->asKeys[uSlot], &psBranch->asKeys[uSlot + 1],
+           sizeof(struct ChildEntry) * uMoved);
+   memmove(&psBranch->apvChildren[uSlot],
+           &psBranch->apvChildren[uSlot + 1], sizeof(void*) * uMoved);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of elements below psBranch. */
+
+static size_t ChildArray_branchCount(const struct ChildBranch *psBranch)
+{
+   size_t uCount = 0;
+   size_t u;
+
+   assert(psBranch != NULL);
+
+   for (u = 0; u < psBranch->uLength; u++)
+      uCount += psBranch->auCounts[u];
+   return uCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Insert *psEntry into psTree, which must not have an element with the
+   same key. Return 1 (TRUE) if successful, or 0 (FALSE), leaving
+   psTree unchanged, if insufficient memory is available. */
+
+static int ChildArray_treeInsert(struct ChildTree *psTree,
+                                 const struct ChildEntry *psEntry)
+{
+   /* the nodes on the way from the leaf (at height 0) to the root,
+      and the index taken in each */
+   void *apvPath[MAX_TREE_HEIGHT + 1];
+   size_t auSlot[MAX_TREE_HEIGHT + 1];
+   /* the new node that each split will need, by height */
+   void *apvSpare[MAX_TREE_HEIGHT + 1];
+   size_t uSplits;
+   size_t uHeight;
+   size_t u;
+   struct ChildLeaf *psLeaf;
+   struct ChildLeaf *psRightLeaf = NULL;
+   struct ChildBranch *psBranch;
+   struct ChildBranch *psRight;
+   void *pvNewChild;
+   size_t uLeftCount = 0;
+   size_t uRightCount = 0;
+   size_t uSlot;
+   int iFound;
+
+   assert(psTree != NULL);
+   assert(psEntry != NULL);
+
+   /* find the way to the leaf where *psEntry belongs */
+   apvPath[psTree->uHeight] = psTree->pvRoot;
+   for (uHeight = psTree->uHeight; uHeight > 0; uHeight--)
+   {
+      psBranch = (struct ChildBranch*)apvPath[uHeight];
+      auSlot[uHeight] = ChildArray_findSubtree(psBranch,
+                                               psEntry->ulPrefix,
+                                               psEntry->uKeyLength,
+                                               psEntry->pcKey);
+      apvPath[uHeight - 1] = psBranch->apvChildren[auSlot[uHeight]];
+   }
+   psLeaf = (struct ChildLeaf*)apvPath[0];
+   iFound = ChildArray_searchEntries(psLeaf->asEntries, 0,
+                                     psLeaf->uLength,
+                                     psEntry->ulPrefix,
+                                     psEntry->uKeyLength,
+                                     psEntry->pcKey, &auSlot[0]);
+   assert(!iFound);
+   (void) iFound;
+
+   /* a full leaf splits, as does each full branch above it that gains
+      a subtree from the split below; a full root gains a new root
+      above it too. Allocate all the new nodes first. */
+   uSplits = 0;
+   while (uSplits <= psTree->uHeight &&
+          ChildArray_getNodeLength(apvPath[uSplits], uSplits) ==
+          ((uSplits == 0) ? LEAF_CAPACITY : BRANCH_CAPACITY))
+      uSplits++;
+   if (uSplits > psTree->uHeight && uSplits > MAX_TREE_HEIGHT)
+      return 0;
+   for (u = 0; u < uSplits + (uSplits > psTree->uHeight); u++)
+   {
+      apvSpare[u] = malloc((u == 0) ? sizeof(struct ChildLeaf) :
+                           sizeof(struct ChildBranch));
+      if (apvSpare[u] == NULL)
+      {
+         while (u > 0)
+            free(apvSpare[--u]);
+         return 0;
+      }
+   }
+
+   /* insert into the leaf, first moving its upper half to a new leaf
+      if it is full */
+   pvNewChild = NULL;
+   uSlot = auSlot[0];
+   if (uSplits > 0)
+   {
+      psRightLeaf = (struct ChildLeaf*)apvSpare[0];
+      psRightLeaf->uLength = LEAF_CAPACITY - LEAF_CAPACITY / 2;
+      memcpy(psRightLeaf->asEntries,
+             &psLeaf->asEntries[LEAF_CAPACITY / 2],
+             sizeof(struct ChildEntry) * psRightLeaf->uLength);
+      psLeaf->uLength = LEAF_CAPACITY / 2;
+      if (uSlot > psLeaf->uLength)
+      {
+         uSlot -= psLeaf->uLength;
+         psLeaf = psRightLeaf;
+      }
+   }
+   memmove(&psLeaf->asEntries[uSlot + 1], &psLeaf->asEntries[uSlot],
+           sizeof(struct ChildEntry) * (psLeaf->uLength - uSlot));
+   psLeaf->asEntries[uSlot] = *psEntry;
+   psLeaf->uLength++;
+   if (uSplits > 0)
+   {
+      pvNewChild = psRightLeaf;
+      uLeftCount = ((struct ChildLeaf*)apvPath[0])->uLength;
+      uRightCount = psRightLeaf->uLength;
+   }
+
+   /* update the branches on the way up, adding each new node just
+      after the one it split from */
+   for (uHeight = 1; uHeight <= psTree->uHeight; uHeight++)
+   {
+      psBranch = (struct ChildBranch*)apvPath[uHeight];
+      uSlot = auSlot[uHeight];
+      psBranch->asKeys[uSlot] =
+         *ChildArray_getFirst(apvPath[uHeight - 1], uHeight - 1);
+      if (pvNewChild == NULL)
+      {
+         psBranch->auCounts[uSlot]++;
+         continue;
+      }
+
+      if (uHeight >= uSplits)
+      {
+         psBranch->auCounts[uSlot] = uLeftCount;
+         ChildArray_branchInsert(psBranch, uSlot + 1, pvNewChild,
+            ChildArray_getFirst(pvNewChild, uHeight - 1),
+            uRightCount);
+         pvNewChild = NULL;
+         continue;
+      }
+
+      /* split the branch too, then add to whichever half has the
+         subtree that split */
+      psRight = (struct ChildBranch*)apvSpare[uHeight];
+      psRight->uLength = BRANCH_CAPACITY - BRANCH_CAPACITY / 2;
+      memcpy(psRight->auCounts,
+             &psBranch->auCounts[BRANCH_CAPACITY / 2],
+             sizeof(size_t) * psRight->uLength);
+      memcpy(psRight->asKeys, &psBranch->asKeys[BRANCH_CAPACITY / 2],
+             sizeof(struct ChildEntry) * psRight->uLength);
+      memcpy(psRight->apvChildren,
+             &psBranch->apvChildren[BRANCH_CAPACITY / 2],
+             sizeof(void*) * psRight->uLength);
+      psBranch->uLength = BRANCH_CAPACITY / 2;
+      if (uSlot >= psBranch->uLength)
+      {
+         uSlot -= psBranch->uLength;
+         psBranch = psRight;
+      }
+      psBranch->auCounts[uSlot] = uLeftCount;
+      ChildArray_branchInsert(psBranch, uSlot + 1, pvNewChild,
+                              ChildArray_getFirst(pvNewChild,
+                                                  uHeight - 1),
+                              uRightCount);
+      pvNewChild = psRight;
+      uLeftCount = ChildArray_branchCount(
+         (struct ChildBranch*)apvPath[uHeight]);
+      uRightCount = ChildArray_branchCount(psRight);
+   }
+
+   /* a split root gets a new root above it */
+   if (pvNewChild != NULL)
+   {
+      psBranch = (struct ChildBranch*)apvSpare[uSplits];
+      psBranch->uLength = 0;
+      ChildArray_branchInsert(psBranch, 0, psTree->pvRoot,
+         ChildArray_getFirst(psTree->pvRoot, psTree->uHeight),
+         uLeftCount);
+      ChildArray_branchInsert(psBranch, 1, pvNewChild,
+         ChildArray_getFirst(pvNewChild, psTree->uHeight),
+         uRightCount);
+      psTree->pvRoot = psBranch;
+      psTree->uHeight++;
+   }
+
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Merge the (uSlot+1)'th subtree of psBranch into the uSlot'th, and
+   free the former. The subtrees are at height uHeight, and must fit
+   in one node together. */
+
+static void ChildArray_mergeSubtrees(struct ChildBranch *psBranch,
+                                     size_t uSlot, size_t uHeight)
+{
+   struct ChildLeaf *psLeftLeaf;
+   struct ChildLeaf *psRightLeaf;
+   struct ChildBranch *psLeft;
+   struct ChildBranch *psRight;
+
+   assert(psBranch != NULL);
+   assert(uSlot + 1 < psBranch->uLength);
+
+   if (uHeight == 0)
+   {
+      psLeftLeaf = (struct ChildLeaf*)psBranch->apvChildren[uSlot];
+      psRightLeaf =
+         (struct ChildLeaf*)psBranch->apvChildren[uSlot + 1];
+      assert(psLeftLeaf->uLength + psRightLeaf->uLength <=
+             LEAF_CAPACITY);
+      memcpy(&psLeftLeaf->asEntries[psLeftLeaf->uLength],
+             psRightLeaf->asEntries,
+             sizeof(struct ChildEntry) * psRightLeaf->uLength);
+      psLeftLeaf->uLength += psRightLeaf->uLength;
+      free(psRightLeaf);
+   }
+   else
+   {
+      psLeft = (struct ChildBranch*)psBranch->apvChildren[uSlot];
+      psRight = (struct ChildBranch*)psBranch->apvChildren[uSlot + 1];
+      assert(psLeft->uLength + psRight->uLength <= BRANCH_CAPACITY);
+      memcpy(&psLeft->auCounts[psLeft->uLength], psRight->auCounts,
+             sizeof(size_t) * psRight->uLength);
+      memcpy(&psLeft->asKeys[psLeft->uLength], psRight->asKeys,
+             sizeof(struct ChildEntry) * psRight->uLength);
+      memcpy(&psLeft->apvChildren[psLeft->uLength],
+             psRight->apvChildren, sizeof(void*) * psRight->uLength);
+      psLeft->uLength += psRight->uLength;
+      free(psRight);
+   }
+
+   psBranch->auCounts[uSlot] += psBranch->auCounts[uSlot + 1];
+   ChildArray_branchRemove(psBranch, uSlot + 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the uIndex'th element of psTree, which must have more than
+   one element, and return its value. A node left less than a quarter
+   full is merged with a neighbor if the two fit in one node. */
+
+static void *ChildArray_treeRemove(struct ChildTree *psTree,
+                                   size_t uIndex)
+{
+   void *apvPath[MAX_TREE_HEIGHT + 1];
+   size_t auSlot[MAX_TREE_HEIGHT + 1];
+   size_t uHeight;
+   struct ChildBranch *psBranch;
+   struct ChildLeaf *psLeaf;
+   void *pvValue;
+   size_t uSlot;
+   size_t uLength;
+   size_t uCapacity;
+
+   assert(psTree != NULL);
+
+   (void) ChildArray_treeGet(psTree, uIndex, apvPath, auSlot);
+   psLeaf = (struct ChildLeaf*)apvPath[0];
+   uSlot = auSlot[0];
+   pvValue = (void*)psLeaf->asEntries[uSlot].pvValue;
+   psLeaf->uLength--;
+   memmove(&psLeaf->asEntries[uSlot], &psLeaf->asEntries[uSlot + 1],
+           sizeof(struct ChildEntry) * (psLeaf->uLength - uSlot));
+
+   /* on the way up, drop empty nodes, merge sparse ones, and keep the
+      first keys current */
+   for (uHeight = 1; uHeight <= psTree->uHeight; uHeight++)
+   {
+      psBranch = (struct ChildBranch*)apvPath[uHeight];
+      uSlot = auSlot[uHeight];
+      psBranch->auCounts[uSlot]--;
+      uLength = ChildArray_getNodeLength(apvPath[uHeight - 1],
+                                         uHeight - 1);
+      uCapacity = (uHeight == 1) ? LEAF_CAPACITY : BRANCH_CAPACITY;
+
+      if (uLength == 0)
+      {
+         free(apvPath[uHeight - 1]);
+         ChildArray_branchRemove(psBranch, uSlot);
+         continue;
+      }
+
+      psBranch->asKeys[uSlot] =
+         *ChildArray_getFirst(apvPath[uHeight - 1], uHeight - 1);
+      if (uLength >= uCapacity / MIN_FILL_DIVISOR)
+         continue;
+      if (uSlot + 1 < psBranch->uLength &&
+          uLength + ChildArray_getNodeLength(
+             psBranch->apvChildren[uSlot + 1], uHeight - 1) <=
+          uCapacity)
+         ChildArray_mergeSubtrees(psBranch, uSlot, uHeight - 1);
+      else if (uSlot > 0 &&
+               uLength + ChildArray_getNodeLength(
+                  psBranch->apvChildren[uSlot - 1], uHeight - 1) <=
+               uCapacity)
+         ChildArray_mergeSubtrees(psBranch, uSlot - 1, uHeight - 1);
+   }
+
+   /* a root with one subtree gives way to it */
+   while (psTree->uHeight > 0 &&
+          ((struct ChildBranch*)psTree->pvRoot)->uLength == 1)
+   {
+      psBranch = (struct ChildBranch*)psTree->pvRoot;
+      psTree->pvRoot = psBranch->apvChildren[0];
+      psTree->uHeight--;
+      free(psBranch);
+   }
+
+   return pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free the nodes apvNodes[uFrom...uTo-1] of a ChildTree, which are at
+   height uHeight, and all nodes below them. */
+
+static void ChildArray_freeNodes(void **apvNodes, size_t uFrom,
+                                 size_t uTo, size_t uHeight)
+{
+   struct ChildBranch *psBranch;
+
+   assert(apvNodes != NULL || uFrom == uTo);
+
+   for (; uFrom < uTo; uFrom++)
+   {
+      if (uHeight > 0)
+      {
+         psBranch = (struct ChildBranch*)apvNodes[uFrom];
+         ChildArray_freeNodes(psBranch->apvChildren, 0,
+                              psBranch->uLength, uHeight - 1);
+      }
+      free(apvNodes[uFrom]);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free psTree and all of its nodes. */
+
+static void ChildArray_freeTree(struct ChildTree *psTree)
+{
+   assert(psTree != NULL);
+
+   ChildArray_freeNodes(&psTree->pvRoot, 0, 1, psTree->uHeight);
+   free(psTree);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Copy the elements below pvNode, a node of a ChildTree at height
+   uHeight, in order to psEntries. Return the number copied. */
+
+static size_t ChildArray_flattenNode(const void *pvNode, size_t uHeight,
+                                     struct ChildEntry *psEntries)
+{
+   const struct ChildBranch *psBranch;
+   const struct ChildLeaf *psLeaf;
+   size_t uCount = 0;
+   size_t u;
+
+   assert(pvNode != NULL);
+   assert(psEntries != NULL);
+
+   if (uHeight == 0)
+   {
+      psLeaf = (const struct ChildLeaf*)pvNode;
+      memcpy(psEntries, psLeaf->asEntries,
+             sizeof(struct ChildEntry) * psLeaf->uLength);
+      return psLeaf->uLength;
+   }
+
+   psBranch = (const struct ChildBranch*)pvNode;
+   for (u = 0; u < psBranch->uLength; u++)
+      uCount += ChildArray_flattenNode(psBranch->apvChildren[u],
+                                       uHeight - 1, psEntries + uCount);
+   return uCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new ChildTree holding the uLength elements of psEntries,
+   which are in ascending key order, with each node three quarters
+   full, or NULL if insufficient memory is available. */
+
+static struct ChildTree *ChildArray_buildTree(
+   const struct ChildEntry *psEntries, size_t uLength)
+{
+   struct ChildTree *psTree;
+   /* the nodes of the level being built, and their counts */
+   void **apvNodes;
+   size_t *auCounts;
+   size_t uNodes;
+   size_t uParents;
+   size_t uHeight = 0;
+   size_t uNext = 0;
+   size_t uTaken;
+   size_t u;
+   int bOk = 1;
+   struct ChildLeaf *psLeaf;
+   struct ChildBranch *psBranch;
+
+   assert(psEntries != NULL);
+   assert(uLength > 0);
+
+   uNodes = (uLength + LEAF_FILL - 1) / LEAF_FILL;
+   psTree = (struct ChildTree*)malloc(sizeof(struct ChildTree));
+   apvNodes = (void**)malloc(sizeof(void*) * uNodes);
+   auCounts = (size_t*)malloc(sizeof(size_t) * uNodes);
+   if (psTree == NULL || apvNodes == NULL || auCounts == NULL)
+   {
+      free(psTree);
+      free(apvNodes);
+      free(auCounts);
+      return NULL;
+   }
+
+   /* spread the elements evenly over the leaves */
+   for (u = 0; bOk && u < uNodes; u++)
+   {
+      psLeaf = (struct ChildLeaf*)malloc(sizeof(struct ChildLeaf));
+      if (psLeaf == NULL)
+      {
+         ChildArray_freeNodes(apvNodes, 0, u, 0);
+         bOk = 0;
+         break;
+      }
+      psLeaf->uLength = uLength / uNodes + (u < uLength % uNodes);
+      memcpy(psLeaf->asEntries, &psEntries[uNext],
+             sizeof(struct ChildEntry) * psLeaf->uLength);
+      uNext += psLeaf->uLength;
+      apvNodes[u] = psLeaf;
+      auCounts[u] = psLeaf->uLength;
+   }
+
+   /* then the nodes of each level evenly over the branches above
+      them, until one is left; each new branch takes the place of the
+      first node it takes */
+   while (bOk && uNodes > 1)
+   {
+      uParents = (uNodes + BRANCH_FILL - 1) / BRANCH_FILL;
+      uNext = 0;
+      for (u = 0; u < uParents; u++)
+      {
+         psBranch = (struct ChildBranch*)
+            malloc(sizeof(struct ChildBranch));
+         if (psBranch == NULL)
+         {
+            /* free this level's branches and the nodes that they
+               have not taken */
+            ChildArray_freeNodes(apvNodes, 0, u, uHeight + 1);
+            ChildArray_freeNodes(apvNodes, uNext, uNodes, uHeight);
+            bOk = 0;
+            break;
+         }
+         uTaken = uNodes / uParents + (u < uNodes % uParents);
+         psBranch->uLength = 0;
+         for (; psBranch->uLength < uTaken; uNext++)
+            ChildArray_branchInsert(psBranch, psBranch->uLength,
+               apvNodes[uNext],
+               ChildArray_getFirst(apvNodes[uNext], uHeight),
+               auCounts[uNext]);
+         apvNodes[u] = psBranch;
+         auCounts[u] = ChildArray_branchCount(psBranch);
+      }
+      uNodes = uParents;
+      uHeight++;
+   }
+
+   if (bOk)
+   {
+      psTree->pvRoot = apvNodes[0];
+      psTree->uHeight = uHeight;
+   }
+   else
+   {
+      free(psTree);
+      psTree = NULL;
+   }
+   free(apvNodes);
+   free(auCounts);
+   return psTree;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the address of the uIndex'th element of oChildArray. */
+
+static struct ChildEntry *ChildArray_getEntry(ChildArray_T oChildArray,
+                                              size_t uIndex)
+{
+   assert(oChildArray != NULL);
+   assert(uIndex < oChildArray->uLength);
+
+   if (oChildArray->psTree != NULL)
+      return ChildArray_treeGet(oChildArray->psTree, uIndex, NULL,
+                                NULL);
+   return &oChildArray->psEntries[uIndex];
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move the elements of oChildArray, which is not a tree, into a new
+   B+tree. If insufficient memory is available, then leave them where
+   they are. */
+
+static void ChildArray_toTree(ChildArray_T oChildArray)
+{
+   struct ChildTree *psTree;
+
+   assert(oChildArray != NULL);
+   assert(oChildArray->psTree == NULL);
+   assert(oChildArray->uLength > 0);
+
+   psTree = ChildArray_buildTree(oChildArray->psEntries,
+                                 oChildArray->uLength);
+   if (psTree == NULL)
+      return;
+
+   ChildArray_dropIndex(oChildArray);
+   if (oChildArray->psEntries != oChildArray->asInline)
+      free(oChildArray->psEntries);
+   oChildArray->psEntries = oChildArray->asInline;
+   oChildArray->uPhysLength = CHILDARRAY_INLINE_LENGTH;
+   oChildArray->psTree = psTree;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move the elements of oChildArray, which is a tree, back into an
+   array just long enough for them, and free the tree. If insufficient
+   memory is available, then leave them where they are. */
+
+static void ChildArray_toFlat(ChildArray_T oChildArray)
+{
+   struct ChildEntry *psEntries;
+   size_t uPhysLength;
+
+   assert(oChildArray != NULL);
+   assert(oChildArray->psTree != NULL);
+
+   if (oChildArray->uLength <= CHILDARRAY_INLINE_LENGTH)
+   {
+      psEntries = oChildArray->asInline;
+      uPhysLength = CHILDARRAY_INLINE_LENGTH;
+   }
+   else
+   {
+      psEntries = (struct ChildEntry*)
+         malloc(sizeof(struct ChildEntry) * oChildArray->uLength);
+      if (psEntries == NULL)
+         return;
+      uPhysLength = oChildArray->uLength;
+   }
+
+   (void) ChildArray_flattenNode(oChildArray->psTree->pvRoot,
+                                 oChildArray->psTree->uHeight,
+                                 psEntries);
+   ChildArray_freeTree(oChildArray->psTree);
+   oChildArray->psTree = NULL;
+   oChildArray->psEntries = psEntries;
+   oChildArray->uPhysLength = uPhysLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Insert ppcKeys[0...uCount-1] and ppvValues[0...uCount-1] into
+   oChildArray, which is a tree, as ChildArray_insertRange does. */
+
+static int ChildArray_treeInsertRange(ChildArray_T oChildArray,
+                                      size_t uIndex,
+                                      const char *const *ppcKeys,
+                                      const void *const *ppvValues,
+                                      size_t uCount)
+{
+   struct ChildEntry sEntry;
+   size_t u;
+
+   assert(oChildArray != NULL);
+   assert(oChildArray->psTree != NULL);
+   assert(ppcKeys != NULL);
+   assert(ppvValues != NULL);
+
+   /* the tree places each element by its key, which the caller
+      guarantees puts it at its index */
+   for (u = 0; u < uCount; u++)
+   {
+      assert(ppcKeys[u] != NULL);
+      sEntry.ulPrefix = ChildArray_pack(ppcKeys[u], &sEntry.uKeyLength);
+      sEntry.pcKey = ppcKeys[u];
+      sEntry.pvValue = ppvValues[u];
+      if (! ChildArray_treeInsert(oChildArray->psTree, &sEntry))
+      {
+         /* take out the elements already inserted */
+         for (; u > 0; u--)
+         {
+            (void) ChildArray_treeRemove(oChildArray->psTree, uIndex);
+            oChildArray->uLength--;
+         }
+         return 0;
+      }
+      oChildArray->uLength++;
+      assert(ChildArray_getEntry(oChildArray, uIndex + u)->pcKey ==
+             ppcKeys[u]);
+   }
+
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the uCount elements of oChildArray, which is a tree, from
+   index uIndex on, then move the rest back into an array if they are
+   few enough. */
+
+static void ChildArray_treeRemoveRange(ChildArray_T oChildArray,
+                                       size_t uIndex, size_t uCount)
+{
+   assert(oChildArray != NULL);
+   assert(oChildArray->psTree != NULL);
+   assert(uCount <= oChildArray->uLength - uIndex);
+
+   if (uCount == oChildArray->uLength)
+   {
+      ChildArray_freeTree(oChildArray->psTree);
+      oChildArray->psTree = NULL;
+      oChildArray->uLength = 0;
+      return;
+   }
+
+   for (; uCount > 0; uCount--)
+   {
+      (void) ChildArray_treeRemove(oChildArray->psTree, uIndex);
+      oChildArray->uLength--;
+   }
+
+   if (oChildArray->uLength <= FLAT_MAX_LENGTH)
+      ChildArray_toFlat(oChildArray);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Append the elements of oOther to oChildArray, which is a tree, as
+   ChildArray_appendArray does. */
+
+static int ChildArray_treeAppend(ChildArray_T oChildArray,
+                                 ChildArray_T oOther)
+{
+   size_t uOldLength;
+   size_t u;
+
+   assert(oChildArray != NULL);
+   assert(oChildArray->psTree != NULL);
+   assert(oOther != NULL);
+
+   uOldLength = oChildArray->uLength;
+   for (u = 0; u < oOther->uLength; u++)
+   {
+      if (! ChildArray_treeInsert(oChildArray->psTree,
+                                  ChildArray_getEntry(oOther, u)))
+      {
+         /* take out the elements already appended */
+         while (oChildArray->uLength > uOldLength)
+         {
+            (void) ChildArray_treeRemove(oChildArray->psTree,
+                                         uOldLength);
+            oChildArray->uLength--;
+         }
+         return 0;
+      }
+      oChildArray->uLength++;
+   }
+
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void ChildArray_init(ChildArray_T oChildArray)
+{
+   assert(oChildArray != NULL);
+
+   oChildArray->uLength = 0;
+   oChildArray->uPhysLength = CHILDARRAY_INLINE_LENGTH;
+   oChildArray->psEntries = oChildArray->asInline;
+   oChildArray->uGrowthPercent = DEFAULT_GROWTH_PERCENT;
+   oChildArray->pulIndex = NULL;
+   oChildArray->uSearches = 0;
+   oChildArray->psTree = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void ChildArray_destroy(ChildArray_T oChildArray)
+{
+   assert(oChildArray != NULL);
+   assert(ChildArray_isValid(oChildArray));
+
+   ChildArray_dropIndex(oChildArray);
+   if (oChildArray->psTree != NULL)
+      ChildArray_freeTree(oChildArray->psTree);
+   if (oChildArray->psEntries != oChildArray->asInline)
+      free(oChildArray->psEntries);
+}
+
+/*--------------------------------------------------------------------*/
+
+ChildArray_T ChildArray_new(void)
+{
+   ChildArray_T oChildArray;
+
+   oChildArray = (struct ChildArray*)malloc(sizeof(struct ChildArray));
+   if (oChildArray == NULL)
+      return NULL;
+
+   ChildArray_init(oChildArray);
+   return oChildArray;
+}
+
+/*--------------------------------------------------------------------*/
+
+void ChildArray_free(ChildArray_T oChildArray)
+{
+   assert(oChildArray != NULL);
+
+   ChildArray_destroy(oChildArray);
+   free(oChildArray);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t ChildArray_getLength(ChildArray_T oChildArray)
+{
+   assert(oChildArray != NULL);
+   assert(ChildArray_isValid(oChildArray));
+
+   return oChildArray->uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *ChildArray_get(ChildArray_T oChildArray, size_t uIndex)
+{
+   assert(oChildArray != NULL);
+   assert(uIndex < oChildArray->uLength);
+   assert(ChildArray_isValid(oChildArray));
+
+   return (void*)ChildArray_getEntry(oChildArray, uIndex)->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *ChildArray_set(ChildArray_T oChildArray, size_t uIndex,
+                     const char *pcKey, const void *pvValue)
+{
+   struct ChildEntry *psEntry;
+   const void *pvOldValue;
+   void *apvPath[MAX_TREE_HEIGHT + 1];
+   size_t auSlot[MAX_TREE_HEIGHT + 1];
+   size_t uHeight;
+
+   assert(oChildArray != NULL);
+   assert(uIndex < oChildArray->uLength);
+   assert(pcKey != NULL);
+   assert(ChildArray_isValid(oChildArray));
+
+   if (oChildArray->psTree != NULL)
+      psEntry = ChildArray_treeGet(oChildArray->psTree, uIndex,
+                                   apvPath, auSlot);
+   else
+      psEntry = &oChildArray->psEntries[uIndex];
+   assert(strcmp(psEntry->pcKey, pcKey) == 0);
+
+   pvOldValue = psEntry->pvValue;
+   psEntry->pcKey = pcKey;
+   psEntry->pvValue = pvValue;
+
+   /* branches whose first element this is must not keep the old
+      key, which may not outlive its element */
+   if (oChildArray->psTree != NULL)
+      for (uHeight = 1; uHeight <= oChildArray->psTree->uHeight;
+           uHeight++)
+         ((struct ChildBranch*)apvPath[uHeight])->asKeys[
+            auSlot[uHeight]] =
+            *ChildArray_getFirst(apvPath[uHeight - 1], uHeight - 1);
+
+   return (void*)pvOldValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int ChildArray_addAt(ChildArray_T oChildArray, size_t uIndex,
+                     const char *pcKey, const void *pvValue)
+{
+   assert(oChildArray != NULL);
+   assert(uIndex <= oChildArray->uLength);
+   assert(pcKey != NULL);
+   assert(ChildArray_isValid(oChildArray));
+
+   return ChildArray_insertRange(oChildArray, uIndex, &pcKey,
+                                 &pvValue, 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *ChildArray_removeAt(ChildArray_T oChildArray, size_t uIndex)
+{
+   const void *pvOldValue;
+
+   assert(oChildArray != NULL);
+   assert(uIndex < oChildArray->uLength);
+   assert(ChildArray_isValid(oChildArray));
+
+   pvOldValue = ChildArray_getEntry(oChildArray, uIndex)->pvValue;
+   ChildArray_removeRange(oChildArray, uIndex, 1);
+
+   return (void*)pvOldValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int ChildArray_insertRange(ChildArray_T oChildArray, size_t uIndex,
+                           const char *const *ppcKeys,
+                           const void *const *ppvValues, size_t uCount)
+{
+   struct ChildEntry *psEntry;
+   size_t u;
+
+   assert(oChildArray != NULL);
+   assert(uIndex <= oChildArray->uLength);
+   assert(ppcKeys != NULL || uCount == 0);
+   assert(ppvValues != NULL || uCount == 0);
+   assert(ChildArray_isValid(oChildArray));
+
+   if (uCount == 0)
+      return 1;
+
+   if (oChildArray->psTree != NULL)
+      return ChildArray_treeInsertRange(oChildArray, uIndex, ppcKeys,
+                                        ppvValues, uCount);
+
+   if (uCount > oChildArray->uPhysLength - oChildArray->uLength)
+      if (! ChildArray_grow(oChildArray, oChildArray->uLength + uCount))
+         return 0;
+
+   ChildArray_dropIndex(oChildArray);
+   psEntry = &oChildArray->psEntries[uIndex];
+   memmove(psEntry + uCount, psEntry,
+           sizeof(struct ChildEntry) * (oChildArray->uLength - uIndex));
+
+   for (u = 0; u < uCount; u++)
+   {
+      assert(ppcKeys[u] != NULL);
+      psEntry[u].ulPrefix =
+         ChildArray_pack(ppcKeys[u], &psEntry[u].uKeyLength);
+      psEntry[u].pcKey = ppcKeys[u];
+      psEntry[u].pvValue = ppvValues[u];
+      assert(uIndex + u == 0 ||
+             strcmp((psEntry + u - 1)->pcKey, ppcKeys[u]) < 0);
+   }
+   oChildArray->uLength += uCount;
+
+   assert(uIndex + uCount == oChildArray->uLength ||
+          strcmp(ppcKeys[uCount - 1], psEntry[uCount].pcKey) < 0);
+
+   if (oChildArray->uLength > TREE_MIN_LENGTH)
+      ChildArray_toTree(oChildArray);
+
+   assert(ChildArray_isValid(oChildArray));
+
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void ChildArray_removeRange(ChildArray_T oChildArray, size_t uIndex,
+                            size_t uCount)
+{
+   struct ChildEntry *psEntry;
+
+   assert(oChildArray != NULL);
+   assert(uIndex <= oChildArray->uLength);
+   assert(uCount <= oChildArray->uLength - uIndex);
+   assert(ChildArray_isValid(oChildArray));
+
+   if (oChildArray->psTree != NULL)
+   {
+      ChildArray_treeRemoveRange(oChildArray, uIndex, uCount);
+      assert(ChildArray_isValid(oChildArray));
+      return;
+   }
+
+   ChildArray_dropIndex(oChildArray);
+   psEntry = &oChildArray->psEntries[uIndex];
+   memmove(psEntry, psEntry + uCount,
+           sizeof(struct ChildEntry) *
+           (oChildArray->uLength - uIndex - uCount));
+   oChildArray->uLength -= uCount;
+
+   if (oChildArray->uLength <=
+       oChildArray->uPhysLength / SHRINK_DIVISOR)
+      ChildArray_shrink(oChildArray);
+
+   assert(ChildArray_isValid(oChildArray));
+}
+
+/*--------------------------------------------------------------------*/
+
+void ChildArray_clear(ChildArray_T oChildArray)
+{
+   assert(oChildArray != NULL);
+   assert(ChildArray_isValid(oChildArray));
+
+   ChildArray_dropIndex(oChildArray);
+   if (oChildArray->psTree != NULL)
+   {
+      ChildArray_freeTree(oChildArray->psTree);
+      oChildArray->psTree = NULL;
+   }
+   oChildArray->uLength = 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+int ChildArray_appendArray(ChildArray_T oChildArray,
+                           ChildArray_T oOther)
+{
+   size_t uCount;
+
+   assert(oChildArray != NULL);
+   assert(oOther != NULL);
+   assert(oChildArray != oOther);
+   assert(ChildArray_isValid(oChildArray));
+   assert(ChildArray_isValid(oOther));
+
+   uCount = oOther->uLength;
+   if (uCount == 0)
+      return 1;
+
+   assert(oChildArray->uLength == 0 ||
+          strcmp(ChildArray_getEntry(oChildArray,
+                                     oChildArray->uLength - 1)->pcKey,
+                 ChildArray_getEntry(oOther, 0)->pcKey) < 0);
+
+   if (oChildArray->psTree != NULL)
+      return ChildArray_treeAppend(oChildArray, oOther);
+
+   if (uCount > oChildArray->uPhysLength - oChildArray->uLength)
+      if (! ChildArray_grow(oChildArray, oChildArray->uLength + uCount))
+         return 0;
+
+   ChildArray_dropIndex(oChildArray);
+   /* the entries are already packed, so they are copied whole */
+   if (oOther->psTree != NULL)
+      (void) ChildArray_flattenNode(oOther->psTree->pvRoot,
+                                    oOther->psTree->uHeight,
+                                    &oChildArray->psEntries[
+                                       oChildArray->uLength]);
+   else
+      memcpy(&oChildArray->psEntries[oChildArray->uLength],
+             oOther->psEntries, sizeof(struct ChildEntry) * uCount);
+   oChildArray->uLength += uCount;
+
+   if (oChildArray->uLength > TREE_MIN_LENGTH)
+      ChildArray_toTree(oChildArray);
+
+   assert(ChildArray_isValid(oChildArray));
+
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+int ChildArray_reserve(ChildArray_T oChildArray, size_t uLength)
+{
+   assert(oChildArray != NULL);
+   assert(ChildArray_isValid(oChildArray));
+
+   if (oChildArray->psTree != NULL || uLength > TREE_MIN_LENGTH ||
+       uLength <= oChildArray->uPhysLength)
+      return 1;
+
+   return ChildArray_resize(oChildArray, uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+void ChildArray_shrinkToFit(ChildArray_T oChildArray)
+{
+   assert(oChildArray != NULL);
+   assert(ChildArray_isValid(oChildArray));
+
+   if (oChildArray->psTree != NULL)
+      return;
+
+   if (oChildArray->uLength > CHILDARRAY_INLINE_LENGTH)
+      (void) ChildArray_resize(oChildArray, oChildArray->uLength);
+   else
+      (void) ChildArray_resize(oChildArray, CHILDARRAY_INLINE_LENGTH);
+
+   assert(ChildArray_isValid(oChildArray));
+}
+
+/*--------------------------------------------------------------------*/
+
+void ChildArray_setGrowthPercent(ChildArray_T oChildArray,
+                                 size_t uPercent)
+{
+   assert(oChildArray != NULL);
+   assert(uPercent > 100);
+   assert(ChildArray_isValid(oChildArray));
+
+   oChildArray->uGrowthPercent = uPercent;
+}
+
+/*--------------------------------------------------------------------*/
+
+int ChildArray_bsearch(ChildArray_T oChildArray, const char *pcKey,
+                       size_t *puIndex)
+{
+   unsigned long ulPrefix;
+   size_t uKeyLength;
+   size_t uLo, uHi;
+
+   assert(oChildArray != NULL);
+   assert(pcKey != NULL);
+   assert(puIndex != NULL);
+   assert(ChildArray_isValid(oChildArray));
+
+   ulPrefix = ChildArray_pack(pcKey, &uKeyLength);
+
+   if (oChildArray->psTree != NULL)
+      return ChildArray_treeSearch(oChildArray->psTree, ulPrefix,
+                                   uKeyLength, pcKey, puIndex);
+
+   /* The sought element, if present, is at an index in [uLo, uHi). */
+   uLo = 0;
+   uHi = oChildArray->uLength;
+
+   /* Flat arrays of at least INDEX_MIN_LENGTH elements that keep
+      being searched get an index, which narrows the range to the
+      elements with the sought prefix. */
+   if (oChildArray->uLength >= INDEX_MIN_LENGTH)
+   {
+      if (oChildArray->pulIndex == NULL &&
+          ++oChildArray->uSearches >= INDEX_MIN_SEARCHES)
+         ChildArray_buildIndex(oChildArray);
+      if (oChildArray->pulIndex != NULL)
+         ChildArray_narrow(oChildArray, ulPrefix, &uLo, &uHi);
+   }
+
+   return ChildArray_searchEntries(oChildArray->psEntries, uLo, uHi,
+                                   ulPrefix, uKeyLength, pcKey,
+                                   puIndex);
+}
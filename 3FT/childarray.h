@@ -0,0 +1,252 @@
+/*--------------------------------------------------------------------*/
+/* childarray.h                                                       */
+/* Author: Josh Schoenberg and Jack Toubes                            */
+/*--------------------------------------------------------------------*/
+
+#ifndef CHILDARRAY_INCLUDED
+#define CHILDARRAY_INCLUDED
+
+#include <stddef.h>
+
+/* A ChildArray_T object is an array of values, each labeled with a
+   string key, that is kept in ascending key order. Next to each value
+   it stores the first bytes of the key and the key's length, so most
+   comparisons made while searching it are resolved by one integer
+   comparison without following the key pointer. The array does not
+   own its keys: each key must stay valid and unchanged while it is in
+   the array. A ChildArray with thousands of elements keeps them in a
+   B+tree of fixed-size leaves rather than one block of memory, so
+   that adding or removing an element, by index or by key, takes time
+   logarithmic in its length rather than linear. */
+
+typedef struct ChildArray *ChildArray_T;
+
+/* The B+tree of a large ChildArray, private to the ChildArray
+   module. */
+
+struct ChildTree;
+
+/* The number of elements that a ChildArray holds without allocating
+   memory. */
+
+enum { CHILDARRAY_INLINE_LENGTH = 2 };
+
+/* An element of a ChildArray: a value, its key, and a copy of the
+   key's leading bytes packed so that comparing two packed prefixes
+   as integers orders them as strcmp would. */
+
+struct ChildEntry
+{
+   /* The first sizeof(unsigned long) bytes of pcKey, most significant
+      first, padded with zero bytes if the key is shorter. */
+   unsigned long ulPrefix;
+
+   /* The length of pcKey. */
+   size_t uKeyLength;
+
+   /* The key. */
+   const char *pcKey;
+
+   /* The value. */
+   const void *pvValue;
+};
+
+/* A ChildArray consists of an array of elements, along with its
+   logical and physical lengths. The structure is visible only so that
+   it can be embedded in another object (see ChildArray_init); its
+   fields are private to the ChildArray module. */
+
+struct ChildArray
+{
+   /* The number of elements in the ChildArray from the client's
+      point of view. */
+   size_t uLength;
+
+   /* The number of elements in the array that underlies the
+      ChildArray. */
+   size_t uPhysLength;
+
+   /* The array that underlies the ChildArray: asInline until the
+      ChildArray outgrows it, and memory on the heap afterwards.
+      While the ChildArray is a tree, the array is asInline and
+      unused. */
+   struct ChildEntry *psEntries;
+
+   /* The factor by which the physical length grows when the array
+      is full, as a percentage. */
+   size_t uGrowthPercent;
+
+   /* The search index of a flat ChildArray of a few hundred to a few
+      thousand elements that is searched more often than it changes,
+      or NULL. */
+   unsigned long *pulIndex;
+
+   /* The number of times the ChildArray has been searched since it
+      last changed, while it has no index. */
+   size_t uSearches;
+
+   /* The B+tree that holds the elements of a large ChildArray, or
+      NULL while they are in the array. */
+   struct ChildTree *psTree;
+
+   /* The elements of a small ChildArray. */
+   struct ChildEntry asInline[CHILDARRAY_INLINE_LENGTH];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Make *oChildArray, which may be embedded in another object, an
+   empty ChildArray. Up to CHILDARRAY_INLINE_LENGTH elements are then
+   stored within *oChildArray itself, without allocating memory;
+   because it refers to itself, *oChildArray must not be moved or
+   copied while in use. */
+
+void ChildArray_init(ChildArray_T oChildArray);
+
+/*--------------------------------------------------------------------*/
+
+/* Free any memory that oChildArray, initialized by ChildArray_init,
+   has allocated. oChildArray may not be used again until it is
+   initialized again. */
+
+void ChildArray_destroy(ChildArray_T oChildArray);
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new, empty ChildArray_T object, or NULL if insufficient
+   memory is available. */
+
+ChildArray_T ChildArray_new(void);
+
+/*--------------------------------------------------------------------*/
+
+/* Free oChildArray. */
+
+void ChildArray_free(ChildArray_T oChildArray);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the length of oChildArray. */
+
+size_t ChildArray_getLength(ChildArray_T oChildArray);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the value of the uIndex'th element of oChildArray. */
+
+void *ChildArray_get(ChildArray_T oChildArray, size_t uIndex);
+
+/*--------------------------------------------------------------------*/
+
+/* Assign pcKey and pvValue to the uIndex'th element of oChildArray.
+   pcKey must be equal to that element's old key. Return the old
+   value. */
+
+void *ChildArray_set(ChildArray_T oChildArray, size_t uIndex,
+                     const char *pcKey, const void *pvValue);
+
+/*--------------------------------------------------------------------*/
+
+/* Add pvValue with key pcKey to oChildArray such that it is the
+   uIndex'th element, which must keep oChildArray in ascending key
+   order. Return 1 (TRUE) if successful, or 0 (FALSE) if insufficient
+   memory is available. */
+
+int ChildArray_addAt(ChildArray_T oChildArray, size_t uIndex,
+                     const char *pcKey, const void *pvValue);
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the uIndex'th element of oChildArray and return its
+   value. */
+
+void *ChildArray_removeAt(ChildArray_T oChildArray, size_t uIndex);
+
+/*--------------------------------------------------------------------*/
+
+/* Add the uCount values of ppvValues, with the keys ppcKeys, to
+   oChildArray such that the first of them is the uIndex'th element,
+   moving the elements already at and after uIndex only once. The keys
+   must be in ascending order and must keep oChildArray in ascending
+   key order. Return 1 (TRUE) if successful, or 0 (FALSE) if
+   insufficient memory is available, in which case oChildArray is
+   unchanged. */
+
+int ChildArray_insertRange(ChildArray_T oChildArray, size_t uIndex,
+                           const char *const *ppcKeys,
+                           const void *const *ppvValues, size_t uCount);
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the uCount elements of oChildArray starting at the uIndex'th
+   one, moving the elements after them only once. The removed values
+   are not returned; fetch them first if they are needed. */
+
+void ChildArray_removeRange(ChildArray_T oChildArray, size_t uIndex,
+                            size_t uCount);
+
+/*--------------------------------------------------------------------*/
+
+/* Remove all elements of oChildArray, keeping its memory for
+   reuse. */
+
+void ChildArray_clear(ChildArray_T oChildArray);
+
+/*--------------------------------------------------------------------*/
+
+/* Add the elements of oOther, in order, to the end of oChildArray,
+   whose keys must all be less than those of oOther. oOther must not
+   be oChildArray. Return 1 (TRUE) if successful, or 0 (FALSE) if
+   insufficient memory is available, in which case oChildArray is
+   unchanged. */
+
+int ChildArray_appendArray(ChildArray_T oChildArray,
+                           ChildArray_T oOther);
+
+/*--------------------------------------------------------------------*/
+
+/* Make the physical length of oChildArray at least uLength, so that
+   it can hold that many elements without reallocating its memory.
+   Return 1 (TRUE) if successful, or 0 (FALSE) if insufficient memory
+   is available. Removing elements may give up the reserved memory.
+   Reserving room for enough elements to make oChildArray a tree has
+   no effect, as a tree allocates its leaves as it grows. */
+
+int ChildArray_reserve(ChildArray_T oChildArray, size_t uLength);
+
+/*--------------------------------------------------------------------*/
+
+/* Give up as much of oChildArray's unused memory as possible, moving
+   its elements back into the inline buffer if they fit. A tree is
+   left as it is. */
+
+void ChildArray_shrinkToFit(ChildArray_T oChildArray);
+
+/*--------------------------------------------------------------------*/
+
+/* Set the factor by which the physical length of oChildArray grows
+   when it is full to uPercent percent, which must be more than 100.
+   The factor of a new ChildArray is 200 percent. Whatever the factor,
+   a ChildArray halves its memory, down to the inline buffer, once no
+   more than a quarter of it is in use. */
+
+void ChildArray_setGrowthPercent(ChildArray_T oChildArray,
+                                 size_t uPercent);
+
+/*--------------------------------------------------------------------*/
+
+/* Binary search oChildArray for an element with key pcKey, comparing
+   keys as strcmp does. If the element is found, then assign its
+   index to *puIndex and return 1. If the element is not found, then
+   assign the index where it would belong to *puIndex and return 0.
+   After a flat oChildArray of a few hundred to a few thousand
+   elements has been searched repeatedly without changing, searching
+   it first builds an index of it that makes further searches faster,
+   until it next changes; hence, unlike the other functions that do
+   not change oChildArray, this one must not be called for the same
+   oChildArray from two threads at once. */
+
+int ChildArray_bsearch(ChildArray_T oChildArray, const char *pcKey,
+                       size_t *puIndex);
+
+#endif
@@ -0,0 +1,252 @@
+/*--------------------------------------------------------------------*/
+/* childarray_bench.c                                                 */
+/* Author: Josh Schoenberg and Jack Toubes                            */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "childarray.h"
+#include "dynarray.h"
+
+/* The number of characters in each random key, the most keys that
+   are made, and the number of searches timed for each length of
+   array. */
+enum { BENCH_KEY_LENGTH = 12, BENCH_MAX_KEYS = 10000000,
+       BENCH_SEARCHES = 2000000 };
+
+/* The state of bench_random. */
+static unsigned long ulState = 88172645463325252UL;
+
+/* Returns the next number of a xorshift sequence. */
+static unsigned long bench_random(void) {
+   ulState ^= ulState << 13;
+   ulState ^= ulState >> 7;
+   ulState ^= ulState << 17;
+   return ulState;
+}
+
+/* Compares the strings that pvKey1 and pvKey2 point to, for qsort. */
+static int bench_compareKeys(const void *pvKey1, const void *pvKey2) {
+   return strcmp(*(char *const *) pvKey1, *(char *const *) pvKey2);
+}
+
+/* Compares the strings pvElement1 and pvElement2, for
+   DynArray_bsearch. */
+static int bench_compareStrings(const void *pvElement1,
+                                const void *pvElement2) {
+   return strcmp((const char *) pvElement1, (const char *) pvElement2);
+}
+
+/* Returns the seconds of processor time since uStart. */
+static double bench_since(clock_t uStart) {
+   return (double) (clock() - uStart) / CLOCKS_PER_SEC;
+}
+
+/*
+  Fills ppcKeys with up to ulCount distinct random keys, stored in
+  pcPool, in ascending order. Returns the number of keys.
+*/
+static size_t bench_makeKeys(char **ppcKeys, char *pcPool,
+                             size_t ulCount) {
+   size_t ulDistinct;
+   size_t i, j;
+
+   for(i = 0; i < ulCount; i++) {
+      ppcKeys[i] = pcPool + i * (BENCH_KEY_LENGTH + 1);
+      for(j = 0; j < BENCH_KEY_LENGTH; j++)
+         ppcKeys[i][j] = (char) ('a' + bench_random() % 26);
+      ppcKeys[i][BENCH_KEY_LENGTH] = '\0';
+   }
+   qsort(ppcKeys, ulCount, sizeof(char *), bench_compareKeys);
+   ulDistinct = 0;
+   for(i = 0; i < ulCount; i++)
+      if(ulDistinct == 0 ||
+         strcmp(ppcKeys[i], ppcKeys[ulDistinct - 1]) != 0)
+         ppcKeys[ulDistinct++] = ppcKeys[i];
+   return ulDistinct;
+}
+
+/*
+  Times BENCH_SEARCHES searches of a ChildArray and of a DynArray for
+  random ones of the ulLength keys in ppcKeys, printing the results to
+  stdout. Returns FALSE (0) if memory runs out, or TRUE (1) otherwise.
+*/
+static int bench_search(char **ppcKeys, size_t ulLength) {
+   struct ChildArray sChildArray;
+   DynArray_T oDynArray;
+   size_t *pulQueries;
+   size_t ulIndex, i;
+   clock_t uStart;
+   long lFound;
+
+   ChildArray_init(&sChildArray);
+   oDynArray = DynArray_new(0);
+   pulQueries = malloc(sizeof(size_t) * BENCH_SEARCHES);
+   if(oDynArray == NULL || pulQueries == NULL ||
+      !ChildArray_insertRange(&sChildArray, 0,
+                              (const char *const *) ppcKeys,
+                              (const void *const *) ppcKeys,
+                              ulLength) ||
+      !DynArray_insertRange(oDynArray, 0, (void *const *) ppcKeys,
+                            ulLength))
+      return 0;
+   for(i = 0; i < BENCH_SEARCHES; i++)
+      pulQueries[i] = bench_random() % ulLength;
+
+   printf("%lu keys, %d searches\n", (unsigned long) ulLength,
+          BENCH_SEARCHES);
+
+   lFound = 0;
+   uStart = clock();
+   for(i = 0; i < BENCH_SEARCHES; i++)
+      lFound += ChildArray_bsearch(&sChildArray, ppcKeys[pulQueries[i]],
+                                   &ulIndex);
+   printf("ChildArray_bsearch: %.3f s (%ld found)\n",
+          bench_since(uStart), lFound);
+
+   lFound = 0;
+   uStart = clock();
+   for(i = 0; i < BENCH_SEARCHES; i++)
+      lFound += DynArray_bsearch(oDynArray, ppcKeys[pulQueries[i]],
+                                 &ulIndex, bench_compareStrings);
+   printf("DynArray_bsearch:   %.3f s (%ld found)\n",
+          bench_since(uStart), lFound);
+
+   free(pulQueries);
+   DynArray_free(oDynArray);
+   ChildArray_destroy(&sChildArray);
+   return 1;
+}
+
+/*
+  Times adding the ulLength keys in ppcKeys, in random order, to an
+  empty ChildArray, each at the index that ChildArray_bsearch finds
+  for it, and then removing them in a different order, printing the
+  nanoseconds per operation to stdout. If bDynArray, times the same
+  with a DynArray. Returns FALSE (0) if memory runs out, or TRUE (1)
+  otherwise.
+*/
+static int bench_insert(char **ppcKeys, size_t ulLength,
+                        int bDynArray) {
+   struct ChildArray sChildArray;
+   DynArray_T oDynArray;
+   char **ppcOrder;
+   char *pcSwap;
+   size_t ulIndex, i, j;
+   clock_t uStart;
+
+   ppcOrder = malloc(sizeof(char *) * ulLength);
+   if(ppcOrder == NULL)
+      return 0;
+   memcpy(ppcOrder, ppcKeys, sizeof(char *) * ulLength);
+   for(i = ulLength - 1; i > 0; i--) {
+      j = bench_random() % (i + 1);
+      pcSwap = ppcOrder[i];
+      ppcOrder[i] = ppcOrder[j];
+      ppcOrder[j] = pcSwap;
+   }
+
+   printf("%lu keys inserted and removed\n", (unsigned long) ulLength);
+
+   ChildArray_init(&sChildArray);
+   uStart = clock();
+   for(i = 0; i < ulLength; i++) {
+      (void) ChildArray_bsearch(&sChildArray, ppcOrder[i], &ulIndex);
+      if(!ChildArray_addAt(&sChildArray, ulIndex, ppcOrder[i],
+                           ppcOrder[i]))
+         return 0;
+   }
+   printf("ChildArray insert: %6.0f ns", bench_since(uStart) * 1e9 /
+          (double) ulLength);
+   uStart = clock();
+   for(i = ulLength; i > 0; i--) {
+      (void) ChildArray_bsearch(&sChildArray, ppcOrder[i / 2],
+                                &ulIndex);
+      (void) ChildArray_removeAt(&sChildArray, ulIndex);
+      ppcOrder[i / 2] = ppcOrder[i - 1];
+   }
+   printf("   remove: %6.0f ns\n", bench_since(uStart) * 1e9 /
+          (double) ulLength);
+   ChildArray_destroy(&sChildArray);
+
+   if(bDynArray) {
+      memcpy(ppcOrder, ppcKeys, sizeof(char *) * ulLength);
+      for(i = ulLength - 1; i > 0; i--) {
+         j = bench_random() % (i + 1);
+         pcSwap = ppcOrder[i];
+         ppcOrder[i] = ppcOrder[j];
+         ppcOrder[j] = pcSwap;
+      }
+      oDynArray = DynArray_new(0);
+      if(oDynArray == NULL)
+         return 0;
+      uStart = clock();
+      for(i = 0; i < ulLength; i++) {
+         (void) DynArray_bsearch(oDynArray, ppcOrder[i], &ulIndex,
+                                 bench_compareStrings);
+         if(!DynArray_addAt(oDynArray, ulIndex, ppcOrder[i]))
+            return 0;
+      }
+      printf("DynArray insert:   %6.0f ns", bench_since(uStart) * 1e9 /
+             (double) ulLength);
+      uStart = clock();
+      for(i = ulLength; i > 0; i--) {
+         (void) DynArray_bsearch(oDynArray, ppcOrder[i / 2], &ulIndex,
+                                 bench_compareStrings);
+         (void) DynArray_removeAt(oDynArray, ulIndex);
+         ppcOrder[i / 2] = ppcOrder[i - 1];
+      }
+      printf("   remove: %6.0f ns\n", bench_since(uStart) * 1e9 /
+             (double) ulLength);
+      DynArray_free(oDynArray);
+   }
+
+   free(ppcOrder);
+   return 1;
+}
+
+/* Times ChildArray_bsearch against DynArray_bsearch on arrays of 1K,
+   100K, and 10M random keys, the first a flat array that builds its
+   search index and the others B+trees; then times inserting and
+   removing 1K to 1M random keys one at a time, against a DynArray up
+   to 100K keys. Prints the results to stdout. Returns 0, or
+   EXIT_FAILURE if memory runs out. */
+int main(void) {
+   static const size_t aulSearchLengths[] = { 1000, 100000,
+                                              BENCH_MAX_KEYS };
+   static const size_t aulInsertLengths[] = { 1000, 10000, 100000,
+                                              1000000 };
+   char **ppcKeys;
+   char *pcPool;
+   size_t ulLength, l;
+
+   ppcKeys = malloc(sizeof(char *) * BENCH_MAX_KEYS);
+   pcPool = malloc((BENCH_KEY_LENGTH + 1) * (size_t) BENCH_MAX_KEYS);
+   if(ppcKeys == NULL || pcPool == NULL) {
+      fprintf(stderr, "out of memory\n");
+      return EXIT_FAILURE;
+   }
+
+   for(l = 0; l < sizeof(aulSearchLengths) / sizeof(size_t); l++) {
+      ulLength = bench_makeKeys(ppcKeys, pcPool, aulSearchLengths[l]);
+      if(!bench_search(ppcKeys, ulLength)) {
+         fprintf(stderr, "out of memory\n");
+         return EXIT_FAILURE;
+      }
+   }
+   for(l = 0; l < sizeof(aulInsertLengths) / sizeof(size_t); l++) {
+      ulLength = bench_makeKeys(ppcKeys, pcPool, aulInsertLengths[l]);
+      if(!bench_insert(ppcKeys, ulLength, ulLength <= 100000)) {
+         fprintf(stderr, "out of memory\n");
+         return EXIT_FAILURE;
+      }
+   }
+
+   free(pcPool);
+   free(ppcKeys);
+   return 0;
+}
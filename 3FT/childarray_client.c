@@ -0,0 +1,346 @@
+/*--------------------------------------------------------------------*/
+/* childarray_client.c                                                */
+/* Author: Josh Schoenberg and Jack Toubes                            */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "childarray.h"
+
+/*
+  This client is linked with a build of childarray.c that has
+  CHILDARRAY_SMALL_NODES defined, so that its B+trees have nodes of a
+  few elements and grow deep, and that calls ChildArray_testMalloc and
+  ChildArray_testRealloc in place of malloc and realloc, so that
+  allocations can be made to fail (see Makefile).
+*/
+
+/* The most keys that the reference array holds, and the most keys
+   that one range operation adds. */
+enum { MAX_KEYS = 20000, MAX_RANGE = 60 };
+
+/* A reference array of keys in ascending order that each ChildArray
+   is compared against. Each element's value is its key. */
+static char *apcReference[MAX_KEYS];
+static size_t uReferenceLength;
+
+/* The number of keys that have been appended with appendArray, which
+   makes each appended key greater than any before it. */
+static unsigned long ulAppended;
+
+/* The state of the pseudo-random number generator. */
+static unsigned long ulSeed = 1;
+
+/* The chance, in thousandths, that an allocation fails, and the state
+   of the generator that decides which ones do. */
+static size_t uFailPermille;
+static unsigned long ulFailSeed = 1;
+
+/* Returns a pseudo-random number in [0, uBound). */
+static size_t random_below(size_t uBound) {
+   ulSeed = ulSeed * 1103515245UL + 12345UL;
+   return (size_t) ((ulSeed >> 16) & 0x7fffUL) % uBound;
+}
+
+/* Returns TRUE (1) if the next allocation should fail. */
+static int should_fail(void) {
+   ulFailSeed = ulFailSeed * 1103515245UL + 12345UL;
+   return (size_t) ((ulFailSeed >> 16) & 0x7fffUL) % 1000 <
+          uFailPermille;
+}
+
+void *ChildArray_testMalloc(size_t uSize);
+void *ChildArray_testRealloc(void *pvBlock, size_t uSize);
+
+/* Returns malloc(uSize), or NULL if the allocation should fail. */
+void *ChildArray_testMalloc(size_t uSize) {
+   if(should_fail())
+      return NULL;
+   return malloc(uSize);
+}
+
+/* Returns realloc(pvBlock, uSize), or NULL, leaving pvBlock as it is,
+   if the allocation should fail. */
+void *ChildArray_testRealloc(void *pvBlock, size_t uSize) {
+   if(should_fail())
+      return NULL;
+   return realloc(pvBlock, uSize);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Returns a new random key, in memory that the caller owns. Many keys
+   share their first eight bytes, which ChildArray keeps packed, and
+   some are shorter than that. */
+static char *new_key(void) {
+   char acKey[64];
+   char *pcKey;
+
+   switch(random_below(4)) {
+      case 0:
+         sprintf(acKey, "%lu", (unsigned long) random_below(30000));
+         break;
+      case 1:
+         sprintf(acKey, "commonprefix%lu",
+                 (unsigned long) random_below(30000));
+         break;
+      case 2:
+         sprintf(acKey, "ab%lu", (unsigned long) random_below(50));
+         break;
+      default:
+         sprintf(acKey, "x%lux%lu", (unsigned long) random_below(1000),
+                 (unsigned long) random_below(1000));
+         break;
+   }
+   pcKey = malloc(strlen(acKey) + 1);
+   assert(pcKey != NULL);
+   strcpy(pcKey, acKey);
+   return pcKey;
+}
+
+/* Binary searches the reference array for pcKey. Assigns its index,
+   or the index where it would belong, to *puIndex, and returns TRUE
+   (1) if it is there. */
+static int reference_find(const char *pcKey, size_t *puIndex) {
+   size_t uLo = 0;
+   size_t uHi = uReferenceLength;
+   size_t uMid;
+   int iCompare;
+
+   while(uLo < uHi) {
+      uMid = uLo + (uHi - uLo) / 2;
+      iCompare = strcmp(apcReference[uMid], pcKey);
+      if(iCompare < 0)
+         uLo = uMid + 1;
+      else if(iCompare > 0)
+         uHi = uMid;
+      else {
+         *puIndex = uMid;
+         return 1;
+      }
+   }
+   *puIndex = uLo;
+   return 0;
+}
+
+/* Inserts the uCount keys of ppcKeys at uIndex in the reference
+   array. */
+static void reference_insert(size_t uIndex, char *const *ppcKeys,
+                             size_t uCount) {
+   memmove(&apcReference[uIndex + uCount], &apcReference[uIndex],
+           sizeof(char *) * (uReferenceLength - uIndex));
+   memcpy(&apcReference[uIndex], ppcKeys, sizeof(char *) * uCount);
+   uReferenceLength += uCount;
+}
+
+/* Frees and removes uCount keys at uIndex from the reference
+   array. */
+static void reference_remove(size_t uIndex, size_t uCount) {
+   size_t u;
+
+   for(u = uIndex; u < uIndex + uCount; u++)
+      free(apcReference[u]);
+   memmove(&apcReference[uIndex], &apcReference[uIndex + uCount],
+           sizeof(char *) * (uReferenceLength - uIndex - uCount));
+   uReferenceLength -= uCount;
+}
+
+/* Asserts that oChildArray holds exactly the reference array, and
+   that searching it for each key finds that key's index. */
+static void check_reference(ChildArray_T oChildArray) {
+   size_t u, uIndex;
+
+   assert(ChildArray_getLength(oChildArray) == uReferenceLength);
+   for(u = 0; u < uReferenceLength; u++) {
+      assert(ChildArray_get(oChildArray, u) == apcReference[u]);
+      assert(ChildArray_bsearch(oChildArray, apcReference[u], &uIndex));
+      assert(uIndex == u);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Adds a random key that is not yet there to oChildArray with
+   ChildArray_addAt. */
+static void test_addAt(ChildArray_T oChildArray) {
+   char *pcKey = new_key();
+   size_t uIndex;
+
+   if(reference_find(pcKey, &uIndex) ||
+      !ChildArray_addAt(oChildArray, uIndex, pcKey, pcKey)) {
+      free(pcKey);
+      check_reference(oChildArray);
+      return;
+   }
+   reference_insert(uIndex, &pcKey, 1);
+}
+
+/* Adds up to MAX_RANGE consecutive keys that are not yet there to
+   oChildArray with ChildArray_insertRange. */
+static void test_insertRange(ChildArray_T oChildArray) {
+   char *apcKeys[MAX_RANGE];
+   char *pcKey = new_key();
+   size_t uCount = 1 + random_below(MAX_RANGE);
+   size_t uIndex, u;
+
+   if(reference_find(pcKey, &uIndex) ||
+      uReferenceLength + uCount > MAX_KEYS) {
+      free(pcKey);
+      return;
+   }
+   /* keys that follow pcKey and, unless pcKey is a prefix of the key
+      after it, come before that key */
+   for(u = 0; u < uCount; u++) {
+      apcKeys[u] = malloc(strlen(pcKey) + 7);
+      assert(apcKeys[u] != NULL);
+      sprintf(apcKeys[u], "%s\001%05lu", pcKey, (unsigned long) u);
+   }
+   free(pcKey);
+   if((uIndex < uReferenceLength &&
+       strcmp(apcKeys[uCount - 1], apcReference[uIndex]) >= 0) ||
+      !ChildArray_insertRange(oChildArray, uIndex,
+                              (const char *const *) apcKeys,
+                              (const void *const *) apcKeys,
+                              uCount)) {
+      for(u = 0; u < uCount; u++)
+         free(apcKeys[u]);
+      check_reference(oChildArray);
+      return;
+   }
+   reference_insert(uIndex, apcKeys, uCount);
+}
+
+/* Appends a ChildArray of up to 2 * MAX_RANGE keys, greater than any
+   before them, to oChildArray with ChildArray_appendArray. */
+static void test_appendArray(ChildArray_T oChildArray) {
+   struct ChildArray sOther;
+   char *pcKey;
+   size_t uCount = random_below(2 * MAX_RANGE);
+   size_t u;
+
+   if(uReferenceLength + uCount > MAX_KEYS)
+      return;
+   ChildArray_init(&sOther);
+   for(u = 0; u < uCount; u++) {
+      pcKey = malloc(16);
+      assert(pcKey != NULL);
+      sprintf(pcKey, "~~~%08lu", ulAppended++);
+      if(!ChildArray_addAt(&sOther, u, pcKey, pcKey)) {
+         free(pcKey);
+         break;
+      }
+   }
+   uCount = ChildArray_getLength(&sOther);
+   if(!ChildArray_appendArray(oChildArray, &sOther)) {
+      for(u = 0; u < uCount; u++)
+         free(ChildArray_get(&sOther, u));
+      ChildArray_destroy(&sOther);
+      check_reference(oChildArray);
+      return;
+   }
+   for(u = 0; u < uCount; u++)
+      apcReference[uReferenceLength + u] = ChildArray_get(&sOther, u);
+   uReferenceLength += uCount;
+   ChildArray_destroy(&sOther);
+}
+
+/*
+  Runs ulOperations random operations on a ChildArray, checking it
+  against the reference array as it goes. Every 20000 operations the
+  array is steered toward a new random length below uMaxLength, so
+  that it converts between a flat array and a tree, and its tree grows
+  and shrinks by levels.
+*/
+static void test_operations(unsigned long ulOperations,
+                            size_t uMaxLength) {
+   struct ChildArray sChildArray;
+   ChildArray_T oChildArray = &sChildArray;
+   size_t uTarget = 1;
+   size_t uIndex, uCount, uFound;
+   unsigned long ul;
+   size_t uOperation;
+   char *pcKey;
+   int iFound;
+
+   ChildArray_init(oChildArray);
+   for(ul = 0; ul < ulOperations; ul++) {
+      if(ul % 20000 == 0)
+         uTarget = 1 + random_below(uMaxLength);
+      uOperation = random_below(100);
+
+      if(uOperation < 50 &&
+         (uReferenceLength < uTarget || uOperation < 25))
+         test_addAt(oChildArray);
+      else if(uOperation < 75 && uReferenceLength > 0) {
+         uIndex = random_below(uReferenceLength);
+         assert(ChildArray_removeAt(oChildArray, uIndex) ==
+                apcReference[uIndex]);
+         reference_remove(uIndex, 1);
+      }
+      else if(uOperation < 78 && uReferenceLength > 0) {
+         /* replace a key with an equal one at another address */
+         uIndex = random_below(uReferenceLength);
+         pcKey = malloc(strlen(apcReference[uIndex]) + 1);
+         assert(pcKey != NULL);
+         strcpy(pcKey, apcReference[uIndex]);
+         assert(ChildArray_set(oChildArray, uIndex, pcKey, pcKey) ==
+                apcReference[uIndex]);
+         free(apcReference[uIndex]);
+         apcReference[uIndex] = pcKey;
+      }
+      else if(uOperation < 83 && uReferenceLength > 0) {
+         uIndex = random_below(uReferenceLength);
+         uCount = random_below(uReferenceLength - uIndex + 1);
+         if(uCount > MAX_RANGE)
+            uCount = random_below(uReferenceLength - uIndex + 1);
+         ChildArray_removeRange(oChildArray, uIndex, uCount);
+         reference_remove(uIndex, uCount);
+      }
+      else if(uOperation < 90)
+         test_insertRange(oChildArray);
+      else if(uOperation < 93)
+         test_appendArray(oChildArray);
+      else if(uOperation == 93 && random_below(10) == 0) {
+         ChildArray_clear(oChildArray);
+         reference_remove(0, uReferenceLength);
+      }
+      else if(uOperation == 94)
+         (void) ChildArray_reserve(oChildArray,
+                                   uReferenceLength +
+                                   random_below(MAX_RANGE));
+      else if(uOperation == 95)
+         ChildArray_shrinkToFit(oChildArray);
+      else {
+         pcKey = new_key();
+         iFound = reference_find(pcKey, &uIndex);
+         assert(ChildArray_bsearch(oChildArray, pcKey, &uFound) ==
+                iFound);
+         assert(uFound == uIndex);
+         free(pcKey);
+      }
+
+      if(ul % 101 == 0)
+         check_reference(oChildArray);
+   }
+
+   check_reference(oChildArray);
+   reference_remove(0, uReferenceLength);
+   ChildArray_destroy(oChildArray);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Tests the ChildArray module against a reference array, first with
+   every allocation succeeding and then with one in twenty failing.
+   Prints a line to stderr as each group of tests passes. Returns 0. */
+int main(void) {
+   test_operations(200000, 2000);
+   fprintf(stderr, "operations: passed\n");
+   uFailPermille = 50;
+   test_operations(200000, 2000);
+   fprintf(stderr, "operations with allocation failures: passed\n");
+   return 0;
+}
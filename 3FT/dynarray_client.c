@@ -0,0 +1,621 @@
+/*--------------------------------------------------------------------*/
+/* dynarray_client.c                                                  */
+/* Author: Josh Schoenberg and Jack Toubes                            */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "dynarray.h"
+
+/*
+  This client is linked with a build of dynarray.c that calls
+  DynArray_testCreate and DynArray_testJoin in place of pthread_create
+  and pthread_join, so that the threads that the parallel functions
+  run at once can be counted (see Makefile).
+*/
+
+/* The number of distinct elements the tests use. */
+enum { MAX_ELEMENTS = 4096 };
+
+/* The elements: element i is &aiValues[i], whose value is i. */
+static int aiValues[MAX_ELEMENTS];
+
+/* A reference array that each DynArray_T is compared against. */
+static void *apvReference[2 * MAX_ELEMENTS];
+static size_t uReferenceLength;
+
+/* The number of elements in the arrays that the sorts are tested on,
+   enough for DynArray_sortParallel to use several threads. */
+enum { SORT_ELEMENTS = 100000 };
+
+/* The state of the pseudo-random number generator. */
+static unsigned long ulSeed = 1;
+
+/* The number of threads that DynArray has started and not yet joined,
+   and the most there have been at once. The parallel functions start
+   and join their threads from the calling thread, so these need no
+   lock. */
+static size_t uStarted;
+static size_t uMostStarted;
+
+int DynArray_testCreate(pthread_t *psThread,
+                        const pthread_attr_t *psAttributes,
+                        void *(*pfRun)(void *pvArgument),
+                        void *pvArgument);
+int DynArray_testJoin(pthread_t sThread, void **ppvResult);
+
+/* Returns pthread_create(psThread, psAttributes, pfRun, pvArgument),
+   counting the thread if it starts. */
+int DynArray_testCreate(pthread_t *psThread,
+                        const pthread_attr_t *psAttributes,
+                        void *(*pfRun)(void *pvArgument),
+                        void *pvArgument) {
+   int iStatus = pthread_create(psThread, psAttributes, pfRun,
+                                pvArgument);
+
+   if(iStatus == 0 && ++uStarted > uMostStarted)
+      uMostStarted = uStarted;
+   return iStatus;
+}
+
+/* Returns pthread_join(sThread, ppvResult), counting the thread as
+   finished if it is joined. */
+int DynArray_testJoin(pthread_t sThread, void **ppvResult) {
+   int iStatus = pthread_join(sThread, ppvResult);
+
+   if(iStatus == 0)
+      uStarted--;
+   return iStatus;
+}
+
+/* Returns a pseudo-random number in [0, uBound). */
+static size_t random_below(size_t uBound) {
+   ulSeed = ulSeed * 1103515245UL + 12345UL;
+   return (size_t) ((ulSeed >> 16) & 0x7fffUL) % uBound;
+}
+
+/* Asserts that oDynArray holds exactly the reference array. */
+static void check_reference(DynArray_T oDynArray) {
+   size_t u;
+
+   assert(DynArray_getLength(oDynArray) == uReferenceLength);
+   for(u = 0; u < uReferenceLength; u++)
+      assert(DynArray_get(oDynArray, u) == apvReference[u]);
+}
+
+/* Inserts the uCount elements of ppvElements at uIndex in the
+   reference array. */
+static void reference_insert(size_t uIndex, void *const *ppvElements,
+                             size_t uCount) {
+   memmove(&apvReference[uIndex + uCount], &apvReference[uIndex],
+           sizeof(void *) * (uReferenceLength - uIndex));
+   memcpy(&apvReference[uIndex], ppvElements, sizeof(void *) * uCount);
+   uReferenceLength += uCount;
+}
+
+/* Removes uCount elements at uIndex from the reference array. */
+static void reference_remove(size_t uIndex, size_t uCount) {
+   memmove(&apvReference[uIndex], &apvReference[uIndex + uCount],
+           sizeof(void *) * (uReferenceLength - uIndex - uCount));
+   uReferenceLength -= uCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Tests DynArray_insertRange, DynArray_removeRange, DynArray_clear,
+   and DynArray_appendArray against the reference array. */
+static void test_ranges(void) {
+   static void *apvSource[MAX_ELEMENTS];
+   DynArray_T oDynArray;
+   DynArray_T oOther;
+   size_t u, uIndex, uCount, uStart;
+
+   for(u = 0; u < MAX_ELEMENTS; u++)
+      apvSource[u] = &aiValues[u];
+
+   /* inserting nothing, at the front, at the end, and in between */
+   oDynArray = DynArray_new(0);
+   assert(oDynArray != NULL);
+   uReferenceLength = 0;
+   assert(DynArray_insertRange(oDynArray, 0, NULL, 0) == 1);
+   check_reference(oDynArray);
+   assert(DynArray_insertRange(oDynArray, 0, apvSource, 3) == 1);
+   reference_insert(0, apvSource, 3);
+   assert(DynArray_insertRange(oDynArray, 3, apvSource + 10, 5) == 1);
+   reference_insert(3, apvSource + 10, 5);
+   assert(DynArray_insertRange(oDynArray, 1, apvSource + 20, 2) == 1);
+   reference_insert(1, apvSource + 20, 2);
+   check_reference(oDynArray);
+   assert(DynArray_get(oDynArray, 1) == &aiValues[20]);
+   assert(DynArray_get(oDynArray, 9) == &aiValues[14]);
+
+   /* random insertions and removals of runs of any length */
+   for(u = 0; u < 2000; u++) {
+      if(random_below(2) == 0 &&
+         uReferenceLength < MAX_ELEMENTS - 64) {
+         uIndex = random_below(uReferenceLength + 1);
+         uCount = random_below(64);
+         uStart = random_below(MAX_ELEMENTS - 64);
+         assert(DynArray_insertRange(oDynArray, uIndex,
+                                     apvSource + uStart, uCount) == 1);
+         reference_insert(uIndex, apvSource + uStart, uCount);
+      }
+      else if(uReferenceLength > 0) {
+         uIndex = random_below(uReferenceLength);
+         uCount = random_below(uReferenceLength - uIndex + 1);
+         DynArray_removeRange(oDynArray, uIndex, uCount);
+         reference_remove(uIndex, uCount);
+      }
+      check_reference(oDynArray);
+   }
+
+   /* clearing keeps the array usable */
+   DynArray_clear(oDynArray);
+   uReferenceLength = 0;
+   check_reference(oDynArray);
+   assert(DynArray_add(oDynArray, &aiValues[7]) == 1);
+   assert(DynArray_getLength(oDynArray) == 1);
+   assert(DynArray_get(oDynArray, 0) == &aiValues[7]);
+   DynArray_removeRange(oDynArray, 0, 1);
+   DynArray_removeRange(oDynArray, 0, 0);
+   assert(DynArray_getLength(oDynArray) == 0);
+
+   /* appending another array, an empty one, and the array itself */
+   oOther = DynArray_new(0);
+   assert(oOther != NULL);
+   for(u = 0; u < 100; u++)
+      assert(DynArray_add(oOther, apvSource[u]) == 1);
+   assert(DynArray_appendArray(oDynArray, oOther) == 1);
+   assert(DynArray_appendArray(oDynArray, oOther) == 1);
+   DynArray_clear(oOther);
+   assert(DynArray_appendArray(oDynArray, oOther) == 1);
+   assert(DynArray_getLength(oDynArray) == 200);
+   assert(DynArray_appendArray(oDynArray, oDynArray) == 1);
+   assert(DynArray_getLength(oDynArray) == 400);
+   for(u = 0; u < 400; u++)
+      assert(DynArray_get(oDynArray, u) == apvSource[u % 100]);
+
+   DynArray_free(oOther);
+   DynArray_free(oDynArray);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Fills the reference array and oDynArray, which must be empty, with
+   the first uLength elements. */
+static void fill(DynArray_T oDynArray, size_t uLength) {
+   size_t u;
+
+   for(u = 0; u < uLength; u++) {
+      assert(DynArray_add(oDynArray, &aiValues[u]) == 1);
+      apvReference[u] = &aiValues[u];
+   }
+   uReferenceLength = uLength;
+}
+
+/* Tests DynArray_reserve, DynArray_shrinkToFit, and
+   DynArray_setGrowthPercent, and that an array that shrinks as it is
+   emptied keeps its elements. */
+static void test_capacity(void) {
+   static const size_t auPercents[] = { 101, 150, 200, 1000 };
+   DynArray_T oDynArray;
+   size_t u;
+
+   /* reserving room, less room than there is, and room for more
+      elements than memory can address, which must fail harmlessly */
+   oDynArray = DynArray_new(0);
+   assert(oDynArray != NULL);
+   assert(DynArray_reserve(oDynArray, 1000) == 1);
+   assert(DynArray_getLength(oDynArray) == 0);
+   fill(oDynArray, 1000);
+   assert(DynArray_reserve(oDynArray, 10) == 1);
+   assert(DynArray_reserve(oDynArray, (size_t) -1) == 0);
+   assert(DynArray_reserve(oDynArray,
+                           (size_t) -1 / sizeof(void *) + 2) == 0);
+   assert(DynArray_insertRange(oDynArray, 0, apvReference,
+                               (size_t) -1) == 0);
+   check_reference(oDynArray);
+
+   /* shrinking to fit, empty and not */
+   DynArray_shrinkToFit(oDynArray);
+   check_reference(oDynArray);
+   assert(DynArray_add(oDynArray, &aiValues[1000]) == 1);
+   apvReference[uReferenceLength++] = &aiValues[1000];
+   check_reference(oDynArray);
+   DynArray_clear(oDynArray);
+   DynArray_shrinkToFit(oDynArray);
+   uReferenceLength = 0;
+   check_reference(oDynArray);
+   DynArray_free(oDynArray);
+
+   /* growing by any factor, then emptying the array from the back and
+      from the front as it shrinks, and growing it again */
+   for(u = 0; u < sizeof(auPercents) / sizeof(auPercents[0]); u++) {
+      /* start from a different physical length each time */
+      oDynArray = DynArray_new(u);
+      assert(oDynArray != NULL);
+      DynArray_removeRange(oDynArray, 0, u);
+      DynArray_setGrowthPercent(oDynArray, auPercents[u]);
+      fill(oDynArray, MAX_ELEMENTS);
+      check_reference(oDynArray);
+      while(uReferenceLength > 1) {
+         if(uReferenceLength % 2 == 0) {
+            assert(DynArray_removeAt(oDynArray, uReferenceLength - 1)
+                   == apvReference[uReferenceLength - 1]);
+            reference_remove(uReferenceLength - 1, 1);
+         }
+         else {
+            assert(DynArray_removeAt(oDynArray, 0) == apvReference[0]);
+            reference_remove(0, 1);
+         }
+         if(uReferenceLength % 97 == 0)
+            check_reference(oDynArray);
+      }
+      check_reference(oDynArray);
+      DynArray_removeRange(oDynArray, 0, 1);
+      fill(oDynArray, MAX_ELEMENTS / 2);
+      check_reference(oDynArray);
+      DynArray_free(oDynArray);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The number of comparisons made by count_ints and compare_gas. */
+static unsigned long ulComparisons;
+
+/* Returns <0, 0, or >0 as the int at pvElement1 is less than, equal
+   to, or greater than the int at pvElement2. */
+static int compare_ints(const void *pvElement1,
+                        const void *pvElement2) {
+   int i1 = *(const int *) pvElement1;
+   int i2 = *(const int *) pvElement2;
+
+   return (i1 > i2) - (i1 < i2);
+}
+
+/* Compares as compare_ints does, counting the call, and so is not to
+   be called from several threads at once. */
+static int count_ints(const void *pvElement1, const void *pvElement2) {
+   ulComparisons++;
+   return compare_ints(pvElement1, pvElement2);
+}
+
+/* The state of McIlroy's adversary: the values that compare_gas has
+   decided on for the elements being sorted, which are ints that
+   index it, with iGas for those still undecided. */
+static int *piGasValues;
+static int iGas;
+static int iSolids;
+static int iCandidate;
+
+/*
+  Compares the elements at pvElement1 and pvElement2, each an index
+  into piGasValues, as McIlroy's adversary does: it decides the
+  values of elements only as they are compared, so as to make a
+  quicksort take quadratic time.
+*/
+static int compare_gas(const void *pvElement1, const void *pvElement2) {
+   int i1 = *(const int *) pvElement1;
+   int i2 = *(const int *) pvElement2;
+
+   ulComparisons++;
+   if(piGasValues[i1] == iGas && piGasValues[i2] == iGas) {
+      if(i1 == iCandidate)
+         piGasValues[i1] = iSolids++;
+      else
+         piGasValues[i2] = iSolids++;
+   }
+   if(piGasValues[i1] == iGas)
+      iCandidate = i1;
+   else if(piGasValues[i2] == iGas)
+      iCandidate = i2;
+   return (piGasValues[i1] > piGasValues[i2]) -
+          (piGasValues[i1] < piGasValues[i2]);
+}
+
+/* Returns floor(log2(uValue)) + 1 for uValue > 0, or 0 otherwise. */
+static unsigned long bit_length(size_t uValue) {
+   unsigned long ulBits = 0;
+
+   while(uValue > 0) {
+      uValue >>= 1;
+      ulBits++;
+   }
+   return ulBits;
+}
+
+/* The orders that the sorts are tested on. */
+enum Pattern { RANDOM, SORTED, REVERSED, EQUAL, FEW_DISTINCT,
+               ORGAN_PIPE, SAWTOOTH, NEARLY_SORTED, MEDIAN_OF_3_KILLER,
+               PATTERNS };
+
+/*
+  Fills oDynArray, which must be empty, with the uLength elements of
+  piKeys, after setting each to the value that ePattern gives it.
+*/
+static void fill_pattern(DynArray_T oDynArray, int *piKeys,
+                         size_t uLength, enum Pattern ePattern) {
+   size_t u, uHalf;
+
+   uHalf = uLength / 2;
+   for(u = 0; u < uLength; u++) {
+      switch(ePattern) {
+         case RANDOM: piKeys[u] = (int) random_below(32768); break;
+         case SORTED: piKeys[u] = (int) u; break;
+         case REVERSED: piKeys[u] = (int) (uLength - u); break;
+         case EQUAL: piKeys[u] = 7; break;
+         case FEW_DISTINCT: piKeys[u] = (int) random_below(4); break;
+         case ORGAN_PIPE:
+            piKeys[u] = (int) (u < uHalf ? u : uLength - u);
+            break;
+         case SAWTOOTH: piKeys[u] = (int) (u % 37); break;
+         case NEARLY_SORTED:
+            piKeys[u] = (int) u;
+            if(random_below(100) == 0)
+               piKeys[u] = (int) random_below(uLength);
+            break;
+         default:
+            /* Musser's sequence, which defeats median-of-3 pivots:
+               1, k+2, 3, k+4, ..., then 2, 4, ..., 2k */
+            if(u < uHalf)
+               piKeys[u] = (int) (u % 2 == 0 ? u + 1 : uHalf + u + 1);
+            else
+               piKeys[u] = (int) (2 * (u - uHalf + 1));
+            break;
+      }
+      assert(DynArray_add(oDynArray, &piKeys[u]) == 1);
+   }
+}
+
+/*
+  Asserts that oDynArray, of uLength elements of piKeys, holds each of
+  them once, in nondecreasing order of their values.
+*/
+static void check_sorted(DynArray_T oDynArray, const int *piKeys,
+                         size_t uLength) {
+   static char acSeen[SORT_ELEMENTS];
+   const int *piElement;
+   size_t u;
+
+   assert(DynArray_getLength(oDynArray) == uLength);
+   memset(acSeen, 0, uLength);
+   for(u = 0; u < uLength; u++) {
+      piElement = DynArray_get(oDynArray, u);
+      assert(piElement >= piKeys && piElement < piKeys + uLength);
+      assert(!acSeen[piElement - piKeys]);
+      acSeen[piElement - piKeys] = 1;
+      if(u > 0)
+         assert(*(const int *) DynArray_get(oDynArray, u - 1) <=
+                *piElement);
+   }
+}
+
+/*
+  Tests DynArray_sort on patterns known to slow down quicksorts, and
+  against McIlroy's adversary, checking that it makes O(n log n)
+  comparisons; and tests that DynArray_sortParallel sorts the same
+  patterns with any number of threads.
+*/
+static void test_sort(void) {
+   static const size_t auLengths[] = { 0, 1, 2, 3, 23, 24, 25, 100,
+                                       1000, 20000, SORT_ELEMENTS };
+   static const size_t auThreads[] = { 1, 2, 3, 8 };
+   DynArray_T oDynArray;
+   int *piKeys;
+   size_t uSize, uLength, uThread, u;
+   int iPattern;
+
+   piKeys = malloc(sizeof(int) * SORT_ELEMENTS);
+   piGasValues = malloc(sizeof(int) * SORT_ELEMENTS);
+   assert(piKeys != NULL && piGasValues != NULL);
+
+   for(uSize = 0; uSize < sizeof(auLengths) / sizeof(auLengths[0]);
+       uSize++) {
+      uLength = auLengths[uSize];
+      for(iPattern = 0; iPattern < PATTERNS; iPattern++) {
+         oDynArray = DynArray_new(0);
+         assert(oDynArray != NULL);
+         fill_pattern(oDynArray, piKeys, uLength,
+                      (enum Pattern) iPattern);
+         ulComparisons = 0;
+         DynArray_sort(oDynArray, count_ints);
+         check_sorted(oDynArray, piKeys, uLength);
+         assert(ulComparisons <= 4 * uLength * bit_length(uLength));
+
+         for(uThread = 0;
+             uThread < sizeof(auThreads) / sizeof(auThreads[0]);
+             uThread++) {
+            DynArray_clear(oDynArray);
+            fill_pattern(oDynArray, piKeys, uLength,
+                         (enum Pattern) iPattern);
+            DynArray_sortParallel(oDynArray, compare_ints,
+                                  auThreads[uThread]);
+            check_sorted(oDynArray, piKeys, uLength);
+         }
+         DynArray_free(oDynArray);
+      }
+
+      /* McIlroy's adversary, which decides the order as it goes */
+      oDynArray = DynArray_new(0);
+      assert(oDynArray != NULL);
+      for(u = 0; u < uLength; u++) {
+         piKeys[u] = (int) u;
+         assert(DynArray_add(oDynArray, &piKeys[u]) == 1);
+      }
+      iGas = (int) uLength;
+      iSolids = 0;
+      iCandidate = 0;
+      for(u = 0; u < uLength; u++)
+         piGasValues[u] = iGas;
+      ulComparisons = 0;
+      DynArray_sort(oDynArray, compare_gas);
+      assert(ulComparisons <= 4 * uLength * bit_length(uLength));
+      for(u = 1; u < uLength; u++)
+         assert(piGasValues[*(int *) DynArray_get(oDynArray, u - 1)] <=
+                piGasValues[*(int *) DynArray_get(oDynArray, u)]);
+      DynArray_free(oDynArray);
+   }
+
+   free(piGasValues);
+   free(piKeys);
+}
+
+/* Tests that DynArray_sortParallel runs no more than the threads it
+   is given at once, counting the calling thread, including when the
+   array is split into an odd number of runs, one of which is left
+   over in some merging rounds. */
+static void test_sort_threads(void) {
+   static const size_t auThreads[] = { 2, 3, 4, 5, 6, 7, 9, 11 };
+   DynArray_T oDynArray;
+   int *piKeys;
+   size_t uThread;
+
+   piKeys = malloc(sizeof(int) * SORT_ELEMENTS);
+   assert(piKeys != NULL);
+
+   for(uThread = 0; uThread < sizeof(auThreads) / sizeof(auThreads[0]);
+       uThread++) {
+      oDynArray = DynArray_new(0);
+      assert(oDynArray != NULL);
+      fill_pattern(oDynArray, piKeys, SORT_ELEMENTS, RANDOM);
+      uMostStarted = 0;
+      DynArray_sortParallel(oDynArray, compare_ints,
+                            auThreads[uThread]);
+      check_sorted(oDynArray, piKeys, SORT_ELEMENTS);
+      /* SORT_ELEMENTS is long enough for a run per thread */
+      assert(uStarted == 0);
+      assert(uMostStarted + 1 == auThreads[uThread]);
+      DynArray_free(oDynArray);
+   }
+
+   free(piKeys);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The number of times each element has been visited by
+   visit_element. */
+static int aiVisits[MAX_ELEMENTS];
+
+/* Adds the int at pvExtra to the visit count that pvElement, which
+   points into aiValues, corresponds to. */
+static void visit_element(void *pvElement, void *pvExtra) {
+   aiVisits[(int *) pvElement - aiValues] += *(const int *) pvExtra;
+}
+
+/* An order-sensitive summary of a run of elements of aiValues: the
+   first and last values, their count, and whether each value was one
+   more than the one before it. */
+struct Run {
+   int iFirst;
+   int iLast;
+   size_t uCount;
+   int iConsecutive;
+};
+
+/* Extends the run at pvAccumulator with the int at pvElement. */
+static void extend_run(void *pvElement, void *pvAccumulator) {
+   struct Run *psRun = (struct Run *) pvAccumulator;
+   int iValue = *(int *) pvElement;
+
+   if(psRun->uCount == 0)
+      psRun->iFirst = iValue;
+   else if(iValue != psRun->iLast + 1)
+      psRun->iConsecutive = 0;
+   psRun->iLast = iValue;
+   psRun->uCount++;
+}
+
+/* Appends the run at pvPartial to the run at pvAccumulator. */
+static void join_runs(void *pvAccumulator, void *pvPartial) {
+   struct Run *psRun = (struct Run *) pvAccumulator;
+   struct Run *psPartial = (struct Run *) pvPartial;
+
+   if(psPartial->uCount == 0)
+      return;
+   if(psRun->uCount == 0) {
+      *psRun = *psPartial;
+      return;
+   }
+   if(!psPartial->iConsecutive || psPartial->iFirst != psRun->iLast + 1)
+      psRun->iConsecutive = 0;
+   psRun->iLast = psPartial->iLast;
+   psRun->uCount += psPartial->uCount;
+}
+
+/* Tests that DynArray_mapParallel visits each element exactly once
+   and that DynArray_reduceParallel folds the elements in order, with
+   fewer threads than elements, as many, and more. */
+static void test_parallel(void) {
+   static const size_t auLengths[] = { 0, 1, 2, 7, 100, MAX_ELEMENTS };
+   static const size_t auThreads[] = { 0, 1, 2, 3, 8, 64 };
+   static const int iOne = 1;
+   DynArray_T oDynArray;
+   struct Run sRun;
+   size_t uSize, uThread, uLength, u;
+
+   for(uSize = 0; uSize < sizeof(auLengths) / sizeof(auLengths[0]);
+       uSize++) {
+      uLength = auLengths[uSize];
+      oDynArray = DynArray_new(0);
+      assert(oDynArray != NULL);
+      fill(oDynArray, uLength);
+
+      for(uThread = 0;
+          uThread < sizeof(auThreads) / sizeof(auThreads[0]);
+          uThread++) {
+         for(u = 0; u < MAX_ELEMENTS; u++)
+            aiVisits[u] = 0;
+         DynArray_mapParallel(oDynArray, visit_element, &iOne,
+                              auThreads[uThread]);
+         for(u = 0; u < MAX_ELEMENTS; u++)
+            assert(aiVisits[u] == (u < uLength));
+
+         sRun.iFirst = -1;
+         sRun.iLast = -1;
+         sRun.uCount = 0;
+         sRun.iConsecutive = 1;
+         DynArray_reduceParallel(oDynArray, extend_run, join_runs,
+                                 &sRun, sizeof(sRun),
+                                 auThreads[uThread]);
+         assert(sRun.uCount == uLength);
+         assert(sRun.iConsecutive);
+         if(uLength > 0) {
+            assert(sRun.iFirst == 0);
+            assert(sRun.iLast == (int) uLength - 1);
+         }
+      }
+      check_reference(oDynArray);
+      DynArray_free(oDynArray);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Tests the DynArray functions beyond the basic ones that the FT
+   relies on. Prints a line to stderr as each group of tests passes.
+   Returns 0. */
+int main(void) {
+   size_t u;
+
+   for(u = 0; u < MAX_ELEMENTS; u++)
+      aiValues[u] = (int) u;
+
+   test_ranges();
+   fprintf(stderr, "range operations: passed\n");
+   test_capacity();
+   fprintf(stderr, "capacity: passed\n");
+   test_sort();
+   fprintf(stderr, "sorting: passed\n");
+   test_sort_threads();
+   fprintf(stderr, "threads of parallel sorting: passed\n");
+   test_parallel();
+   fprintf(stderr, "parallel map and reduce: passed\n");
+
+   return 0;
+}
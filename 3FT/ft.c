@@ -8,9 +8,14 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/uio.h>
 
 #include "dynarray.h"
 #include "path.h"
+#include "glob.h"
 #include "nodeFT.h"
 #include "checkerFT.h"
 #include "ft.h"
@@ -22,6 +27,165 @@ static boolean bIsInitialized;
 static Node_T oNRoot;
 /* 3. a counter of the number of nodes in the hierarchy */
 static size_t ulCount;
+/* 4. a flag for whether insertions collapse chains of single-child
+      directories into one node (TRUE) or not (FALSE) */
+static boolean bCompressChains;
+/* 5. the string representation of the FT last generated, or NULL if
+      there is none, its length, and the size of its buffer; the
+      nodes whose lines in it are still up to date know where they
+      are */
+static char *pcText;
+static size_t ulTextLength;
+static size_t ulTextSize;
+/* 6. a buffer for the next representation to be generated in, while
+      the last is copied from, or NULL, and its size */
+static char *pcSpare;
+static size_t ulSpareSize;
+/* 7. the length of the string representation of the FT as it is */
+static size_t ulStringLength;
+/* 8. a flag for whether FT_rmDir leaves freeing what it removes to a
+      background thread (TRUE) or not (FALSE) */
+static boolean bDeferRemoval;
+
+
+
+/* --------------------------------------------------------------------
+
+  The following functions free the subtrees that FT_rmDir removes in
+  a background thread, the reclaimer, while removals are deferred. A
+  removed subtree is unlinked from the FT at once and queued, and the
+  reclaimer then frees it a few nodes at a time. The FT and the queued
+  subtrees share no nodes, but their paths share the tables of the
+  path module, so paths are made, freed, and looked up only with the
+  lock held.
+*/
+
+/* The number of nodes the reclaimer frees each time it takes the
+   lock. */
+enum { RECLAIM_BATCH_NODES = 64 };
+
+/* the lock, and the condition that a subtree has been queued or that
+   the reclaimer is to stop */
+static pthread_mutex_t sReclaimLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sReclaimChanged = PTHREAD_COND_INITIALIZER;
+/* the nodes queued to be freed, each the root of a parentless
+   subtree, or NULL if none has been queued */
+static DynArray_T oReclaimQueue;
+/* the reclaimer, if bReclaiming, and whether it is to stop once the
+   queue is empty */
+static pthread_t sReclaimer;
+static boolean bReclaiming;
+static boolean bReclaimStop;
+
+/* Takes the lock, if removals are deferred. */
+static void FT_lock(void) {
+   if(bDeferRemoval)
+      (void) pthread_mutex_lock(&sReclaimLock);
+}
+
+/* Releases the lock taken with FT_lock. */
+static void FT_unlock(void) {
+   if(bDeferRemoval)
+      (void) pthread_mutex_unlock(&sReclaimLock);
+}
+
+/*
+  Runs the reclaimer: frees the subtrees in oReclaimQueue as they are
+  queued, until asked to stop with the queue empty. Each node freed is
+  replaced in the queue by its children, so that the lock need not be
+  held while a whole subtree is freed.
+*/
+static void *FT_reclaim(void *pvUnused) {
+   Node_T oNNode = NULL;
+   Node_T oNChild = NULL;
+   size_t ulFreed;
+   size_t ulLength;
+   size_t ulIndex;
+
+   (void) pvUnused;
+
+   (void) pthread_mutex_lock(&sReclaimLock);
+   for(;;) {
+      while(DynArray_getLength(oReclaimQueue) == 0 && !bReclaimStop)
+         (void) pthread_cond_wait(&sReclaimChanged, &sReclaimLock);
+      if(DynArray_getLength(oReclaimQueue) == 0)
+         break;
+
+      for(ulFreed = 0; ulFreed < RECLAIM_BATCH_NODES &&
+          DynArray_getLength(oReclaimQueue) != 0; ulFreed++) {
+         ulLength = DynArray_getLength(oReclaimQueue);
+         oNNode = DynArray_removeAt(oReclaimQueue, ulLength - 1);
+
+         /* without room to queue its children, free them now */
+         if(!DynArray_reserve(oReclaimQueue, ulLength - 1 +
+                              Node_getNumChildren(oNNode))) {
+            (void) Node_free(oNNode);
+            continue;
+         }
+         for(ulIndex = 0; ulIndex < Node_getNumChildren(oNNode);
+             ulIndex++) {
+            (void) Node_getChild(oNNode, ulIndex, &oNChild);
+            (void) DynArray_add(oReclaimQueue, oNChild);
+         }
+         Node_freeTop(oNNode);
+      }
+
+      /* let the FT be used between batches */
+      (void) pthread_mutex_unlock(&sReclaimLock);
+      (void) sched_yield();
+      (void) pthread_mutex_lock(&sReclaimLock);
+   }
+   (void) pthread_mutex_unlock(&sReclaimLock);
+   return NULL;
+}
+
+/*
+  Queues the parentless subtree rooted at oNNode to be freed by the
+  reclaimer, starting the reclaimer if it is not running, or frees the
+  subtree at once if it cannot be queued. The lock must be held.
+*/
+static void FT_reclaimLater(Node_T oNNode) {
+   assert(oNNode != NULL);
+   assert(Node_getParent(oNNode) == NULL);
+
+   if(oReclaimQueue == NULL)
+      oReclaimQueue = DynArray_new(0);
+   if(oReclaimQueue == NULL || !DynArray_add(oReclaimQueue, oNNode)) {
+      (void) Node_free(oNNode);
+      return;
+   }
+
+   if(!bReclaiming) {
+      bReclaimStop = FALSE;
+      if(pthread_create(&sReclaimer, NULL, FT_reclaim, NULL) != 0) {
+         /* with no reclaimer, oNNode is the only node queued */
+         (void) DynArray_removeAt(oReclaimQueue, 0);
+         (void) Node_free(oNNode);
+         return;
+      }
+      bReclaiming = TRUE;
+   }
+   (void) pthread_cond_signal(&sReclaimChanged);
+}
+
+/*
+  Waits for the reclaimer, if it is running, to free everything
+  queued and stop, and frees the queue.
+*/
+static void FT_reclaimAll(void) {
+   if(bReclaiming) {
+      (void) pthread_mutex_lock(&sReclaimLock);
+      bReclaimStop = TRUE;
+      (void) pthread_cond_signal(&sReclaimChanged);
+      (void) pthread_mutex_unlock(&sReclaimLock);
+      (void) pthread_join(sReclaimer, NULL);
+      bReclaiming = FALSE;
+   }
+   if(oReclaimQueue != NULL) {
+      DynArray_free(oReclaimQueue);
+      oReclaimQueue = NULL;
+   }
+}
 
 
 
@@ -31,28 +195,65 @@ static size_t ulCount;
   functionality of going as far as possible down an FT towards a path
   and returning either the node of however far was reached or the
   node if the full path was reached, respectively.
+
+  A node may stand for a chain of single-child directories above it
+  (see Node_getEdgeDepth), so both also report the depth reached: when
+  that depth is less than the found node's own depth, the position
+  reached is one of the directories the node stands for implicitly.
+*/
+
+/*
+  Returns the number of leading components of the path that psView
+  views that match oNNode's path, given that the first ulFrom of them
+  are already known to match.
 */
+static size_t FT_matchPath(Node_T oNNode, PathView *psView,
+                           size_t ulFrom) {
+   Path_T oPNodePath;
+   size_t ulMin;
+
+   assert(oNNode != NULL);
+   assert(psView != NULL);
+
+   oPNodePath = Node_getPath(oNNode);
+   ulMin = Path_getDepth(oPNodePath);
+   if(Path_getViewDepth(psView) < ulMin)
+      ulMin = Path_getViewDepth(psView);
+
+   /* interned components are equal exactly when they are the same
+      string */
+   while(ulFrom < ulMin &&
+         Path_getComponent(oPNodePath, ulFrom) ==
+         Path_getViewComponent(psView, ulFrom))
+      ulFrom++;
+   return ulFrom;
+}
 
 /*
   Traverses the FT starting at the root as far as possible towards
-  absolute path oPPath. If able to traverse, returns an int SUCCESS
-  status and sets *poNFurthest to the furthest node reached (which may
-  be only a prefix of oPPath, or even NULL if the root is NULL).
+  the absolute path that psView views. If able to traverse, returns an
+  int SUCCESS status, sets *poNFurthest to the furthest node reached
+  (which may be only a prefix of the path, or even NULL if the root is
+  NULL), and sets *pulDepth to the number of levels of the path
+  reached (0 if the root is NULL).
   Otherwise, sets *poNFurthest to NULL and returns with status:
-  * CONFLICTING_PATH if the root's path is not a prefix of oPPath
-  * MEMORY_ERROR if memory could not be allocated to complete request
+  * CONFLICTING_PATH if the root's path is not a prefix of the path
+  * NO_SUCH_PATH if a child could not be retrieved
 */
-static int FT_traversePath(Path_T oPPath, Node_T *poNFurthest) {
+static int FT_traversePath(PathView *psView, Node_T *poNFurthest,
+                           size_t *pulDepth) {
    int iStatus;
-   Path_T oPPrefix = NULL;
    Node_T oNCurr;
    Node_T oNChild = NULL;
    size_t ulDepth;
-   size_t i;
+   size_t ulReached;
    size_t ulChildID = 0;
 
-   assert(oPPath != NULL);
+   assert(psView != NULL);
    assert(poNFurthest != NULL);
+   assert(pulDepth != NULL);
+
+   *pulDepth = 0;
 
    /* root is NULL -> won't find anything */
    if(oNRoot == NULL) {
@@ -60,114 +261,122 @@ static int FT_traversePath(Path_T oPPath, Node_T *poNFurthest) {
       return SUCCESS;
    }
 
-   iStatus = Path_prefix(oPPath, 1, &oPPrefix);
-   if(iStatus != SUCCESS) {
-      *poNFurthest = NULL;
-      return iStatus;
-   }
-
-   if(Path_comparePath(Node_getPath(oNRoot), oPPrefix)) {
-      Path_free(oPPrefix);
+   ulReached = FT_matchPath(oNRoot, psView, 0);
+   if(ulReached == 0) {
       *poNFurthest = NULL;
       return CONFLICTING_PATH;
    }
-   Path_free(oPPrefix);
-   oPPrefix = NULL;
 
    oNCurr = oNRoot;
-   ulDepth = Path_getDepth(oPPath);
-   for(i = 2; i <= ulDepth; i++) {
-      iStatus = Path_prefix(oPPath, i, &oPPrefix);
+   ulDepth = Path_getViewDepth(psView);
+   /* descend while all of oNCurr's path has been reached */
+   while(ulReached < ulDepth &&
+         ulReached == Path_getDepth(Node_getPath(oNCurr))) {
+      if(!Node_findChild(oNCurr,
+                         Path_getViewComponent(psView, ulReached),
+                         &ulChildID)) {
+         /* oNCurr doesn't have child on the path's branch:
+            this is as far as we can go */
+         break;
+      }
+
+      /* go to that child and continue with next component */
+      iStatus = Node_getChild(oNCurr, ulChildID, &oNChild);
       if(iStatus != SUCCESS) {
          *poNFurthest = NULL;
          return iStatus;
       }
-      if(Node_hasChild(oNCurr, oPPrefix, &ulChildID)) {
-         /* go to that child and continue with next prefix */
-         Path_free(oPPrefix);
-         oPPrefix = NULL;
-         iStatus = Node_getChild(oNCurr, ulChildID, &oNChild);
-         if(iStatus != SUCCESS) {
-            *poNFurthest = NULL;
-            return iStatus;
-         }
-         oNCurr = oNChild;
-      }
-      else {
-         /* oNCurr doesn't have child with path oPPrefix:
-            this is as far as we can go */
-         break;
-      }
+      oNCurr = oNChild;
+      ulReached = FT_matchPath(oNCurr, psView, ulReached + 1);
    }
 
-   Path_free(oPPrefix);
    *poNFurthest = oNCurr;
+   *pulDepth = ulReached;
    return SUCCESS;
 }
 
 /*
-  Traverses the FT to find a node with absolute path pcPath. Returns a
-  int SUCCESS status and sets *poNResult to be the node, if found.
+  Traverses the FT to find a node with absolute path pcPath, without
+  allocating memory. Returns a int SUCCESS status and sets *poNResult
+  to be the node, if found, and *pulDepth to pcPath's depth. If
+  *pulDepth is less than the depth of *poNResult's path, pcPath is a
+  directory that *poNResult stands for implicitly.
   Otherwise, sets *poNResult to NULL and returns with status:
   * INITIALIZATION_ERROR if the FT is not in an initialized state
   * BAD_PATH if pcPath does not represent a well-formatted path
   * CONFLICTING_PATH if the root's path is not a prefix of pcPath
   * NO_SUCH_PATH if no node with pcPath exists in the hierarchy
-  * MEMORY_ERROR if memory could not be allocated to complete request
  */
-static int FT_findNode(const char *pcPath, Node_T *poNResult) {
-   Path_T oPPath = NULL;
+static int FT_findNode(const char *pcPath, Node_T *poNResult,
+                       size_t *pulDepth) {
+   PathView sView;
    Node_T oNFound = NULL;
+   size_t ulReached = 0;
    int iStatus;
 
    assert(pcPath != NULL);
    assert(poNResult != NULL);
+   assert(pulDepth != NULL);
 
    if(!bIsInitialized) {
       *poNResult = NULL;
       return INITIALIZATION_ERROR;
    }
 
-   iStatus = Path_new(pcPath, &oPPath);
-   if(iStatus != SUCCESS) {
-      *poNResult = NULL;
-      return iStatus;
-   }
-
-   iStatus = FT_traversePath(oPPath, &oNFound);
+   FT_lock();
+   iStatus = Path_parseInto(pcPath, &sView);
+   if(iStatus == SUCCESS)
+      iStatus = FT_traversePath(&sView, &oNFound, &ulReached);
+   FT_unlock();
    if(iStatus != SUCCESS)
    {
-      Path_free(oPPath);
       *poNResult = NULL;
       return iStatus;
    }
 
    if(oNFound == NULL) {
-      Path_free(oPPath);
       *poNResult = NULL;
       return NO_SUCH_PATH;
    }
 
-   if(Path_comparePath(Node_getPath(oNFound), oPPath) != 0) {
-      Path_free(oPPath);
+   if(ulReached != Path_getViewDepth(&sView)) {
       *poNResult = NULL;
       return NO_SUCH_PATH;
    }
 
-   Path_free(oPPath);
    *poNResult = oNFound;
+   *pulDepth = ulReached;
    return SUCCESS;
 }
-/*--------------------------------------------------------------------*/
 
+/*
+  Returns TRUE if the position at depth ulDepth within oNNode, as
+  reported by FT_findNode, is a file, or FALSE if it is a directory.
+*/
+static boolean FT_isFileAt(Node_T oNNode, size_t ulDepth) {
+   assert(oNNode != NULL);
 
-int FT_insertDir(const char *pcPath) {
+   return (boolean) (Node_isFile(oNNode) &&
+                     ulDepth == Path_getDepth(Node_getPath(oNNode)));
+}
+/*--------------------------------------------------------------------*/
+
+/*
+  Inserts a new file (if bIsFile) with contents pvContents of length
+  ulLength, or a new directory (otherwise), into the FT with absolute
+  path pcPath, creating any missing ancestor directories. Returns the
+  statuses documented for FT_insertDir and FT_insertFile.
+*/
+static int FT_insertPath(const char *pcPath, boolean bIsFile,
+                         void *pvContents, size_t ulLength) {
    int iStatus;
    Path_T oPPath = NULL;
+   PathView sView;
    Node_T oNFirstNew = NULL;
    Node_T oNCurr = NULL;
    size_t ulDepth, ulIndex;
-   size_t ulNewNodes = 0;
+   size_t ulReached = 0;
+   size_t ulAdded = 0;
 
    assert(pcPath != NULL);
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
@@ -181,47 +390,69 @@ int FT_insertDir(const char *pcPath) {
       return iStatus;
 
    /* find the closest ancestor of oPPath already in the tree */
-   iStatus= FT_traversePath(oPPath, &oNCurr);
+   Path_getView(oPPath, &sView);
+   iStatus = FT_traversePath(&sView, &oNCurr, &ulReached);
    if(iStatus != SUCCESS)
    {
       Path_free(oPPath);
       return iStatus;
    }
 
-   /* no ancestor node found, so if root is not NULL,
-      pcPath isn't underneath root. */
-   if(oNCurr == NULL && oNRoot != NULL) {
+   /* a file cannot be the root */
+   if(bIsFile && oNCurr == NULL) {
       Path_free(oPPath);
       return CONFLICTING_PATH;
    }
 
    /* The ancestor found is a file */
-   if (oNCurr != NULL && Node_isFile(oNCurr)) {
+   if(oNCurr != NULL && FT_isFileAt(oNCurr, ulReached)) {
       Path_free(oPPath);
       return NOT_A_DIRECTORY;
    }
 
    ulDepth = Path_getDepth(oPPath);
-   if(oNCurr == NULL) /* new root! */
-      ulIndex = 1;
-   else {
-      ulIndex = Path_getDepth(Node_getPath(oNCurr))+1;
 
-      /* oNCurr is the node we're trying to insert */
-      if(ulIndex == ulDepth+1 && !Path_comparePath(oPPath,
-                                       Node_getPath(oNCurr))) {
+   /* oNCurr is (or stands for) the node we're trying to insert */
+   if(ulReached == ulDepth) {
+      Path_free(oPPath);
+      return ALREADY_IN_TREE;
+   }
+
+   /* the closest ancestor is implicit in oNCurr: make it explicit */
+   if(oNCurr != NULL &&
+      ulReached < Path_getDepth(Node_getPath(oNCurr))) {
+      Node_T oNUpper = NULL;
+      boolean bWasRoot = (boolean) (oNCurr == oNRoot);
+
+      iStatus = Node_split(oNCurr, ulReached, &oNUpper);
+      if(iStatus != SUCCESS) {
          Path_free(oPPath);
-         return ALREADY_IN_TREE;
+         return iStatus;
       }
+      if(bWasRoot)
+         oNRoot = oNUpper;
+      oNCurr = oNUpper;
    }
 
-   /* starting at oNCurr, build rest of the path one level at a time */
+   /* starting at oNCurr, build rest of the path one level at a time,
+      or all at once when compressing chains */
+   ulIndex = ulReached + 1;
+   if(bCompressChains)
+      ulIndex = ulDepth;
    while(ulIndex <= ulDepth) {
       Path_T oPPrefix = NULL;
       Node_T oNNewNode = NULL;
 
-      /* generate a Path_T for this level */
-      iStatus = Path_prefix(oPPath, ulIndex, &oPPrefix);
+      /* generate a Path_T for this level, extending the path of the
+         node above it by one component where there is one */
+      if(ulIndex == ulDepth)
+         iStatus = Path_dup(oPPath, &oPPrefix);
+      else if(oNCurr == NULL)
+         iStatus = Path_prefix(oPPath, ulIndex, &oPPrefix);
+      else
+         iStatus = Path_child(Node_getPath(oNCurr),
+                              Path_getComponent(oPPath, ulIndex - 1),
+                              &oPPrefix);
       if(iStatus != SUCCESS) {
          Path_free(oPPath);
          if(oNFirstNew != NULL)
@@ -231,7 +462,13 @@ int FT_insertDir(const char *pcPath) {
       }
 
       /* insert the new node for this level */
-      iStatus = Node_dir_new(oPPrefix, oNCurr, &oNNewNode);
+      /* if this is the file, create a new file node. Otherwise,
+         create a new directory node */
+      if(bIsFile && ulIndex == ulDepth)
+         iStatus = Node_file_new(oPPrefix, oNCurr, &oNNewNode,
+                                 pvContents, ulLength);
+      else
+         iStatus = Node_dir_new(oPPrefix, oNCurr, &oNNewNode);
       if(iStatus != SUCCESS) {
          Path_free(oPPath);
          Path_free(oPPrefix);
@@ -243,8 +480,8 @@ int FT_insertDir(const char *pcPath) {
 
       /* set up for next level */
       Path_free(oPPrefix);
+      ulAdded += Node_getLinesLength(oNNewNode);
       oNCurr = oNNewNode;
-      ulNewNodes++;
       if(oNFirstNew == NULL)
          oNFirstNew = oNCurr;
       ulIndex++;
@@ -254,21 +491,83 @@ int FT_insertDir(const char *pcPath) {
    /* update FT state variables to reflect insertion */
    if(oNRoot == NULL)
       oNRoot = oNFirstNew;
-   ulCount += ulNewNodes;
+   ulCount += ulDepth - ulReached;
+   ulStringLength += ulAdded;
 
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
    return SUCCESS;
 }
 
+/*
+  Removes the directory or file at depth ulDepth within oNNode, as
+  reported by FT_findNode, along with everything below it, leaving
+  what it removes to the reclaimer to free (if bDefer) or freeing it
+  at once (otherwise). Returns SUCCESS, or MEMORY_ERROR if memory
+  could not be allocated to keep the directories oNNode stands for
+  above that depth.
+*/
+static int FT_removeAt(Node_T oNNode, size_t ulDepth, boolean bDefer) {
+   size_t ulTop;
+   size_t ulOffset, ulLength;
+
+   assert(oNNode != NULL);
+
+   /* depth of the first directory that oNNode stands for */
+   ulTop = Path_getDepth(Node_getPath(oNNode))
+           - Node_getEdgeDepth(oNNode) + 1;
+
+   FT_lock();
+
+   /* keep the directories oNNode stands for above ulDepth */
+   if(ulDepth > ulTop) {
+      Node_T oNUpper = NULL;
+      int iStatus = Node_split(oNNode, ulDepth - 1, &oNUpper);
+      if(iStatus != SUCCESS) {
+         FT_unlock();
+         return iStatus;
+      }
+      if(oNNode == oNRoot)
+         oNRoot = oNUpper;
+   }
+
+   (void) Node_getText(oNNode, &ulOffset, &ulLength);
+   ulStringLength -= ulLength;
+   if(bDefer) {
+      ulCount -= Node_detach(oNNode);
+      FT_reclaimLater(oNNode);
+   }
+   else
+      ulCount -= Node_free(oNNode);
+   if(ulCount == 0)
+      oNRoot = NULL;
+
+   FT_unlock();
+   return SUCCESS;
+}
+/*--------------------------------------------------------------------*/
+
+
+int FT_insertDir(const char *pcPath) {
+   int iStatus;
+
+   assert(pcPath != NULL);
+
+   FT_lock();
+   iStatus = FT_insertPath(pcPath, FALSE, NULL, 0);
+   FT_unlock();
+   return iStatus;
+}
+
 boolean FT_containsDir(const char *pcPath) {
    int iStatus;
    Node_T oNFound = NULL;
+   size_t ulDepth = 0;
 
    assert(pcPath != NULL);
-   iStatus = FT_findNode(pcPath, &oNFound);
+   iStatus = FT_findNode(pcPath, &oNFound, &ulDepth);
 
    if (oNFound != NULL)  {
-      if (Node_isFile(oNFound))
+      if (FT_isFileAt(oNFound, ulDepth))
          return FALSE;
    }
    return (boolean) (iStatus == SUCCESS);
@@ -278,144 +577,46 @@ boolean FT_containsDir(const char *pcPath) {
 int FT_rmDir(const char *pcPath) {
    int iStatus;
    Node_T oNFound = NULL;
+   size_t ulDepth = 0;
 
    assert(pcPath != NULL);
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
 
-   iStatus = FT_findNode(pcPath, &oNFound);
+   iStatus = FT_findNode(pcPath, &oNFound, &ulDepth);
 
    if(iStatus != SUCCESS)
        return iStatus;
 
-   if (Node_isFile(oNFound))
+   if (FT_isFileAt(oNFound, ulDepth))
       return NOT_A_DIRECTORY;
 
-   ulCount -= Node_free(oNFound);
-   if(ulCount == 0)
-      oNRoot = NULL;
+   iStatus = FT_removeAt(oNFound, ulDepth, bDeferRemoval);
 
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
-   return SUCCESS;
+   return iStatus;
 }
 
 int FT_insertFile(const char *pcPath, void *pvContents, size_t ulLength) {
- int iStatus;
-   Path_T oPPath = NULL;
-   Node_T oNFirstNew = NULL;
-   Node_T oNCurr = NULL;
-   size_t ulDepth, ulIndex;
-   size_t ulNewNodes = 0;
+   int iStatus;
 
    assert(pcPath != NULL);
-   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));   
-
-   /* validate pcPath and generate a Path_T for it */
-   if(!bIsInitialized)
-      return INITIALIZATION_ERROR;
-
-   iStatus = Path_new(pcPath, &oPPath);
-   if(iStatus != SUCCESS)
-      return iStatus;
-
-   /* find the closest ancestor of oPPath already in the tree */
-   iStatus = FT_traversePath(oPPath, &oNCurr);
-   if(iStatus != SUCCESS)
-   {
-      Path_free(oPPath);
-      return iStatus;
-   }
-
-   /* no ancestor node found, so if root is not NULL,
-      pcPath isn't underneath root. */
-   if(oNCurr == NULL || oNRoot == NULL) {
-      Path_free(oPPath);
-      return CONFLICTING_PATH;
-   }
-
-   
-   /* The ancestor found is a file */
-   if (Node_isFile(oNCurr)) {
-      Path_free(oPPath);
-      return NOT_A_DIRECTORY;
-   }
-
-   ulDepth = Path_getDepth(oPPath);
-   if(oNCurr == NULL) /* new root! */
-      ulIndex = 1;
-   else {
-      ulIndex = Path_getDepth(Node_getPath(oNCurr))+1;
-
-      /* oNCurr is the node we're trying to insert */
-      if(ulIndex == ulDepth+1 && !Path_comparePath(oPPath,
-                                       Node_getPath(oNCurr))) {
-         Path_free(oPPath);
-         return ALREADY_IN_TREE;
-      }
-   }
-
-   /* starting at oNCurr, build rest of the path one level at a time,
-      until reaching where the file should go */
-   while(ulIndex <= ulDepth) {
-      Path_T oPPrefix = NULL;
-      Node_T oNNewNode = NULL;
-
-      /* generate a Path_T for this level */
-      iStatus = Path_prefix(oPPath, ulIndex, &oPPrefix);
-      if(iStatus != SUCCESS) {
-         Path_free(oPPath);
-         if(oNFirstNew != NULL)
-            (void) Node_free(oNFirstNew);
-         assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
-         return iStatus;
-      }
-
-      /* insert the new node for this level */
-      /* if this is the file, create a new file node. Otherwise,
-         create a new directory node */
-      if (ulIndex == ulDepth) {
-         iStatus = Node_file_new(oPPrefix, oNCurr, &oNNewNode, 
-                                                pvContents, ulLength);
-      }
-      else {
-         iStatus = Node_dir_new(oPPrefix, oNCurr, &oNNewNode);
-      }
-      if(iStatus != SUCCESS) {
-         Path_free(oPPath);
-         Path_free(oPPrefix);
-         if(oNFirstNew != NULL)
-            (void) Node_free(oNFirstNew);
-         assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
-         return iStatus;
-      }
-
-      /* set up for next level */
-      Path_free(oPPrefix);
-      oNCurr = oNNewNode;
-      ulNewNodes++;
-      if(oNFirstNew == NULL)
-         oNFirstNew = oNCurr;
-      ulIndex++;
-   }
-   
-   Path_free(oPPath);
-   /* update FT state variables to reflect insertion */
-   if(oNRoot == NULL)
-      oNRoot = oNFirstNew;
-   ulCount += ulNewNodes;
 
-   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
-   return SUCCESS;
+   FT_lock();
+   iStatus = FT_insertPath(pcPath, TRUE, pvContents, ulLength);
+   FT_unlock();
+   return iStatus;
 }
 
 boolean FT_containsFile(const char *pcPath) {
    int iStatus;
    Node_T oNFound = NULL;
+   size_t ulDepth = 0;
 
    assert(pcPath != NULL);
-   iStatus = FT_findNode(pcPath, &oNFound);
+   iStatus = FT_findNode(pcPath, &oNFound, &ulDepth);
 
    if (oNFound != NULL)  {
-      if (!Node_isFile(oNFound))
+      if (!FT_isFileAt(oNFound, ulDepth))
          return FALSE;
    }
    return (boolean) (iStatus == SUCCESS);
@@ -424,40 +625,40 @@ boolean FT_containsFile(const char *pcPath) {
 int FT_rmFile(const char *pcPath) {
    int iStatus;
    Node_T oNFound = NULL;
+   size_t ulDepth = 0;
 
    assert(pcPath != NULL);
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
 
-   iStatus = FT_findNode(pcPath, &oNFound);
+   iStatus = FT_findNode(pcPath, &oNFound, &ulDepth);
 
    if(iStatus != SUCCESS)
        return iStatus;
 
-   if (!Node_isFile(oNFound))
+   if (!FT_isFileAt(oNFound, ulDepth))
       return NOT_A_FILE;
 
-   ulCount -= Node_free(oNFound);
-   if(ulCount == 0)
-      oNRoot = NULL;
+   iStatus = FT_removeAt(oNFound, ulDepth, FALSE);
 
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
-   return SUCCESS;
+   return iStatus;
 }
 
 void *FT_getFileContents(const char *pcPath) {
    int iStatus;
    void *pvContents;
    Node_T oNNode = NULL;
+   size_t ulDepth = 0;
 
    assert(pcPath != NULL);
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
 
-   iStatus = FT_findNode(pcPath, &oNNode);
+   iStatus = FT_findNode(pcPath, &oNNode, &ulDepth);
    
    if (iStatus != SUCCESS) 
       return NULL;
    
-   if (!Node_isFile(oNNode))
+   if (!FT_isFileAt(oNNode, ulDepth))
       return NULL;
 
    pvContents = Node_getContents(oNNode);
@@ -473,15 +674,19 @@ void *FT_replaceFileContents(const char *pcPath, void *pvNewContents,
    int iStatus;
    void *pvOldContents;
    Node_T oNNode = NULL;
+   size_t ulDepth = 0;
 
    assert(pcPath != NULL);
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
 
-   iStatus = FT_findNode(pcPath, &oNNode);
+   iStatus = FT_findNode(pcPath, &oNNode, &ulDepth);
 
    if (iStatus != SUCCESS)
       return NULL;
-   
+
+   /* a directory that oNNode stands for implicitly */
+   if (ulDepth != Path_getDepth(Node_getPath(oNNode)))
+      return NULL;
 
    pvOldContents = Node_replaceContents(oNNode, pvNewContents, ulNewLength);
 
@@ -494,17 +699,18 @@ void *FT_replaceFileContents(const char *pcPath, void *pvNewContents,
 int FT_stat(const char *pcPath, boolean *pbIsFile, size_t *pulSize) {
    int iStatus;
    Node_T oNNode = NULL;
+   size_t ulDepth = 0;
    
    assert(pcPath != NULL);
    assert(pbIsFile != NULL);
    assert(pulSize != NULL);
 
-   iStatus = FT_findNode(pcPath, &oNNode);
+   iStatus = FT_findNode(pcPath, &oNNode, &ulDepth);
    
    if (iStatus != SUCCESS)
       return iStatus;
 
-   if (Node_isFile(oNNode)) {
+   if (FT_isFileAt(oNNode, ulDepth)) {
       *pbIsFile = TRUE;
       *pulSize = Node_getFileSize(oNNode);
    }
@@ -515,15 +721,41 @@ int FT_stat(const char *pcPath, boolean *pbIsFile, size_t *pulSize) {
 
 }
 
+int FT_setCompression(boolean bCompress) {
+   if(bIsInitialized)
+      return INITIALIZATION_ERROR;
+
+   bCompressChains = bCompress;
+   return SUCCESS;
+}
+
+int FT_setDeferredRemoval(boolean bDefer) {
+   if(bIsInitialized)
+      return INITIALIZATION_ERROR;
+
+   bDeferRemoval = bDefer;
+   return SUCCESS;
+}
+
 int FT_init(void) {
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
 
    if(bIsInitialized)
       return INITIALIZATION_ERROR;
 
+   /* share one path object among the nodes and lookups of each
+      pathname */
+   Path_setHashConsing(TRUE);
+
    bIsInitialized = TRUE;
    oNRoot = NULL;
    ulCount = 0;
+   pcText = NULL;
+   ulTextLength = 0;
+   ulTextSize = 0;
+   pcSpare = NULL;
+   ulSpareSize = 0;
+   ulStringLength = 0;
 
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
    return SUCCESS;
@@ -535,10 +767,19 @@ int FT_destroy(void) {
    if(!bIsInitialized)
       return INITIALIZATION_ERROR;
 
+   FT_reclaimAll();
    if(oNRoot) {
       ulCount -= Node_free(oNRoot);
       oNRoot = NULL;
    }
+   free(pcText);
+   free(pcSpare);
+   pcText = NULL;
+   ulTextLength = 0;
+   ulTextSize = 0;
+   pcSpare = NULL;
+   ulSpareSize = 0;
+   ulStringLength = 0;
 
    bIsInitialized = FALSE;
 
@@ -546,108 +787,1808 @@ int FT_destroy(void) {
    return SUCCESS;
 }
 
-
 /* --------------------------------------------------------------------
 
-  The following auxiliary functions are used for generating the
-  string representation of the FT.
+  The following functions walk the FT, or part of it, one directory
+  or file at a time. A position in the FT is a node together with a
+  depth, which is the node's own depth or, for a directory the node
+  stands for implicitly, a smaller one.
 */
 
+/* An FT_Iter is the state of a walk. */
+struct FT_Iter {
+   /* the order of the walk */
+   enum FT_Order eOrder;
+   /* the position where the walk starts, above everything it visits */
+   Node_T oNStart;
+   size_t ulStartDepth;
+   /* the position last visited, or oNStart before the first */
+   Node_T oNCurr;
+   size_t ulCurrDepth;
+   /* the identifier of oNCurr among its parent's children, if
+      bKnowChildID */
+   size_t ulChildID;
+   boolean bKnowChildID;
+   /* whether the walk has begun, has ended, or is to skip what is
+      below oNCurr */
+   boolean bStarted;
+   boolean bEnded;
+   boolean bPruned;
+   /* for FT_LEVELORDER: the nodes at depth ulCurrDepth, of which
+      oNCurr is the ulLevelIndex'th, and those at the next depth found
+      so far; a node that stands for directories above its own depth
+      is in the level of each */
+   DynArray_T oLevel;
+   DynArray_T oNextLevel;
+   size_t ulLevelIndex;
+};
+
 /*
-  Performs a pre-order traversal of the tree rooted at oNRoot,
-  inserting each payload to DynArray_T oDynArray beginning at index ulIndex.
-  Returns the next unused index in oDynArray after the insertion(s).
+  Returns the depth of the first directory that oNNode stands for,
+  which is its own depth unless it stands for a chain.
 */
-static size_t FT_preOrderTraversal(Node_T oNRoot, DynArray_T oDynArray, 
-                                                       size_t ulIndex) {
-   size_t ulIterator;
+static size_t FT_getTopDepth(Node_T oNNode) {
+   assert(oNNode != NULL);
 
-   assert(oDynArray != NULL);
+   return Path_getDepth(Node_getPath(oNNode))
+          - Node_getEdgeDepth(oNNode) + 1;
+}
 
-   if(oNRoot != NULL) {
-      (void) DynArray_set(oDynArray, ulIndex, oNRoot);
-      ulIndex++;
-      for(ulIterator = 0; ulIterator < Node_getNumChildren(oNRoot); 
-                                                         ulIterator++) {                                                  
-         int iStatus;
-         Node_T oNChild = NULL;
-         iStatus = Node_getChild(oNRoot, ulIterator, &oNChild);
-         if(Node_isFile(oNChild))
-         {
-            assert(iStatus == SUCCESS);
-            ulIndex = FT_preOrderTraversal(oNChild, oDynArray, ulIndex);
-         }
-      }
-      for(ulIterator = 0; ulIterator < Node_getNumChildren(oNRoot); 
-                                                         ulIterator++) {                                                  
-         int iStatus;
-         Node_T oNChild = NULL;
-         iStatus = Node_getChild(oNRoot, ulIterator, &oNChild);
-         if(!Node_isFile(oNChild))
-         {
-            assert(iStatus == SUCCESS);
-            ulIndex = FT_preOrderTraversal(oNChild, oDynArray, ulIndex);
-         }
-      }
+/*
+  Fills in *psEntry to describe the position at depth ulDepth within
+  oNNode.
+*/
+static void FT_describe(Node_T oNNode, size_t ulDepth,
+                        struct FT_Entry *psEntry) {
+   Path_T oPPath;
+   size_t ulLevel;
+
+   assert(oNNode != NULL);
+   assert(psEntry != NULL);
+
+   oPPath = Node_getPath(oNNode);
+   psEntry->pcPath = Path_getPathname(oPPath);
+   if(ulDepth == Path_getDepth(oPPath))
+      psEntry->ulPathLength = Path_getStrLength(oPPath);
+   else {
+      /* a proper prefix: its components and the delimiters between
+         them */
+      psEntry->ulPathLength = ulDepth - 1;
+      for(ulLevel = 0; ulLevel < ulDepth; ulLevel++)
+         psEntry->ulPathLength +=
+            strlen(Path_getComponent(oPPath, ulLevel));
    }
-   return ulIndex;
+   psEntry->pcName = Path_getComponent(oPPath, ulDepth - 1);
+   psEntry->ulDepth = ulDepth;
+   psEntry->bIsFile = FT_isFileAt(oNNode, ulDepth);
+   psEntry->ulSize = psEntry->bIsFile ? Node_getFileSize(oNNode) : 0;
 }
 
 /*
-  Alternate version of strlen that uses pulAcc as an in-out parameter
-  to accumulate a string length, rather than returning the length of
-  oNNode's path, and also always adds one addition byte to the sum.
+  Moves the position of psIter to the ulChildID'th child of oNParent,
+  at that child's top depth.
 */
-static void FT_strlenAccumulate(Node_T oNNode, size_t *pulAcc) {
-   assert(pulAcc != NULL);
+static void FT_moveToChild(struct FT_Iter *psIter, Node_T oNParent,
+                           size_t ulChildID) {
+   Node_T oNChild = NULL;
+   int iStatus;
+
+   assert(psIter != NULL);
+   assert(oNParent != NULL);
+
+   iStatus = Node_getChild(oNParent, ulChildID, &oNChild);
+   assert(iStatus == SUCCESS);
+   (void) iStatus;
 
-   if(oNNode != NULL)
-      *pulAcc += (Path_getStrLength(Node_getPath(oNNode)) + 1);
+   psIter->oNCurr = oNChild;
+   psIter->ulCurrDepth = FT_getTopDepth(oNChild);
+   psIter->ulChildID = ulChildID;
+   psIter->bKnowChildID = TRUE;
 }
 
 /*
-  Alternate version of strcat that inverts the typical argument
-  order, appending oNNode's path onto pcAcc, and also always adds one
-  newline at the end of the concatenated string.
+  Moves the position of psIter down, through first children, as far
+  as it goes: to the first position that FT_POSTORDER visits among
+  those below it.
 */
-static void FT_strcatAccumulate(Node_T oNNode, char *pcAcc) {
-   assert(pcAcc != NULL);
-
-   if(oNNode != NULL) {
-      strcat(pcAcc, Path_getPathname(Node_getPath(oNNode)));
-      strcat(pcAcc, "\n");
+static void FT_descend(struct FT_Iter *psIter) {
+   assert(psIter != NULL);
+
+   for(;;) {
+      Path_T oPPath = Node_getPath(psIter->oNCurr);
+      if(psIter->ulCurrDepth < Path_getDepth(oPPath))
+         psIter->ulCurrDepth++;
+      else if(Node_getNumChildren(psIter->oNCurr) > 0)
+         FT_moveToChild(psIter, psIter->oNCurr, 0);
+      else
+         return;
    }
 }
-/*--------------------------------------------------------------------*/
 
-char *FT_toString(void) {
-   DynArray_T nodes;
-   size_t totalStrlen = 1;
-   char *result = NULL;
+/*
+  Moves the position of psIter, which is at a node's top depth and
+  not at the start, to the next sibling of that node and returns
+  TRUE, or returns FALSE if the node is its parent's last child,
+  leaving psIter's position unchanged.
+*/
+static boolean FT_moveToSibling(struct FT_Iter *psIter) {
+   Node_T oNParent;
+   size_t ulChildID;
 
-   if(!bIsInitialized)
-      return NULL;
+   assert(psIter != NULL);
+   assert(psIter->oNCurr != psIter->oNStart);
 
-   nodes = DynArray_new(ulCount);
-   if (nodes == NULL)
-      return NULL;
+   oNParent = Node_getParent(psIter->oNCurr);
+   assert(oNParent != NULL);
+   if(psIter->bKnowChildID)
+      ulChildID = psIter->ulChildID;
+   else {
+      boolean bFound = Node_hasChild(oNParent,
+                                     Node_getPath(psIter->oNCurr),
+                                     &ulChildID);
+      assert(bFound);
+      (void) bFound;
+   }
+
+   if(ulChildID + 1 >= Node_getNumChildren(oNParent)) {
+      psIter->ulChildID = ulChildID;
+      psIter->bKnowChildID = TRUE;
+      return FALSE;
+   }
+   FT_moveToChild(psIter, oNParent, ulChildID + 1);
+   return TRUE;
+}
+
+/*
+  Moves the position of psIter, which is at a node's top depth and
+  not at the start, to the bottom depth of the node's parent.
+*/
+static void FT_moveToParent(struct FT_Iter *psIter) {
+   assert(psIter != NULL);
+   assert(psIter->oNCurr != psIter->oNStart);
+
+   psIter->oNCurr = Node_getParent(psIter->oNCurr);
+   psIter->ulCurrDepth = Path_getDepth(Node_getPath(psIter->oNCurr));
+   psIter->bKnowChildID = FALSE;
+}
+
+/*
+  Advances psIter, walking in FT_PREORDER, to its next position.
+  Returns TRUE if there is one, or FALSE if the walk is over.
+*/
+static boolean FT_nextPreOrder(struct FT_Iter *psIter) {
+   Node_T oNCurr;
+
+   assert(psIter != NULL);
+
+   oNCurr = psIter->oNCurr;
+   if(!psIter->bPruned && !FT_isFileAt(oNCurr, psIter->ulCurrDepth)) {
+      /* go down to the directory or file below, if any */
+      if(psIter->ulCurrDepth < Path_getDepth(Node_getPath(oNCurr))) {
+         psIter->ulCurrDepth++;
+         return TRUE;
+      }
+      if(Node_getNumChildren(oNCurr) > 0) {
+         FT_moveToChild(psIter, oNCurr, 0);
+         return TRUE;
+      }
+   }
+
+   /* otherwise, to the next sibling of the nearest node on the way
+      back up that has one */
+   while(psIter->oNCurr != psIter->oNStart) {
+      if(FT_moveToSibling(psIter))
+         return TRUE;
+      FT_moveToParent(psIter);
+   }
+   return FALSE;
+}
+
+/*
+  Advances psIter, walking in FT_POSTORDER, to its next position.
+  Returns TRUE if there is one, or FALSE if the walk is over.
+*/
+static boolean FT_nextPostOrder(struct FT_Iter *psIter) {
+   assert(psIter != NULL);
+
+   if(psIter->oNCurr == psIter->oNStart &&
+      psIter->ulCurrDepth == psIter->ulStartDepth)
+      return FALSE;
+
+   /* a directory that the node stands for above this position comes
+      right after it */
+   if(psIter->ulCurrDepth > FT_getTopDepth(psIter->oNCurr)) {
+      psIter->ulCurrDepth--;
+      return TRUE;
+   }
+
+   /* then the next sibling's subtree, or else the parent */
+   if(FT_moveToSibling(psIter))
+      FT_descend(psIter);
+   else
+      FT_moveToParent(psIter);
+   return TRUE;
+}
+
+/*
+  Advances psIter, walking in FT_LEVELORDER, to its next position.
+  Returns SUCCESS if there is one, NO_SUCH_PATH if the walk is over,
+  or MEMORY_ERROR if memory could not be allocated to go on.
+*/
+static int FT_nextLevelOrder(struct FT_Iter *psIter) {
+   Node_T oNCurr;
+   DynArray_T oSwap;
+   size_t ulChildID;
+
+   assert(psIter != NULL);
+
+   /* the next level holds what is below the last position, unless
+      that is to be skipped */
+   oNCurr = psIter->oNCurr;
+   if(!psIter->bPruned && !FT_isFileAt(oNCurr, psIter->ulCurrDepth)) {
+      if(psIter->ulCurrDepth < Path_getDepth(Node_getPath(oNCurr))) {
+         if(!DynArray_add(psIter->oNextLevel, oNCurr))
+            return MEMORY_ERROR;
+      }
+      else {
+         for(ulChildID = 0; ulChildID < Node_getNumChildren(oNCurr);
+             ulChildID++) {
+            Node_T oNChild = NULL;
+            (void) Node_getChild(oNCurr, ulChildID, &oNChild);
+            if(!DynArray_add(psIter->oNextLevel, oNChild))
+               return MEMORY_ERROR;
+         }
+      }
+   }
+
+   psIter->ulLevelIndex++;
+   if(psIter->ulLevelIndex == DynArray_getLength(psIter->oLevel)) {
+      oSwap = psIter->oLevel;
+      psIter->oLevel = psIter->oNextLevel;
+      psIter->oNextLevel = oSwap;
+      DynArray_clear(psIter->oNextLevel);
+      psIter->ulLevelIndex = 0;
+      psIter->ulCurrDepth++;
+      if(DynArray_getLength(psIter->oLevel) == 0)
+         return NO_SUCH_PATH;
+   }
+   psIter->oNCurr = DynArray_get(psIter->oLevel, psIter->ulLevelIndex);
+   return SUCCESS;
+}
+
+/*
+  Sets up *psIter to walk in order eOrder over the directory or file
+  with absolute path pcPath and everything below it. Returns SUCCESS,
+  or the statuses documented for FT_iterNew otherwise. When it
+  returns SUCCESS, FT_iterDestroy must be called for psIter.
+*/
+static int FT_iterInit(struct FT_Iter *psIter, const char *pcPath,
+                       enum FT_Order eOrder) {
+   Node_T oNStart = NULL;
+   size_t ulDepth = 0;
+   int iStatus;
+
+   assert(psIter != NULL);
+   assert(pcPath != NULL);
+   assert(eOrder == FT_PREORDER || eOrder == FT_POSTORDER ||
+          eOrder == FT_LEVELORDER);
+
+   iStatus = FT_findNode(pcPath, &oNStart, &ulDepth);
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   psIter->eOrder = eOrder;
+   psIter->oNStart = oNStart;
+   psIter->ulStartDepth = ulDepth;
+   psIter->oNCurr = oNStart;
+   psIter->ulCurrDepth = ulDepth;
+   psIter->bKnowChildID = FALSE;
+   psIter->bStarted = FALSE;
+   psIter->bEnded = FALSE;
+   psIter->bPruned = FALSE;
+   psIter->oLevel = NULL;
+   psIter->oNextLevel = NULL;
+   psIter->ulLevelIndex = 0;
+
+   if(eOrder == FT_LEVELORDER) {
+      psIter->oLevel = DynArray_new(0);
+      psIter->oNextLevel = DynArray_new(0);
+      if(psIter->oLevel == NULL || psIter->oNextLevel == NULL ||
+         !DynArray_add(psIter->oLevel, oNStart)) {
+         if(psIter->oLevel != NULL)
+            DynArray_free(psIter->oLevel);
+         if(psIter->oNextLevel != NULL)
+            DynArray_free(psIter->oNextLevel);
+         return MEMORY_ERROR;
+      }
+   }
 
-   (void) FT_preOrderTraversal(oNRoot, nodes, 0);
+   return SUCCESS;
+}
+
+/*
+  Frees the memory that psIter, set up by FT_iterInit, has allocated.
+*/
+static void FT_iterDestroy(struct FT_Iter *psIter) {
+   assert(psIter != NULL);
+
+   if(psIter->oLevel != NULL)
+      DynArray_free(psIter->oLevel);
+   if(psIter->oNextLevel != NULL)
+      DynArray_free(psIter->oNextLevel);
+}
+
+int FT_iterNew(const char *pcPath, enum FT_Order eOrder,
+               FT_Iter_T *poIter) {
+   struct FT_Iter *psIter;
+   int iStatus;
+
+   assert(pcPath != NULL);
+   assert(poIter != NULL);
+
+   *poIter = NULL;
+   psIter = malloc(sizeof(struct FT_Iter));
+   if(psIter == NULL)
+      return MEMORY_ERROR;
+
+   iStatus = FT_iterInit(psIter, pcPath, eOrder);
+   if(iStatus != SUCCESS) {
+      free(psIter);
+      return iStatus;
+   }
+
+   *poIter = psIter;
+   return SUCCESS;
+}
+
+int FT_iterNext(FT_Iter_T oIter, struct FT_Entry *psEntry) {
+   int iStatus = SUCCESS;
+
+   assert(oIter != NULL);
+   assert(psEntry != NULL);
+
+   if(oIter->bEnded)
+      return NO_SUCH_PATH;
+
+   if(!oIter->bStarted) {
+      oIter->bStarted = TRUE;
+      if(oIter->eOrder == FT_POSTORDER)
+         FT_descend(oIter);
+   }
+   else if(oIter->eOrder == FT_PREORDER) {
+      if(!FT_nextPreOrder(oIter))
+         iStatus = NO_SUCH_PATH;
+   }
+   else if(oIter->eOrder == FT_POSTORDER) {
+      if(!FT_nextPostOrder(oIter))
+         iStatus = NO_SUCH_PATH;
+   }
+   else
+      iStatus = FT_nextLevelOrder(oIter);
+   oIter->bPruned = FALSE;
 
-   DynArray_map(nodes, (void (*)(void *, void*)) FT_strlenAccumulate,
-                (void*) &totalStrlen);
+   if(iStatus != SUCCESS) {
+      oIter->bEnded = TRUE;
+      return iStatus;
+   }
+
+   FT_describe(oIter->oNCurr, oIter->ulCurrDepth, psEntry);
+   return SUCCESS;
+}
+
+void FT_iterPrune(FT_Iter_T oIter) {
+   assert(oIter != NULL);
+
+   oIter->bPruned = TRUE;
+}
+
+void FT_iterFree(FT_Iter_T oIter) {
+   assert(oIter != NULL);
+
+   FT_iterDestroy(oIter);
+   free(oIter);
+}
+
+int FT_walk(const char *pcPath,
+            enum FT_Action (*pfVisit)(const struct FT_Entry *psEntry,
+                                      void *pvExtra),
+            void *pvExtra, enum FT_Order eOrder) {
+   struct FT_Iter sIter;
+   struct FT_Entry sEntry;
+   enum FT_Action eAction = FT_CONTINUE;
+   int iStatus;
+
+   assert(pcPath != NULL);
+   assert(pfVisit != NULL);
+
+   /* the walk keeps its state here rather than on the heap */
+   iStatus = FT_iterInit(&sIter, pcPath, eOrder);
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   while(eAction != FT_STOP &&
+         (iStatus = FT_iterNext(&sIter, &sEntry)) == SUCCESS) {
+      eAction = (*pfVisit)(&sEntry, pvExtra);
+      if(eAction == FT_PRUNE)
+         FT_iterPrune(&sIter);
+   }
+
+   FT_iterDestroy(&sIter);
+   if(iStatus == NO_SUCH_PATH)
+      iStatus = SUCCESS;
+   return iStatus;
+}
+
+/*
+  The children of a directory at its own depth, taken in order of
+  name from among both its files and its subdirectories, each of which
+  it keeps sorted by name, as FT_readdir lists them.
+*/
+struct FT_Children {
+   /* the directory, and its depth */
+   Node_T oNParent;
+   size_t ulDepth;
+   /* the identifiers of the next file and the next subdirectory, and
+      the numbers that they stay below */
+   size_t ulFileID;
+   size_t ulNumFiles;
+   size_t ulDirID;
+   size_t ulNumChildren;
+   /* the next file and the next subdirectory, if already found */
+   Node_T oNFile;
+   Node_T oNSubdir;
+};
+
+/*
+  Sets up *psChildren to take the children of oNParent, a directory
+  at its own depth ulDepth, from the first whose name follows pcFrom,
+  or that is pcFrom if bInclusive, or from the first of all if pcFrom
+  is NULL. pcFrom need not be interned.
+*/
+static void FT_seekChildren(struct FT_Children *psChildren,
+                            Node_T oNParent, size_t ulDepth,
+                            const char *pcFrom, boolean bInclusive) {
+   Node_T oNChild = NULL;
+
+   assert(psChildren != NULL);
+   assert(oNParent != NULL);
+
+   psChildren->oNParent = oNParent;
+   psChildren->ulDepth = ulDepth;
+   psChildren->ulNumFiles = Node_getNumFiles(oNParent);
+   psChildren->ulNumChildren = Node_getNumChildren(oNParent);
+   psChildren->oNFile = NULL;
+   psChildren->oNSubdir = NULL;
+   Node_findChildrenAfter(oNParent, pcFrom, &psChildren->ulFileID,
+                          &psChildren->ulDirID);
+   if(!bInclusive || pcFrom == NULL)
+      return;
+
+   /* a child named pcFrom is just before the first after it */
+   if(psChildren->ulFileID > 0) {
+      (void) Node_getChild(oNParent, psChildren->ulFileID - 1, &oNChild);
+      if(strcmp(Path_getComponent(Node_getPath(oNChild), ulDepth),
+                pcFrom) == 0) {
+         psChildren->ulFileID--;
+         return;
+      }
+   }
+   if(psChildren->ulDirID > psChildren->ulNumFiles) {
+      (void) Node_getChild(oNParent, psChildren->ulDirID - 1, &oNChild);
+      if(strcmp(Path_getComponent(Node_getPath(oNChild), ulDepth),
+                pcFrom) == 0)
+         psChildren->ulDirID--;
+   }
+}
+
+/*
+  Returns the next child that psChildren takes, or NULL if it has
+  taken them all.
+*/
+static Node_T FT_nextChild(struct FT_Children *psChildren) {
+   Node_T oNParent;
+   Node_T oNChild;
+   size_t ulDepth;
+
+   assert(psChildren != NULL);
+
+   oNParent = psChildren->oNParent;
+   ulDepth = psChildren->ulDepth;
+   if(psChildren->oNFile == NULL &&
+      psChildren->ulFileID < psChildren->ulNumFiles)
+      (void) Node_getChild(oNParent, psChildren->ulFileID,
+                           &psChildren->oNFile);
+   if(psChildren->oNSubdir == NULL &&
+      psChildren->ulDirID < psChildren->ulNumChildren)
+      (void) Node_getChild(oNParent, psChildren->ulDirID,
+                           &psChildren->oNSubdir);
+
+   if(psChildren->oNSubdir == NULL || (psChildren->oNFile != NULL &&
+      strcmp(Path_getComponent(Node_getPath(psChildren->oNFile),
+                               ulDepth),
+             Path_getComponent(Node_getPath(psChildren->oNSubdir),
+                               ulDepth)) < 0)) {
+      oNChild = psChildren->oNFile;
+      if(oNChild != NULL) {
+         psChildren->oNFile = NULL;
+         psChildren->ulFileID++;
+      }
+   }
+   else {
+      oNChild = psChildren->oNSubdir;
+      psChildren->oNSubdir = NULL;
+      psChildren->ulDirID++;
+   }
+   return oNChild;
+}
+
+int FT_readdir(const char *pcPath, const char *pcCursor,
+               size_t ulMaxEntries, struct FT_Entry *psEntries,
+               size_t *pulNumEntries, const char **ppcNextCursor) {
+   struct FT_Children sChildren;
+   Node_T oNDir = NULL;
+   Node_T oNChild;
+   size_t ulDepth = 0;
+   size_t ulListed = 0;
+   const char *pcName;
+   int iStatus;
+
+   assert(pcPath != NULL);
+   assert(ulMaxEntries > 0);
+   assert(psEntries != NULL);
+   assert(pulNumEntries != NULL);
+   assert(ppcNextCursor != NULL);
+
+   iStatus = FT_findNode(pcPath, &oNDir, &ulDepth);
+   if(iStatus != SUCCESS)
+      return iStatus;
+   if(FT_isFileAt(oNDir, ulDepth))
+      return NOT_A_DIRECTORY;
+
+   *pulNumEntries = 0;
+   *ppcNextCursor = NULL;
+
+   /* a directory that the node stands for above its own depth has
+      one entry, at the next depth of the same node */
+   if(ulDepth < Path_getDepth(Node_getPath(oNDir))) {
+      pcName = Path_getComponent(Node_getPath(oNDir), ulDepth);
+      if(pcCursor == NULL || strcmp(pcName, pcCursor) > 0) {
+         FT_describe(oNDir, ulDepth + 1, &psEntries[0]);
+         *pulNumEntries = 1;
+      }
+      return SUCCESS;
+   }
+
+   FT_seekChildren(&sChildren, oNDir, ulDepth, pcCursor, FALSE);
+   while((oNChild = FT_nextChild(&sChildren)) != NULL) {
+      if(ulListed == ulMaxEntries) {
+         *ppcNextCursor = psEntries[ulListed - 1].pcName;
+         break;
+      }
+      FT_describe(oNChild, ulDepth + 1, &psEntries[ulListed]);
+      ulListed++;
+   }
+
+   *pulNumEntries = ulListed;
+   return SUCCESS;
+}
+
+/* The bounds and the visitor of a walk by FT_range. */
+struct FT_Range {
+   Path_T oPStart;
+   Path_T oPEnd;
+   enum FT_Action (*pfVisit)(const struct FT_Entry *psEntry,
+                             void *pvExtra);
+   void *pvExtra;
+   /* whether pfVisit has returned FT_STOP */
+   boolean bStopped;
+};
+
+static boolean FT_rangeChild(struct FT_Range *psRange, Node_T oNChild,
+                             size_t ulDepth, const char *pcLow,
+                             const char *pcHigh);
+
+/*
+  Visits the position at depth ulDepth within oNNode, if it is in the
+  range of psRange, and then the positions below it that are, in
+  order. bLow is TRUE if the position's path is the prefix of the
+  range's start path of the same depth, and bHigh is TRUE if it is
+  that of the end path; otherwise, the position is past the start, or
+  before the end, and so is everything below it.
+  Returns FALSE if the walk has been stopped, or TRUE otherwise.
+*/
+static boolean FT_rangeFrom(struct FT_Range *psRange, Node_T oNNode,
+                            size_t ulDepth, boolean bLow,
+                            boolean bHigh) {
+   struct FT_Children sChildren;
+   struct FT_Entry sEntry;
+   const char *pcLow = NULL;
+   const char *pcHigh = NULL;
+   Node_T oNChild;
+
+   assert(psRange != NULL);
+   assert(oNNode != NULL);
+
+   if(!bLow || ulDepth >= Path_getDepth(psRange->oPStart)) {
+      FT_describe(oNNode, ulDepth, &sEntry);
+      switch((*psRange->pfVisit)(&sEntry, psRange->pvExtra)) {
+         case FT_STOP:
+            psRange->bStopped = TRUE;
+            return FALSE;
+         case FT_PRUNE:
+            return TRUE;
+         default:
+            break;
+      }
+   }
+   if(FT_isFileAt(oNNode, ulDepth))
+      return TRUE;
+
+   /* the names that bound the children's, if any */
+   if(bLow && ulDepth < Path_getDepth(psRange->oPStart))
+      pcLow = Path_getComponent(psRange->oPStart, ulDepth);
+   if(bHigh && ulDepth < Path_getDepth(psRange->oPEnd))
+      pcHigh = Path_getComponent(psRange->oPEnd, ulDepth);
+
+   /* a directory that the node stands for above its own depth has
+      one child, the next depth of the same node, which may be before
+      the lower bound (FT_rangeChild checks the upper one) */
+   if(ulDepth < Path_getDepth(Node_getPath(oNNode))) {
+      if(pcLow != NULL &&
+         strcmp(Path_getComponent(Node_getPath(oNNode), ulDepth),
+                pcLow) < 0)
+         return TRUE;
+      (void) FT_rangeChild(psRange, oNNode, ulDepth + 1, pcLow, pcHigh);
+      return !psRange->bStopped;
+   }
+
+   /* otherwise, the children from the lower bound on, until one is
+      past the upper bound */
+   FT_seekChildren(&sChildren, oNNode, ulDepth, pcLow, TRUE);
+   while((oNChild = FT_nextChild(&sChildren)) != NULL)
+      if(!FT_rangeChild(psRange, oNChild, ulDepth + 1, pcLow, pcHigh))
+         break;
+   return !psRange->bStopped;
+}
+
+/*
+  Visits, as FT_rangeFrom does, the position at depth ulDepth within
+  oNChild, whose parent's position has children bounded below by
+  pcLow and above by pcHigh, or not bounded by either that is NULL.
+  The position must not be before pcLow.
+  Returns FALSE if the walk has been stopped or the position is past
+  pcHigh, or TRUE otherwise.
+*/
+static boolean FT_rangeChild(struct FT_Range *psRange, Node_T oNChild,
+                             size_t ulDepth, const char *pcLow,
+                             const char *pcHigh) {
+   const char *pcName;
+
+   assert(psRange != NULL);
+   assert(oNChild != NULL);
+
+   /* the bounds are interned, so equal names are the same pointer */
+   pcName = Path_getComponent(Node_getPath(oNChild), ulDepth - 1);
+   assert(pcLow == NULL || strcmp(pcName, pcLow) >= 0);
+   if(pcHigh != NULL && strcmp(pcName, pcHigh) > 0)
+      return FALSE;
+   return FT_rangeFrom(psRange, oNChild, ulDepth,
+                       (boolean) (pcName == pcLow),
+                       (boolean) (pcName == pcHigh));
+}
+
+int FT_range(const char *pcStartPath, const char *pcEndPath,
+             enum FT_Action (*pfVisit)(const struct FT_Entry *psEntry,
+                                       void *pvExtra),
+             void *pvExtra) {
+   struct FT_Range sRange;
+   const char *pcRootName;
+   int iStatus;
+
+   assert(pcStartPath != NULL);
+   assert(pcEndPath != NULL);
+   assert(pfVisit != NULL);
+
+   if(!bIsInitialized)
+      return INITIALIZATION_ERROR;
+
+   FT_lock();
+   iStatus = Path_new(pcStartPath, &sRange.oPStart);
+   if(iStatus != SUCCESS) {
+      FT_unlock();
+      return iStatus;
+   }
+   iStatus = Path_new(pcEndPath, &sRange.oPEnd);
+   if(iStatus != SUCCESS) {
+      Path_free(sRange.oPStart);
+      FT_unlock();
+      return iStatus;
+   }
+   FT_unlock();
+   sRange.pfVisit = pfVisit;
+   sRange.pvExtra = pvExtra;
+   sRange.bStopped = FALSE;
+
+   if(oNRoot != NULL) {
+      pcRootName = Path_getComponent(Node_getPath(oNRoot), 0);
+      if(Path_getComponent(sRange.oPStart, 0) != pcRootName ||
+         Path_getComponent(sRange.oPEnd, 0) != pcRootName)
+         iStatus = CONFLICTING_PATH;
+      else
+         (void) FT_rangeChild(&sRange, oNRoot, 1,
+                              pcRootName, pcRootName);
+   }
+
+   FT_lock();
+   Path_free(sRange.oPStart);
+   Path_free(sRange.oPEnd);
+   FT_unlock();
+   return iStatus;
+}
+
+/* The pattern and the visitor of a walk by FT_glob. */
+struct FT_Glob {
+   Glob_T oGlob;
+   enum FT_Action (*pfVisit)(const struct FT_Entry *psEntry,
+                             void *pvExtra);
+   void *pvExtra;
+   /* whether pfVisit has returned FT_STOP */
+   boolean bStopped;
+};
+
+static boolean FT_globChild(struct FT_Glob *psGlob, Node_T oNChild,
+                            size_t ulDepth, unsigned long ulStates);
+
+/*
+  Visits the position at depth ulDepth within oNNode, if its path
+  matches the pattern of psGlob, and then the positions below it that
+  do, in order. ulStates is the pattern's set of states after the
+  position's path.
+  Returns FALSE if the walk has been stopped, or TRUE otherwise.
+*/
+static boolean FT_globFrom(struct FT_Glob *psGlob, Node_T oNNode,
+                           size_t ulDepth, unsigned long ulStates) {
+   struct FT_Children sChildren;
+   struct FT_Entry sEntry;
+   Node_T oNChild;
+   const char *pcPrefix;
+   size_t ulPrefixLength;
+   boolean bWhole;
+
+   assert(psGlob != NULL);
+   assert(oNNode != NULL);
+
+   if(Glob_accepts(psGlob->oGlob, ulStates)) {
+      FT_describe(oNNode, ulDepth, &sEntry);
+      switch((*psGlob->pfVisit)(&sEntry, psGlob->pvExtra)) {
+         case FT_STOP:
+            psGlob->bStopped = TRUE;
+            return FALSE;
+         case FT_PRUNE:
+            return TRUE;
+         default:
+            break;
+      }
+   }
+   if(FT_isFileAt(oNNode, ulDepth))
+      return TRUE;
+
+   /* nothing below matches if the pattern cannot go on, and only
+      children whose names begin with pcPrefix can */
+   pcPrefix = Glob_getPrefix(psGlob->oGlob, ulStates, &bWhole);
+   if(pcPrefix == NULL)
+      return TRUE;
+
+   /* a directory that the node stands for above its own depth has
+      one child, the next depth of the same node */
+   if(ulDepth < Path_getDepth(Node_getPath(oNNode))) {
+      (void) FT_globChild(psGlob, oNNode, ulDepth + 1, ulStates);
+      return !psGlob->bStopped;
+   }
+
+   /* otherwise, the children with that prefix are consecutive */
+   ulPrefixLength = strlen(pcPrefix);
+   FT_seekChildren(&sChildren, oNNode, ulDepth,
+                   ulPrefixLength > 0 ? pcPrefix : NULL, TRUE);
+   while((oNChild = FT_nextChild(&sChildren)) != NULL) {
+      if(strncmp(Path_getComponent(Node_getPath(oNChild), ulDepth),
+                 pcPrefix, ulPrefixLength) != 0)
+         break;
+      if(!FT_globChild(psGlob, oNChild, ulDepth + 1, ulStates) ||
+         bWhole)
+         break;
+   }
+   return !psGlob->bStopped;
+}
+
+/*
+  Visits, as FT_globFrom does, the position at depth ulDepth within
+  oNChild, whose parent's position leaves the pattern of psGlob in
+  the set of states ulStates.
+  Returns FALSE if the walk has been stopped, or TRUE otherwise.
+*/
+static boolean FT_globChild(struct FT_Glob *psGlob, Node_T oNChild,
+                            size_t ulDepth, unsigned long ulStates) {
+   assert(psGlob != NULL);
+   assert(oNChild != NULL);
+
+   ulStates = Glob_step(psGlob->oGlob, ulStates,
+                        Path_getComponent(Node_getPath(oNChild),
+                                          ulDepth - 1));
+   if(ulStates == 0)
+      return TRUE;
+   return FT_globFrom(psGlob, oNChild, ulDepth, ulStates);
+}
+
+int FT_glob(const char *pcPattern,
+            enum FT_Action (*pfVisit)(const struct FT_Entry *psEntry,
+                                      void *pvExtra),
+            void *pvExtra) {
+   struct FT_Glob sGlob;
+   int iStatus;
+
+   assert(pcPattern != NULL);
+   assert(pfVisit != NULL);
+
+   if(!bIsInitialized)
+      return INITIALIZATION_ERROR;
+
+   iStatus = Glob_new(pcPattern, &sGlob.oGlob);
+   if(iStatus != SUCCESS)
+      return iStatus;
+   sGlob.pfVisit = pfVisit;
+   sGlob.pvExtra = pvExtra;
+   sGlob.bStopped = FALSE;
+
+   if(oNRoot != NULL)
+      (void) FT_globChild(&sGlob, oNRoot, 1,
+                          Glob_start(sGlob.oGlob));
+
+   Glob_free(sGlob.oGlob);
+   return SUCCESS;
+}
+
+/* --------------------------------------------------------------------
+
+  The following functions go through the FT, or part of it, with
+  several threads. Each thread, or worker, takes a task at a time: a
+  position and everything below it, or a run of a directory's
+  children and everything below them. A worker splits the children
+  of each directory it reaches in two, while it has room to queue the
+  second half as a task for idle workers to steal, and it queues and
+  takes its own tasks at one end of its queue while others steal from
+  the other. For FT_reduceParallel, each task, and each stretch of a
+  task after a split, folds into its own segment of the result; the
+  segments are linked in the order of their entries in FT_PREORDER,
+  so they can be combined in that order at the end.
+*/
 
-   result = malloc(totalStrlen);
-   if(result == NULL) {
-      DynArray_free(nodes);
+/* The number of tasks that a worker keeps queued for others to steal,
+   at most. */
+enum { QUEUED_TASKS = 2 };
+
+/* The bytes before a segment's partial result, which keep it aligned
+   as memory from malloc is and off the cache line of the header. */
+enum { SEGMENT_HEADER_BYTES = 64 };
+
+/* A part of the result of FT_reduceParallel. */
+struct FT_Segment {
+   /* the part for the entries that come next in FT_PREORDER */
+   struct FT_Segment *psNext;
+   /* the fold of this part's entries */
+   void *pvPartial;
+};
+
+/* A piece of the work of a parallel traversal. */
+struct FT_Task {
+   /* a position, and whether the task is it and everything below it
+      or, if not, the ulLo'th through (ulHi - 1)'th children of it */
+   Node_T oNNode;
+   size_t ulDepth;
+   boolean bWhole;
+   size_t ulLo;
+   size_t ulHi;
+   /* the segment that the task folds into, or NULL if there is no
+      result */
+   struct FT_Segment *psSegment;
+};
+
+struct FT_Traversal;
+
+/* A thread of a parallel traversal. */
+struct FT_Worker {
+   struct FT_Traversal *psTraversal;
+   size_t ulIndex;
+   /* the queued tasks, asTasks[(ulFirst + i) % QUEUED_TASKS] for i
+      below ulQueued, guarded by sMutex; the worker itself queues and
+      takes them last in, first out, and others steal the first */
+   pthread_mutex_t sMutex;
+   struct FT_Task asTasks[QUEUED_TASKS];
+   size_t ulFirst;
+   size_t ulQueued;
+   /* the segment that the worker folds into now, or NULL if there is
+      no result */
+   struct FT_Segment *psSegment;
+};
+
+/* The state that the workers of a parallel traversal share. */
+struct FT_Traversal {
+   /* the function to call for each entry, with pvExtra or, if there
+      is a result, with the partial result of the current segment */
+   void (*pfVisit)(const struct FT_Entry *psEntry, void *pvExtra);
+   void *pvExtra;
+   /* the size of the result, or 0 if there is none, and a copy of
+      its initial value */
+   size_t ulAccumulatorSize;
+   const void *pvIdentity;
+   /* the workers, and the threads of all but the first */
+   struct FT_Worker *psWorkers;
+   size_t ulWorkers;
+   pthread_t *paThreads;
+   /* the number of tasks queued or running, the number of those
+      queued, and a condition signalled when either changes so that
+      idle workers may find a task or finish, guarded by sMutex */
+   pthread_mutex_t sMutex;
+   pthread_cond_t sChanged;
+   size_t ulUnfinished;
+   size_t ulQueued;
+};
+
+static void FT_parVisitChildren(struct FT_Worker *psWorker,
+                                Node_T oNNode, size_t ulDepth,
+                                size_t ulLo, size_t ulHi);
+static void FT_parFreeWorkers(struct FT_Traversal *psTraversal);
+
+/*
+  Returns a new segment for the result of psTraversal, holding the
+  result's initial value, or NULL if memory could not be allocated.
+*/
+static struct FT_Segment *FT_parNewSegment(
+   struct FT_Traversal *psTraversal) {
+   struct FT_Segment *psSegment;
+
+   assert(psTraversal != NULL);
+
+   psSegment = malloc(SEGMENT_HEADER_BYTES +
+                      psTraversal->ulAccumulatorSize);
+   if(psSegment == NULL)
       return NULL;
+   psSegment->psNext = NULL;
+   psSegment->pvPartial = (char *) psSegment + SEGMENT_HEADER_BYTES;
+   memcpy(psSegment->pvPartial, psTraversal->pvIdentity,
+          psTraversal->ulAccumulatorSize);
+   return psSegment;
+}
+
+/*
+  Queues for psWorker the task of the ulLo'th through (ulHi - 1)'th
+  children of the position at depth ulDepth within oNNode, if it has
+  room. If there is a result, stores in *ppsAfter the segment that
+  psWorker is to go on with after the children before the ulLo'th,
+  which follows the task's.
+  Returns TRUE if the task was queued, or FALSE if there was no room
+  or no memory for the segments.
+*/
+static boolean FT_parSplit(struct FT_Worker *psWorker, Node_T oNNode,
+                           size_t ulDepth, size_t ulLo, size_t ulHi,
+                           struct FT_Segment **ppsAfter) {
+   struct FT_Traversal *psTraversal;
+   struct FT_Task *psTask;
+   struct FT_Segment *psTaskSegment = NULL;
+   boolean bFull;
+
+   assert(psWorker != NULL);
+   assert(oNNode != NULL);
+   assert(ppsAfter != NULL);
+
+   psTraversal = psWorker->psTraversal;
+   *ppsAfter = NULL;
+
+   /* only the worker itself adds to its queue */
+   (void) pthread_mutex_lock(&psWorker->sMutex);
+   bFull = (boolean) (psWorker->ulQueued == QUEUED_TASKS);
+   (void) pthread_mutex_unlock(&psWorker->sMutex);
+   if(bFull)
+      return FALSE;
+
+   if(psWorker->psSegment != NULL) {
+      psTaskSegment = FT_parNewSegment(psTraversal);
+      *ppsAfter = FT_parNewSegment(psTraversal);
+      if(psTaskSegment == NULL || *ppsAfter == NULL) {
+         free(psTaskSegment);
+         free(*ppsAfter);
+         *ppsAfter = NULL;
+         return FALSE;
+      }
+      (*ppsAfter)->psNext = psWorker->psSegment->psNext;
+      psTaskSegment->psNext = *ppsAfter;
+      psWorker->psSegment->psNext = psTaskSegment;
+   }
+
+   /* the task is counted before any other worker can steal it */
+   (void) pthread_mutex_lock(&psWorker->sMutex);
+   psTask = &psWorker->asTasks[(psWorker->ulFirst + psWorker->ulQueued)
+                               % QUEUED_TASKS];
+   psTask->oNNode = oNNode;
+   psTask->ulDepth = ulDepth;
+   psTask->bWhole = FALSE;
+   psTask->ulLo = ulLo;
+   psTask->ulHi = ulHi;
+   psTask->psSegment = psTaskSegment;
+   psWorker->ulQueued++;
+   (void) pthread_mutex_lock(&psTraversal->sMutex);
+   psTraversal->ulUnfinished++;
+   psTraversal->ulQueued++;
+   (void) pthread_cond_signal(&psTraversal->sChanged);
+   (void) pthread_mutex_unlock(&psTraversal->sMutex);
+   (void) pthread_mutex_unlock(&psWorker->sMutex);
+
+   return TRUE;
+}
+
+/*
+  Takes a task for psWorker into *psTask: the last that it queued, or
+  else the first that another worker queued. Returns TRUE if there
+  was one, or FALSE otherwise.
+*/
+static boolean FT_parTake(struct FT_Worker *psWorker,
+                          struct FT_Task *psTask) {
+   struct FT_Traversal *psTraversal;
+   struct FT_Worker *psVictim;
+   boolean bFound = FALSE;
+   size_t ulOffset;
+
+   assert(psWorker != NULL);
+   assert(psTask != NULL);
+
+   psTraversal = psWorker->psTraversal;
+
+   (void) pthread_mutex_lock(&psWorker->sMutex);
+   if(psWorker->ulQueued > 0) {
+      psWorker->ulQueued--;
+      *psTask = psWorker->asTasks[(psWorker->ulFirst +
+                                   psWorker->ulQueued) % QUEUED_TASKS];
+      bFound = TRUE;
+   }
+   (void) pthread_mutex_unlock(&psWorker->sMutex);
+
+   for(ulOffset = 1; !bFound && ulOffset < psTraversal->ulWorkers;
+       ulOffset++) {
+      psVictim = &psTraversal->psWorkers[(psWorker->ulIndex + ulOffset)
+                                         % psTraversal->ulWorkers];
+      (void) pthread_mutex_lock(&psVictim->sMutex);
+      if(psVictim->ulQueued > 0) {
+         *psTask = psVictim->asTasks[psVictim->ulFirst];
+         psVictim->ulFirst = (psVictim->ulFirst + 1) % QUEUED_TASKS;
+         psVictim->ulQueued--;
+         bFound = TRUE;
+      }
+      (void) pthread_mutex_unlock(&psVictim->sMutex);
+   }
+
+   if(bFound) {
+      (void) pthread_mutex_lock(&psTraversal->sMutex);
+      psTraversal->ulQueued--;
+      (void) pthread_mutex_unlock(&psTraversal->sMutex);
+   }
+   return bFound;
+}
+
+/*
+  Visits, for psWorker, the position at depth ulDepth within oNNode
+  and everything below it.
+*/
+static void FT_parVisitPosition(struct FT_Worker *psWorker,
+                                Node_T oNNode, size_t ulDepth) {
+   struct FT_Traversal *psTraversal;
+   struct FT_Entry sEntry;
+
+   assert(psWorker != NULL);
+   assert(oNNode != NULL);
+
+   psTraversal = psWorker->psTraversal;
+   for(;;) {
+      FT_describe(oNNode, ulDepth, &sEntry);
+      (*psTraversal->pfVisit)(&sEntry, psWorker->psSegment != NULL ?
+                              psWorker->psSegment->pvPartial :
+                              psTraversal->pvExtra);
+      if(FT_isFileAt(oNNode, ulDepth))
+         return;
+      if(ulDepth == Path_getDepth(Node_getPath(oNNode)))
+         break;
+      /* the directory below, which the node also stands for */
+      ulDepth++;
+   }
+   FT_parVisitChildren(psWorker, oNNode, ulDepth, 0,
+                       Node_getNumChildren(oNNode));
+}
+
+/*
+  Visits, for psWorker, the ulLo'th through (ulHi - 1)'th children of
+  oNNode, a directory at its own depth ulDepth, and everything below
+  them, queuing the second half of them as a task if it can.
+*/
+static void FT_parVisitChildren(struct FT_Worker *psWorker,
+                                Node_T oNNode, size_t ulDepth,
+                                size_t ulLo, size_t ulHi) {
+   struct FT_Segment *psAfter = NULL;
+   boolean bSplit = FALSE;
+   size_t ulChildID;
+
+   assert(psWorker != NULL);
+   assert(oNNode != NULL);
+
+   if(ulHi - ulLo >= 2 && psWorker->psTraversal->ulWorkers > 1) {
+      bSplit = FT_parSplit(psWorker, oNNode, ulDepth,
+                           ulLo + (ulHi - ulLo) / 2, ulHi, &psAfter);
+      if(bSplit)
+         ulHi = ulLo + (ulHi - ulLo) / 2;
+   }
+
+   for(ulChildID = ulLo; ulChildID < ulHi; ulChildID++) {
+      Node_T oNChild = NULL;
+      (void) Node_getChild(oNNode, ulChildID, &oNChild);
+      FT_parVisitPosition(psWorker, oNChild, FT_getTopDepth(oNChild));
+   }
+
+   /* what comes next follows the queued task */
+   if(psAfter != NULL)
+      psWorker->psSegment = psAfter;
+}
+
+/*
+  Takes and performs tasks for the FT_Worker pvWorker until none are
+  left. Returns NULL.
+*/
+static void *FT_parRunWorker(void *pvWorker) {
+   struct FT_Worker *psWorker = pvWorker;
+   struct FT_Traversal *psTraversal;
+   struct FT_Task sTask;
+   boolean bDone;
+
+   assert(psWorker != NULL);
+
+   psTraversal = psWorker->psTraversal;
+   for(;;) {
+      if(!FT_parTake(psWorker, &sTask)) {
+         (void) pthread_mutex_lock(&psTraversal->sMutex);
+         while(psTraversal->ulQueued == 0 &&
+               psTraversal->ulUnfinished > 0)
+            (void) pthread_cond_wait(&psTraversal->sChanged,
+                                     &psTraversal->sMutex);
+         bDone = (boolean) (psTraversal->ulUnfinished == 0);
+         (void) pthread_mutex_unlock(&psTraversal->sMutex);
+         if(bDone)
+            return NULL;
+         continue;
+      }
+
+      psWorker->psSegment = sTask.psSegment;
+      if(sTask.bWhole)
+         FT_parVisitPosition(psWorker, sTask.oNNode, sTask.ulDepth);
+      else
+         FT_parVisitChildren(psWorker, sTask.oNNode, sTask.ulDepth,
+                             sTask.ulLo, sTask.ulHi);
+
+      (void) pthread_mutex_lock(&psTraversal->sMutex);
+      psTraversal->ulUnfinished--;
+      if(psTraversal->ulUnfinished == 0)
+         (void) pthread_cond_broadcast(&psTraversal->sChanged);
+      (void) pthread_mutex_unlock(&psTraversal->sMutex);
+   }
+}
+
+/*
+  Gives psTraversal up to ulThreads workers, with the memory and the
+  locks that they need. Returns how many, or 0 if there cannot be at
+  least two.
+*/
+static size_t FT_parNewWorkers(struct FT_Traversal *psTraversal,
+                               size_t ulThreads) {
+   size_t u;
+
+   assert(psTraversal != NULL);
+
+   /* no more workers than nodes, as DynArray_mapParallel uses no more
+      threads than elements, and none if the sizes of the arrays below
+      would overflow */
+   if(ulThreads > ulCount)
+      ulThreads = ulCount;
+   if(ulThreads < 2 ||
+      ulThreads > (size_t) -1 / sizeof(struct FT_Worker) ||
+      ulThreads > (size_t) -1 / sizeof(pthread_t))
+      return 0;
+
+   psTraversal->psWorkers = malloc(sizeof(struct FT_Worker) * ulThreads);
+   psTraversal->paThreads = malloc(sizeof(pthread_t) * ulThreads);
+   if(psTraversal->psWorkers == NULL || psTraversal->paThreads == NULL) {
+      free(psTraversal->psWorkers);
+      free(psTraversal->paThreads);
+      return 0;
+   }
+   if(pthread_mutex_init(&psTraversal->sMutex, NULL) != 0) {
+      free(psTraversal->psWorkers);
+      free(psTraversal->paThreads);
+      return 0;
+   }
+   if(pthread_cond_init(&psTraversal->sChanged, NULL) != 0) {
+      (void) pthread_mutex_destroy(&psTraversal->sMutex);
+      free(psTraversal->psWorkers);
+      free(psTraversal->paThreads);
+      return 0;
+   }
+
+   for(u = 0; u < ulThreads; u++)
+      if(pthread_mutex_init(&psTraversal->psWorkers[u].sMutex,
+                            NULL) != 0)
+         break;
+   psTraversal->ulWorkers = u;
+   if(u < 2) {
+      FT_parFreeWorkers(psTraversal);
+      return 0;
+   }
+   return u;
+}
+
+/*
+  Frees the workers of psTraversal, given by FT_parNewWorkers.
+*/
+static void FT_parFreeWorkers(struct FT_Traversal *psTraversal) {
+   size_t u;
+
+   assert(psTraversal != NULL);
+
+   for(u = 0; u < psTraversal->ulWorkers; u++)
+      (void) pthread_mutex_destroy(&psTraversal->psWorkers[u].sMutex);
+   (void) pthread_cond_destroy(&psTraversal->sChanged);
+   (void) pthread_mutex_destroy(&psTraversal->sMutex);
+   free(psTraversal->psWorkers);
+   free(psTraversal->paThreads);
+}
+
+/*
+  Performs psTraversal, of the position at depth ulDepth within
+  oNStart and everything below it, with up to ulThreads workers, the
+  first of which starts with the segment psHead (or NULL if there is
+  no result). If threads or memory cannot be obtained, uses fewer
+  workers.
+*/
+static void FT_parTraverse(struct FT_Traversal *psTraversal,
+                           Node_T oNStart, size_t ulDepth,
+                           struct FT_Segment *psHead,
+                           size_t ulThreads) {
+   struct FT_Worker sSerial;
+   struct FT_Worker *psWorkers;
+   size_t ulWorkers = 0;
+   size_t ulStarted;
+   size_t u;
+
+   assert(psTraversal != NULL);
+   assert(oNStart != NULL);
+
+   if(ulThreads >= 2)
+      ulWorkers = FT_parNewWorkers(psTraversal, ulThreads);
+
+   /* one worker needs no queue */
+   if(ulWorkers == 0) {
+      psTraversal->psWorkers = &sSerial;
+      psTraversal->ulWorkers = 1;
+      sSerial.psTraversal = psTraversal;
+      sSerial.ulIndex = 0;
+      sSerial.psSegment = psHead;
+      FT_parVisitPosition(&sSerial, oNStart, ulDepth);
+      return;
+   }
+
+   psWorkers = psTraversal->psWorkers;
+   for(u = 0; u < ulWorkers; u++) {
+      psWorkers[u].psTraversal = psTraversal;
+      psWorkers[u].ulIndex = u;
+      psWorkers[u].ulFirst = 0;
+      psWorkers[u].ulQueued = 0;
+      psWorkers[u].psSegment = NULL;
+   }
+   psWorkers[0].asTasks[0].oNNode = oNStart;
+   psWorkers[0].asTasks[0].ulDepth = ulDepth;
+   psWorkers[0].asTasks[0].bWhole = TRUE;
+   psWorkers[0].asTasks[0].psSegment = psHead;
+   psWorkers[0].ulQueued = 1;
+   psTraversal->ulUnfinished = 1;
+   psTraversal->ulQueued = 1;
+
+   /* the calling thread is the first worker; workers whose threads
+      cannot be created just have nothing to steal from them */
+   for(ulStarted = 1; ulStarted < ulWorkers; ulStarted++)
+      if(pthread_create(&psTraversal->paThreads[ulStarted], NULL,
+                        FT_parRunWorker, &psWorkers[ulStarted]) != 0)
+         break;
+   (void) FT_parRunWorker(&psWorkers[0]);
+   for(u = 1; u < ulStarted; u++)
+      (void) pthread_join(psTraversal->paThreads[u], NULL);
+
+   FT_parFreeWorkers(psTraversal);
+}
+
+int FT_mapParallel(const char *pcPath,
+                   void (*pfVisit)(const struct FT_Entry *psEntry,
+                                   void *pvExtra),
+                   void *pvExtra, size_t ulThreads) {
+   struct FT_Traversal sTraversal;
+   Node_T oNStart = NULL;
+   size_t ulDepth = 0;
+   int iStatus;
+
+   assert(pcPath != NULL);
+   assert(pfVisit != NULL);
+
+   iStatus = FT_findNode(pcPath, &oNStart, &ulDepth);
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   sTraversal.pfVisit = pfVisit;
+   sTraversal.pvExtra = pvExtra;
+   sTraversal.ulAccumulatorSize = 0;
+   sTraversal.pvIdentity = NULL;
+   FT_parTraverse(&sTraversal, oNStart, ulDepth, NULL, ulThreads);
+   return SUCCESS;
+}
+
+int FT_reduceParallel(const char *pcPath,
+                      void (*pfApply)(const struct FT_Entry *psEntry,
+                                      void *pvAccumulator),
+                      void (*pfCombine)(void *pvAccumulator,
+                                        void *pvPartial),
+                      void *pvAccumulator, size_t ulAccumulatorSize,
+                      size_t ulThreads) {
+   struct FT_Traversal sTraversal;
+   struct FT_Segment sHead;
+   struct FT_Segment *psSegment;
+   void *pvIdentity;
+   Node_T oNStart = NULL;
+   size_t ulDepth = 0;
+   int iStatus;
+
+   assert(pcPath != NULL);
+   assert(pfApply != NULL);
+   assert(pfCombine != NULL);
+   assert(pvAccumulator != NULL);
+
+   iStatus = FT_findNode(pcPath, &oNStart, &ulDepth);
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   /* new segments start from the initial value, which the first
+      segment, the caller's, soon leaves */
+   pvIdentity = malloc(ulAccumulatorSize);
+   if(pvIdentity == NULL)
+      return MEMORY_ERROR;
+   memcpy(pvIdentity, pvAccumulator, ulAccumulatorSize);
+
+   sTraversal.pfVisit = pfApply;
+   sTraversal.pvExtra = NULL;
+   sTraversal.ulAccumulatorSize = ulAccumulatorSize;
+   sTraversal.pvIdentity = pvIdentity;
+   sHead.psNext = NULL;
+   sHead.pvPartial = pvAccumulator;
+   FT_parTraverse(&sTraversal, oNStart, ulDepth, &sHead, ulThreads);
+
+   while(sHead.psNext != NULL) {
+      psSegment = sHead.psNext;
+      (*pfCombine)(pvAccumulator, psSegment->pvPartial);
+      sHead.psNext = psSegment->psNext;
+      free(psSegment);
+   }
+   free(pvIdentity);
+   return SUCCESS;
+}
+
+
+/* --------------------------------------------------------------------
+
+  The following auxiliary functions are used for generating the
+  string representation of the FT. The last one generated is kept,
+  and only the lines of subtrees that have changed since are written
+  anew; the rest are copied from where they were in it. The next one
+  is generated in a second buffer, and the two then trade places, so
+  that neither needs to be allocated again until the representation
+  outgrows it.
+*/
+
+/*
+  Writes oNNode's own lines to pcOut, each directory it stands for
+  first, in order. Returns the number of characters written.
+*/
+static size_t FT_writeLines(Node_T oNNode, char *pcOut) {
+   const char *pcPath;
+   size_t ulTop;
+   size_t ulLevel = 1;
+   size_t ulWritten = 0;
+   size_t i;
+
+   assert(oNNode != NULL);
+   assert(pcOut != NULL);
+
+   pcPath = Path_getPathname(Node_getPath(oNNode));
+   ulTop = FT_getTopDepth(oNNode);
+   for(i = 0; pcPath[i] != '\0'; i++) {
+      if(pcPath[i] == '/') {
+         if(ulLevel >= ulTop) {
+            memcpy(pcOut + ulWritten, pcPath, i);
+            ulWritten += i;
+            pcOut[ulWritten++] = '\n';
+         }
+         ulLevel++;
+      }
+   }
+   memcpy(pcOut + ulWritten, pcPath, i);
+   ulWritten += i;
+   pcOut[ulWritten++] = '\n';
+   return ulWritten;
+}
+
+/*
+  Writes the lines of the subtree rooted at oNNode, which are out of
+  date, to pcOut, and
+  marks the subtree's nodes as up to date. The lines of a child whose
+  are still up to date are copied from where they are in pcText, the
+  lines of the subtree having begun ulOldOffset characters in. The
+  rest are written anew, in pre-order with files first.
+*/
+static void FT_writeText(Node_T oNNode, size_t ulOldOffset,
+                         char *pcOut) {
+   size_t ulLines;
+   size_t ulWritten;
+   size_t ulOffset, ulLength;
+   size_t ulIndex;
+   Node_T oNChild = NULL;
+
+   assert(oNNode != NULL);
+   assert(pcOut != NULL);
+
+   /* a node's own lines are as long as they were, so its children's
+      began where they end */
+   ulLines = FT_writeLines(oNNode, pcOut);
+   ulOldOffset += ulLines;
+   ulWritten = ulLines;
+   for(ulIndex = 0; ulIndex < Node_getNumChildren(oNNode); ulIndex++) {
+      int iStatus = Node_getChild(oNNode, ulIndex, &oNChild);
+      assert(iStatus == SUCCESS);
+      (void) iStatus;
+      if(Node_getText(oNChild, &ulOffset, &ulLength))
+         memcpy(pcOut + ulWritten, pcText + ulOldOffset + ulOffset,
+                ulLength);
+      else
+         FT_writeText(oNChild, ulOldOffset + ulOffset,
+                      pcOut + ulWritten);
+      Node_setTextOffset(oNChild, ulWritten - ulLines);
+      ulWritten += ulLength;
    }
-   *result = '\0';
+}
 
-   DynArray_map(nodes, (void (*)(void *, void*)) FT_strcatAccumulate,
-                (void *) result);
+/*
+  Brings pcText up to date with the FT, regenerating only the lines
+  of subtrees that have changed since it was last generated. Returns
+  SUCCESS, or MEMORY_ERROR if memory could not be allocated, in which
+  case pcText is unchanged.
+*/
+static int FT_updateText(void) {
+   size_t ulOffset, ulLength;
+   size_t ulSize;
+   char *pcBuffer;
 
-   DynArray_free(nodes);
+   if(oNRoot == NULL) {
+      ulTextLength = 0;
+      return SUCCESS;
+   }
+   if(Node_getText(oNRoot, &ulOffset, &ulLength) && pcText != NULL)
+      return SUCCESS;
+   assert(ulLength == ulStringLength);
+
+   /* leave room for the representation to grow by an eighth */
+   if(ulSpareSize < ulLength) {
+      ulSize = ulLength + ulLength / 8;
+      pcBuffer = malloc(ulSize);
+      if(pcBuffer == NULL)
+         return MEMORY_ERROR;
+      free(pcSpare);
+      pcSpare = pcBuffer;
+      ulSpareSize = ulSize;
+   }
+
+   /* the root's lines begin at the start, as they did last time */
+   FT_writeText(oNRoot, 0, pcSpare);
+   Node_setTextOffset(oNRoot, 0);
+
+   pcBuffer = pcText;
+   ulSize = ulTextSize;
+   pcText = pcSpare;
+   ulTextSize = ulSpareSize;
+   ulTextLength = ulLength;
+   pcSpare = pcBuffer;
+   ulSpareSize = ulSize;
+   return SUCCESS;
+}
+/*--------------------------------------------------------------------*/
+
+char *FT_toString(void) {
+   char *result = NULL;
+
+   if(!bIsInitialized)
+      return NULL;
+
+   if(FT_updateText() != SUCCESS)
+      return NULL;
+
+   result = malloc(ulTextLength + 1);
+   if(result == NULL)
+      return NULL;
+   if(pcText != NULL)
+      memcpy(result, pcText, ulTextLength);
+   result[ulTextLength] = '\0';
 
    return result;
 }
+
+size_t FT_toStringLength(void) {
+   if(!bIsInitialized)
+      return 0;
+
+   return ulStringLength;
+}
+
+int FT_toStringInto(char *pcBuffer, size_t ulCapacity) {
+   int iStatus;
+
+   assert(pcBuffer != NULL || ulCapacity == 0);
+
+   if(!bIsInitialized)
+      return INITIALIZATION_ERROR;
+
+   if(ulCapacity <= ulStringLength)
+      return BUFFER_TOO_SMALL;
+
+   iStatus = FT_updateText();
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   if(pcText != NULL)
+      memcpy(pcBuffer, pcText, ulTextLength);
+   pcBuffer[ulTextLength] = '\0';
+   return SUCCESS;
+}
+
+/* --------------------------------------------------------------------
+
+  The following functions generate the string representation of the
+  FT with several threads, through the traversal above. Each segment
+  of it is a run of lines in its own buffer; once all are done, the
+  buffers are joined or written out in the order of the segments.
+*/
+
+/* The bytes that a run of lines first has room for. */
+enum { TEXT_INITIAL_BYTES = 4096 };
+
+/* The most buffers that one call to writev is given: the least
+   IOV_MAX that POSIX allows. */
+enum { TEXT_BUFFERS_PER_WRITE = 16 };
+
+/* A run of lines of the string representation of the FT. */
+struct FT_Text {
+   /* the lines, each ending in a newline, with no '\0' after them */
+   char *pcLines;
+   size_t ulLength;
+   size_t ulCapacity;
+   /* whether a line was left out for lack of memory */
+   boolean bFailed;
+};
+
+/*
+  Appends the line for the entry *psEntry to the run of lines
+  pvText, or marks the run as failed if it cannot grow.
+*/
+static void FT_textAppend(const struct FT_Entry *psEntry,
+                          void *pvText) {
+   struct FT_Text *psText = pvText;
+   size_t ulNeeded;
+   size_t ulCapacity;
+   char *pcLines;
+
+   assert(psEntry != NULL);
+   assert(psText != NULL);
+
+   if(psText->bFailed)
+      return;
+
+   ulNeeded = psText->ulLength + psEntry->ulPathLength + 1;
+   if(ulNeeded > psText->ulCapacity) {
+      ulCapacity = psText->ulCapacity;
+      if(ulCapacity == 0)
+         ulCapacity = TEXT_INITIAL_BYTES;
+      while(ulCapacity < ulNeeded)
+         ulCapacity *= 2;
+      pcLines = realloc(psText->pcLines, ulCapacity);
+      if(pcLines == NULL) {
+         psText->bFailed = TRUE;
+         return;
+      }
+      psText->pcLines = pcLines;
+      psText->ulCapacity = ulCapacity;
+   }
+
+   memcpy(psText->pcLines + psText->ulLength, psEntry->pcPath,
+          psEntry->ulPathLength);
+   psText->ulLength += psEntry->ulPathLength;
+   psText->pcLines[psText->ulLength++] = '\n';
+}
+
+/*
+  Frees the lines of the segments from psHead on, and the segments
+  after psHead.
+*/
+static void FT_textFree(struct FT_Segment *psHead) {
+   struct FT_Segment *psSegment;
+
+   assert(psHead != NULL);
+
+   free(((struct FT_Text *) psHead->pvPartial)->pcLines);
+   while(psHead->psNext != NULL) {
+      psSegment = psHead->psNext;
+      free(((struct FT_Text *) psSegment->pvPartial)->pcLines);
+      psHead->psNext = psSegment->psNext;
+      free(psSegment);
+   }
+}
+
+/*
+  Generates the lines of the string representation of the FT with up
+  to ulThreads threads, into segments from psHead on, the first of
+  which holds its lines in *psFirst, and stores their total length in
+  *pulLength. Returns SUCCESS, or MEMORY_ERROR if memory could not be
+  allocated, in which case the segments hold no lines.
+*/
+static int FT_textGenerate(size_t ulThreads, struct FT_Segment *psHead,
+                           struct FT_Text *psFirst, size_t *pulLength) {
+   struct FT_Traversal sTraversal;
+   struct FT_Text sEmpty;
+   struct FT_Segment *psSegment;
+   boolean bFailed = FALSE;
+
+   assert(psHead != NULL);
+   assert(psFirst != NULL);
+   assert(pulLength != NULL);
+
+   sEmpty.pcLines = NULL;
+   sEmpty.ulLength = 0;
+   sEmpty.ulCapacity = 0;
+   sEmpty.bFailed = FALSE;
+   *psFirst = sEmpty;
+   psHead->psNext = NULL;
+   psHead->pvPartial = psFirst;
+   *pulLength = 0;
+   if(oNRoot == NULL)
+      return SUCCESS;
+
+   sTraversal.pfVisit = FT_textAppend;
+   sTraversal.pvExtra = NULL;
+   sTraversal.ulAccumulatorSize = sizeof(struct FT_Text);
+   sTraversal.pvIdentity = &sEmpty;
+   FT_parTraverse(&sTraversal, oNRoot, FT_getTopDepth(oNRoot), psHead,
+                  ulThreads);
+
+   for(psSegment = psHead; psSegment != NULL;
+       psSegment = psSegment->psNext) {
+      *pulLength += ((struct FT_Text *) psSegment->pvPartial)->ulLength;
+      if(((struct FT_Text *) psSegment->pvPartial)->bFailed)
+         bFailed = TRUE;
+   }
+   if(bFailed) {
+      FT_textFree(psHead);
+      *psFirst = sEmpty;
+      *pulLength = 0;
+      return MEMORY_ERROR;
+   }
+   return SUCCESS;
+}
+
+char *FT_toStringParallel(size_t ulThreads) {
+   struct FT_Segment sHead;
+   struct FT_Segment *psSegment;
+   struct FT_Text sFirst;
+   struct FT_Text *psText;
+   size_t ulLength;
+   size_t ulOffset = 0;
+   char *pcResult;
+
+   if(!bIsInitialized)
+      return NULL;
+
+   if(FT_textGenerate(ulThreads, &sHead, &sFirst, &ulLength) != SUCCESS)
+      return NULL;
+
+   pcResult = malloc(ulLength + 1);
+   if(pcResult != NULL) {
+      for(psSegment = &sHead; psSegment != NULL;
+          psSegment = psSegment->psNext) {
+         psText = psSegment->pvPartial;
+         if(psText->ulLength == 0)
+            continue;
+         memcpy(pcResult + ulOffset, psText->pcLines, psText->ulLength);
+         ulOffset += psText->ulLength;
+      }
+      pcResult[ulOffset] = '\0';
+   }
+
+   FT_textFree(&sHead);
+   return pcResult;
+}
+
+int FT_writeTo(int iFd, size_t ulThreads) {
+   struct FT_Segment sHead;
+   struct FT_Segment *psSegment;
+   struct FT_Text sFirst;
+   struct FT_Text *psText;
+   struct iovec *psBuffers;
+   size_t ulBuffers = 0;
+   size_t ulFirst = 0;
+   size_t ulBatch;
+   size_t ulLength;
+   ssize_t lWritten;
+   int iStatus;
+
+   if(!bIsInitialized)
+      return INITIALIZATION_ERROR;
+
+   iStatus = FT_textGenerate(ulThreads, &sHead, &sFirst, &ulLength);
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   for(psSegment = &sHead; psSegment != NULL;
+       psSegment = psSegment->psNext)
+      ulBuffers++;
+   psBuffers = malloc(ulBuffers * sizeof(struct iovec));
+   if(psBuffers == NULL) {
+      FT_textFree(&sHead);
+      return MEMORY_ERROR;
+   }
+
+   /* one buffer for each segment that has lines */
+   ulBuffers = 0;
+   for(psSegment = &sHead; psSegment != NULL;
+       psSegment = psSegment->psNext) {
+      psText = psSegment->pvPartial;
+      if(psText->ulLength == 0)
+         continue;
+      psBuffers[ulBuffers].iov_base = psText->pcLines;
+      psBuffers[ulBuffers].iov_len = psText->ulLength;
+      ulBuffers++;
+   }
+
+   while(ulFirst < ulBuffers) {
+      ulBatch = ulBuffers - ulFirst;
+      if(ulBatch > TEXT_BUFFERS_PER_WRITE)
+         ulBatch = TEXT_BUFFERS_PER_WRITE;
+      lWritten = writev(iFd, &psBuffers[ulFirst], (int) ulBatch);
+      if(lWritten < 0 && errno == EINTR)
+         continue;
+      if(lWritten <= 0) {
+         iStatus = WRITE_ERROR;
+         break;
+      }
+
+      /* skip what was written, which may end within a buffer */
+      while(ulFirst < ulBuffers &&
+            (size_t) lWritten >= psBuffers[ulFirst].iov_len) {
+         lWritten -= (ssize_t) psBuffers[ulFirst].iov_len;
+         ulFirst++;
+      }
+      if(lWritten > 0) {
+         psBuffers[ulFirst].iov_base =
+            (char *) psBuffers[ulFirst].iov_base + lWritten;
+         psBuffers[ulFirst].iov_len -= (size_t) lWritten;
+      }
+   }
+
+   free(psBuffers);
+   FT_textFree(&sHead);
+   return iStatus;
+}
@@ -11,6 +11,10 @@
 #include <stddef.h>
 #include "a4def.h"
 
+/* Return statuses of FT_writeTo and FT_toStringInto, beyond those of
+   a4def.h */
+enum { WRITE_ERROR = MEMORY_ERROR + 1, BUFFER_TOO_SMALL };
+
 /*
    Inserts a new directory into the FT with absolute path pcPath.
    Returns SUCCESS if the new directory is inserted successfully.
@@ -115,6 +119,29 @@ void *FT_replaceFileContents(const char *pcPath, void *pvNewContents,
 */
 int FT_stat(const char *pcPath, boolean *pbIsFile, size_t *pulSize);
 
+/*
+  Selects whether later insertions collapse a chain of single-child
+  directories (such as the ancestors created by inserting
+  "a/b/c/d/e/file" into a tree containing only "a") into one node
+  (bCompress TRUE) or create one node per level (FALSE, the default).
+  A compressed chain is split as soon as a sibling is added along it.
+  The setting does not change the results of any other FT function.
+  Returns INITIALIZATION_ERROR if the FT is in an initialized state,
+  and SUCCESS otherwise.
+*/
+int FT_setCompression(boolean bCompress);
+
+/*
+  Selects whether FT_rmDir frees what it removes in a background
+  thread (bDefer TRUE) or before returning (FALSE, the default). A
+  deferred removal unlinks the subtree in time proportional to its
+  depth, so the FT reflects it at once however large it is; the
+  thread frees its nodes a few at a time between other FT calls, and
+  FT_destroy waits for it to finish. Returns INITIALIZATION_ERROR if
+  the FT is in an initialized state, and SUCCESS otherwise.
+*/
+int FT_setDeferredRemoval(boolean bDefer);
+
 /*
   Sets the FT data structure to an initialized state.
   The data structure is initially empty.
@@ -131,6 +158,238 @@ int FT_init(void);
 */
 int FT_destroy(void);
 
+/*
+  The orders in which FT_walk and an FT_Iter_T visit the directories
+  and files in a hierarchy: depth-first with each directory before
+  everything below it (FT_PREORDER, the order of FT_toString) or
+  after it (FT_POSTORDER), or breadth-first, by depth (FT_LEVELORDER).
+  In every order, the files directly in a directory come before its
+  subdirectories, and those of the same type are in lexicographic
+  order.
+*/
+enum FT_Order { FT_PREORDER, FT_POSTORDER, FT_LEVELORDER };
+
+/*
+  What a visitor passed to FT_walk returns: FT_CONTINUE to go on,
+  FT_PRUNE to go on without visiting anything below the directory
+  just visited (which in FT_POSTORDER has already been visited), or
+  FT_STOP to end the walk.
+*/
+enum FT_Action { FT_CONTINUE, FT_PRUNE, FT_STOP };
+
+/*
+  A directory or file, as FT_walk and FT_iterNext describe it. Its
+  strings belong to the FT, and stay valid only until the FT next
+  changes.
+*/
+struct FT_Entry {
+   /* The absolute path. Only its first ulPathLength characters are
+      the entry's path, which is not always followed by a '\0': a
+      directory that the FT keeps only as part of a deeper path
+      shares the string of that path. */
+   const char *pcPath;
+   size_t ulPathLength;
+
+   /* The name: the last component of the path. */
+   const char *pcName;
+
+   /* The depth of the path: 1 for the root, 2 for its children, and
+      so on. */
+   size_t ulDepth;
+
+   /* TRUE for a file, or FALSE for a directory. */
+   boolean bIsFile;
+
+   /* The length of a file's contents, or 0 for a directory. */
+   size_t ulSize;
+};
+
+/*
+  Calls pfVisit for the directory or file with absolute path pcPath
+  and everything below it, in order eOrder, passing a description of
+  each and pvExtra, until pfVisit returns FT_STOP. pfVisit must not
+  change the FT. No memory is allocated except, for FT_LEVELORDER,
+  room for one level of the hierarchy.
+  Returns SUCCESS if the walk ended or was stopped by pfVisit.
+  Otherwise, visits nothing and returns:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * BAD_PATH if pcPath does not represent a well-formatted path
+  * CONFLICTING_PATH if the root's path is not a prefix of pcPath
+  * NO_SUCH_PATH if absolute path pcPath does not exist in the FT
+  * MEMORY_ERROR if memory could not be allocated to complete request,
+    in which case the walk may have visited some entries first
+*/
+int FT_walk(const char *pcPath,
+            enum FT_Action (*pfVisit)(const struct FT_Entry *psEntry,
+                                      void *pvExtra),
+            void *pvExtra, enum FT_Order eOrder);
+
+/*
+  An FT_Iter_T is a cursor over the directory or file with some
+  absolute path and everything below it, in some order. The FT must
+  not change while one is in use.
+*/
+typedef struct FT_Iter *FT_Iter_T;
+
+/*
+  Creates an FT_Iter_T over the directory or file with absolute path
+  pcPath and everything below it, in order eOrder. Returns SUCCESS and
+  sets *poIter to the new FT_Iter_T if successful. Otherwise, sets
+  *poIter to NULL and returns:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * BAD_PATH if pcPath does not represent a well-formatted path
+  * CONFLICTING_PATH if the root's path is not a prefix of pcPath
+  * NO_SUCH_PATH if absolute path pcPath does not exist in the FT
+  * MEMORY_ERROR if memory could not be allocated to complete request
+*/
+int FT_iterNew(const char *pcPath, enum FT_Order eOrder,
+               FT_Iter_T *poIter);
+
+/*
+  Advances oIter to the next directory or file and describes it in
+  *psEntry. Returns SUCCESS if there was one, or NO_SUCH_PATH if
+  oIter has already visited everything. For FT_LEVELORDER, returns
+  MEMORY_ERROR if memory could not be allocated to go on, after which
+  oIter may only be freed.
+*/
+int FT_iterNext(FT_Iter_T oIter, struct FT_Entry *psEntry);
+
+/*
+  Makes oIter skip everything below the directory that FT_iterNext
+  last described, as a visitor returning FT_PRUNE makes FT_walk do.
+*/
+void FT_iterPrune(FT_Iter_T oIter);
+
+/*
+  Frees oIter, which may be abandoned before it has visited
+  everything.
+*/
+void FT_iterFree(FT_Iter_T oIter);
+
+/*
+  Lists up to ulMaxEntries (at least 1) of the directories and files
+  directly in the directory with absolute path pcPath, describing
+  them in psEntries[0], psEntries[1], and so on, and stores their
+  number in *pulNumEntries. Unlike elsewhere, files and directories
+  are listed together, in lexicographic order of name, so that a
+  name alone marks a place in the listing: the entries are the first
+  whose names follow pcCursor, or the first of all if pcCursor is
+  NULL. If more entries follow them, sets *ppcNextCursor to the last
+  one's name, to be passed as pcCursor for the next page; otherwise,
+  sets it to NULL. That name belongs to the FT like the entries'
+  strings, so a copy of it must be passed once the FT has changed;
+  the listing then resumes after it whether or not that entry is
+  still there.
+  Returns SUCCESS if the entries were listed.
+  Otherwise, lists nothing and returns:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * BAD_PATH if pcPath does not represent a well-formatted path
+  * CONFLICTING_PATH if the root's path is not a prefix of pcPath
+  * NO_SUCH_PATH if absolute path pcPath does not exist in the FT
+  * NOT_A_DIRECTORY if pcPath is in the FT as a file not a directory
+  * MEMORY_ERROR if memory could not be allocated to complete request
+*/
+int FT_readdir(const char *pcPath, const char *pcCursor,
+               size_t ulMaxEntries, struct FT_Entry *psEntries,
+               size_t *pulNumEntries, const char **ppcNextCursor);
+
+/*
+  Calls pfVisit, as FT_walk does in FT_PREORDER, for each directory
+  and file whose path is from pcStartPath through pcEndPath or below
+  pcEndPath, until pfVisit returns FT_STOP. Paths are ordered as
+  FT_readdir lists them: component by component, by name, with a
+  path before those below it. Neither pcStartPath nor pcEndPath need
+  be in the FT; if pcStartPath follows pcEndPath, nothing is visited.
+  Only the directories and files in that range, and those above
+  them, are looked at.
+  Returns SUCCESS if the walk ended or was stopped by pfVisit.
+  Otherwise, visits nothing and returns:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * BAD_PATH if either path is not well-formatted
+  * CONFLICTING_PATH if the root's path is not a prefix of either path
+  * MEMORY_ERROR if memory could not be allocated to complete request
+*/
+int FT_range(const char *pcStartPath, const char *pcEndPath,
+             enum FT_Action (*pfVisit)(const struct FT_Entry *psEntry,
+                                       void *pvExtra),
+             void *pvExtra);
+
+/*
+  Calls pfVisit, as FT_range does, for each directory and file whose
+  path matches the glob pattern pcPattern, in the order that FT_range
+  visits them, until pfVisit returns FT_STOP. Like a path, a pattern
+  is a sequence of components separated by '/'. A component "**"
+  matches any number of components, including none; in any other,
+  '*' matches any run of characters, '?' any one character, "[...]"
+  any one character in the brackets (or not in them, after a leading
+  '!' or '^'), and '\' makes the next character match only itself.
+  Only the directories and files whose paths so far could still lead
+  to a match are looked at, and a component without wildcards, or the
+  characters before a component's first wildcard, are found by
+  binary search.
+  Returns SUCCESS if the walk ended or was stopped by pfVisit.
+  Otherwise, visits nothing and returns:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * BAD_PATH if pcPattern is not a well-formatted path, or has more
+             than 31 components
+  * MEMORY_ERROR if memory could not be allocated to complete request
+*/
+int FT_glob(const char *pcPattern,
+            enum FT_Action (*pfVisit)(const struct FT_Entry *psEntry,
+                                      void *pvExtra),
+            void *pvExtra);
+
+/*
+  Calls pfVisit for the directory or file with absolute path pcPath
+  and everything below it, passing a description of each and
+  pvExtra, using up to ulThreads threads and in no particular order.
+  Each thread goes through a part of the hierarchy at a time, and
+  when it reaches a directory, leaves half of the directory's
+  children for an idle thread to take over. pfVisit must be safe to
+  call from several threads at once, and must not change the FT. If
+  threads or memory cannot be obtained, fewer threads are used.
+  Returns SUCCESS if everything was visited.
+  Otherwise, visits nothing and returns:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * BAD_PATH if pcPath does not represent a well-formatted path
+  * CONFLICTING_PATH if the root's path is not a prefix of pcPath
+  * NO_SUCH_PATH if absolute path pcPath does not exist in the FT
+*/
+int FT_mapParallel(const char *pcPath,
+                   void (*pfVisit)(const struct FT_Entry *psEntry,
+                                   void *pvExtra),
+                   void *pvExtra, size_t ulThreads);
+
+/*
+  Folds the descriptions of the directory or file with absolute path
+  pcPath and everything below it into the object of ulAccumulatorSize
+  bytes at pvAccumulator, using up to ulThreads threads as
+  FT_mapParallel does. Their sequence in FT_PREORDER is cut into runs,
+  each of which is folded into its own copy of *pvAccumulator, which
+  must initially be the identity of the reduction (such as a zero
+  count), by calling (*pfApply)(psEntry, pvPartial) for each entry
+  with the copy pvPartial. Then the copies are folded into
+  *pvAccumulator, in the order of the runs, by calling
+  (*pfCombine)(pvAccumulator, pvPartial). The result thus does not
+  depend on how the threads divide the work as long as *pfCombine is
+  associative. pfApply must be safe to call from several threads at
+  once for different copies, and must not change the FT.
+  Returns SUCCESS if everything was folded.
+  Otherwise, folds nothing and returns:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * BAD_PATH if pcPath does not represent a well-formatted path
+  * CONFLICTING_PATH if the root's path is not a prefix of pcPath
+  * NO_SUCH_PATH if absolute path pcPath does not exist in the FT
+  * MEMORY_ERROR if memory could not be allocated to complete request
+*/
+int FT_reduceParallel(const char *pcPath,
+                      void (*pfApply)(const struct FT_Entry *psEntry,
+                                      void *pvAccumulator),
+                      void (*pfCombine)(void *pvAccumulator,
+                                        void *pvPartial),
+                      void *pvAccumulator, size_t ulAccumulatorSize,
+                      size_t ulThreads);
+
 /*
   Returns a string representation of the
   data structure, or NULL if the structure is
@@ -140,9 +399,61 @@ int FT_destroy(void);
   before directories at any given level, and nodes
   of the same type ordered lexicographically.
 
+  The FT keeps a copy of the last representation
+  generated, so that generating another goes only
+  through the parts of the hierarchy that have had
+  directories or files inserted or removed since.
+
   Allocates memory for the returned string,
   which is then owned by client!
 */
 char *FT_toString(void);
 
+/*
+  Returns the length of the string that FT_toString would return, not
+  counting its terminating '\0', without generating it, or 0 if the
+  FT is not initialized. The length is kept up to date as directories
+  and files are inserted and removed.
+*/
+size_t FT_toStringLength(void);
+
+/*
+  Writes the string that FT_toString would return, with its
+  terminating '\0', to the ulCapacity characters at pcBuffer, which
+  the client owns, instead of allocating memory for it.
+  Returns SUCCESS if it was written.
+  Otherwise, writes nothing and returns:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * BUFFER_TOO_SMALL if ulCapacity is not more than FT_toStringLength
+  * MEMORY_ERROR if memory could not be allocated to complete request
+*/
+int FT_toStringInto(char *pcBuffer, size_t ulCapacity);
+
+/*
+  Returns the string representation of the FT, the same as
+  FT_toString does, generated with up to ulThreads threads as
+  FT_reduceParallel does. Each thread writes the lines of its part of
+  the hierarchy into its own buffer, and the buffers are copied into
+  the result in order once all are done. Returns NULL if the FT is
+  not initialized or there is an allocation error.
+
+  Allocates memory for the returned string,
+  which is then owned by client!
+*/
+char *FT_toStringParallel(size_t ulThreads);
+
+/*
+  Writes the string representation of the FT, the same as
+  FT_toString returns, to the file descriptor iFd, generating it as
+  FT_toStringParallel does and writing the threads' buffers in order
+  without first joining them.
+  Returns SUCCESS if all of it was written.
+  Otherwise, returns:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * MEMORY_ERROR if memory could not be allocated to complete request
+  * WRITE_ERROR if writing to iFd failed, in which case some of the
+                representation may have been written
+*/
+int FT_writeTo(int iFd, size_t ulThreads);
+
 #endif
@@ -8,7 +8,632 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <pthread.h>
+#include <unistd.h>
 #include "ft.h"
+#include "glob.h"
+
+/* The paths that record_entry has been given, one per line, the
+   number of entries it has been given, the number after which it
+   returns FT_STOP (or 0 never to), and the name of the directory for
+   which it returns FT_PRUNE (or NULL for none). */
+struct Record {
+  char acPaths[1000];
+  size_t ulVisits;
+  size_t ulStopAfter;
+  const char *pcPruneName;
+};
+
+/* Empties *psRecord and sets when record_entry is to return FT_STOP
+   or FT_PRUNE. */
+static void record_reset(struct Record *psRecord, size_t ulStopAfter,
+                         const char *pcPruneName) {
+  psRecord->acPaths[0] = '\0';
+  psRecord->ulVisits = 0;
+  psRecord->ulStopAfter = ulStopAfter;
+  psRecord->pcPruneName = pcPruneName;
+}
+
+/* Appends the path of psEntry and a newline to the struct Record at
+   pvExtra. Returns FT_STOP, FT_PRUNE, or FT_CONTINUE as that record
+   says. */
+static enum FT_Action record_entry(const struct FT_Entry *psEntry,
+                                   void *pvExtra) {
+  struct Record *psRecord = (struct Record *) pvExtra;
+  size_t ulLength = strlen(psRecord->acPaths);
+
+  assert(ulLength + psEntry->ulPathLength + 1 <
+         sizeof(psRecord->acPaths));
+  memcpy(psRecord->acPaths + ulLength, psEntry->pcPath,
+         psEntry->ulPathLength);
+  strcpy(psRecord->acPaths + ulLength + psEntry->ulPathLength, "\n");
+  psRecord->ulVisits++;
+  if(psRecord->ulVisits == psRecord->ulStopAfter)
+    return FT_STOP;
+  if(psRecord->pcPruneName != NULL &&
+     !strcmp(psEntry->pcName, psRecord->pcPruneName))
+    return FT_PRUNE;
+  return FT_CONTINUE;
+}
+
+/* Sets compression on if bCompression, or off otherwise, initializes
+   the FT, and inserts the directories of ppcDirs and then the empty
+   files of ppcFiles. Each list ends with NULL, and either can be NULL
+   for none. */
+static void fixture_build(boolean bCompression,
+                          const char *const *ppcDirs,
+                          const char *const *ppcFiles) {
+  assert(FT_setCompression(bCompression) == SUCCESS);
+  assert(FT_init() == SUCCESS);
+  for(; ppcDirs != NULL && *ppcDirs != NULL; ppcDirs++)
+    assert(FT_insertDir(*ppcDirs) == SUCCESS);
+  for(; ppcFiles != NULL && *ppcFiles != NULL; ppcFiles++)
+    assert(FT_insertFile(*ppcFiles, NULL, 0) == SUCCESS);
+}
+
+/* Destroys the FT that fixture_build built and sets compression back
+   off. */
+static void fixture_destroy(void) {
+  assert(FT_destroy() == SUCCESS);
+  assert(FT_setCompression(FALSE) == SUCCESS);
+}
+
+/* Tests FT_range on a hierarchy built with compression on if
+   bCompression, or off otherwise. */
+static void test_range(boolean bCompression) {
+  static const char *const apcDirs[] = { "r", "r/q/x", "r/z/y/w",
+                                         NULL };
+  static const char *const apcFiles[] = { "r/a/b/c/f", "r/m", NULL };
+  static const char *const apcChain[] = { "r", "r/a/b/c", NULL };
+  struct Record sRecord;
+
+  fixture_build(bCompression, apcDirs, apcFiles);
+
+  /* the whole hierarchy is below an end bound of the root */
+  record_reset(&sRecord, 0, NULL);
+  assert(FT_range("r", "r", record_entry, &sRecord) == SUCCESS);
+  assert(!strcmp(sRecord.acPaths, "r\nr/a\nr/a/b\nr/a/b/c\n"
+                 "r/a/b/c/f\nr/m\nr/q\nr/q/x\nr/z\nr/z/y\n"
+                 "r/z/y/w\n"));
+
+  /* nothing is from a start through an earlier end */
+  record_reset(&sRecord, 0, NULL);
+  assert(FT_range("r/z", "r/a", record_entry, &sRecord) == SUCCESS);
+  assert(sRecord.ulVisits == 0);
+  record_reset(&sRecord, 0, NULL);
+  assert(FT_range("r/a/b/c/g", "r/a/b/c/f", record_entry, &sRecord)
+         == SUCCESS);
+  assert(sRecord.ulVisits == 0);
+
+  /* bounds need not be in the FT, and a start before a directory
+     that a compressed node stands for skips all of that node */
+  record_reset(&sRecord, 0, NULL);
+  assert(FT_range("r/a/b/d", "r/p", record_entry, &sRecord) ==
+         SUCCESS);
+  assert(!strcmp(sRecord.acPaths, "r/m\n"));
+  record_reset(&sRecord, 0, NULL);
+  assert(FT_range("r/b", "r/q/a", record_entry, &sRecord) == SUCCESS);
+  assert(!strcmp(sRecord.acPaths, "r/m\nr/q\n"));
+  record_reset(&sRecord, 0, NULL);
+  assert(FT_range("r/a/x", "r/q", record_entry, &sRecord) == SUCCESS);
+  assert(!strcmp(sRecord.acPaths, "r/m\nr/q\nr/q/x\n"));
+
+  /* an end bound's descendants are in the range */
+  record_reset(&sRecord, 0, NULL);
+  assert(FT_range("r/m", "r/z/y", record_entry, &sRecord) == SUCCESS);
+  assert(!strcmp(sRecord.acPaths,
+                 "r/m\nr/q\nr/q/x\nr/z\nr/z/y\nr/z/y/w\n"));
+  record_reset(&sRecord, 0, NULL);
+  assert(FT_range("r/a/b", "r/a/b", record_entry, &sRecord) ==
+         SUCCESS);
+  assert(!strcmp(sRecord.acPaths, "r/a/b\nr/a/b/c\nr/a/b/c/f\n"));
+
+  /* the visitor can stop the walk, or skip what is below a
+     directory */
+  record_reset(&sRecord, 3, NULL);
+  assert(FT_range("r", "r/z", record_entry, &sRecord) == SUCCESS);
+  assert(!strcmp(sRecord.acPaths, "r\nr/a\nr/a/b\n"));
+  record_reset(&sRecord, 0, "a");
+  assert(FT_range("r/a", "r/q", record_entry, &sRecord) == SUCCESS);
+  assert(!strcmp(sRecord.acPaths, "r/a\nr/m\nr/q\nr/q/x\n"));
+
+  assert(FT_range("s", "r", record_entry, &sRecord) ==
+         CONFLICTING_PATH);
+  assert(FT_range("r/a", "r//b", record_entry, &sRecord) == BAD_PATH);
+  fixture_destroy();
+
+  /* a lone chain below a start bound that branches off it */
+  fixture_build(bCompression, apcChain, NULL);
+  record_reset(&sRecord, 0, NULL);
+  assert(FT_range("r/a/x", "r/z", record_entry, &sRecord) == SUCCESS);
+  assert(sRecord.ulVisits == 0);
+  fixture_destroy();
+}
+
+/* Returns TRUE if the path pcPath matches oGlob, stepping through its
+   components one at a time as FT_glob does, or FALSE otherwise. */
+static boolean glob_matches(Glob_T oGlob, const char *pcPath) {
+  char acComponent[100];
+  unsigned long ulStates = Glob_start(oGlob);
+  size_t ulLength;
+
+  for(;;) {
+    ulLength = strcspn(pcPath, "/");
+    assert(ulLength < sizeof(acComponent));
+    memcpy(acComponent, pcPath, ulLength);
+    acComponent[ulLength] = '\0';
+    ulStates = Glob_step(oGlob, ulStates, acComponent);
+    if(pcPath[ulLength] == '\0')
+      return Glob_accepts(oGlob, ulStates);
+    pcPath += ulLength + 1;
+  }
+}
+
+/* Tests that Glob_T patterns match the paths they should, and give
+   the prefixes of the names that can go on matching. */
+static void test_glob_patterns(void) {
+  Glob_T oGlob;
+  const char *pcPrefix;
+  boolean bWhole;
+  char acPattern[100];
+  size_t l;
+
+  /* "**" matches no components, one, or several */
+  assert(Glob_new("r/**/c", &oGlob) == SUCCESS);
+  assert(glob_matches(oGlob, "r/c") == TRUE);
+  assert(glob_matches(oGlob, "r/a/c") == TRUE);
+  assert(glob_matches(oGlob, "r/a/b/c") == TRUE);
+  assert(glob_matches(oGlob, "r/a/b") == FALSE);
+  assert(glob_matches(oGlob, "r/c/d") == FALSE);
+  assert(glob_matches(oGlob, "s/c") == FALSE);
+  Glob_free(oGlob);
+  assert(Glob_new("r/**", &oGlob) == SUCCESS);
+  assert(glob_matches(oGlob, "r") == TRUE);
+  assert(glob_matches(oGlob, "r/a/b/c") == TRUE);
+  Glob_free(oGlob);
+
+  /* '?' matches one character, and "[...]" one of a set */
+  assert(Glob_new("r/?", &oGlob) == SUCCESS);
+  assert(glob_matches(oGlob, "r/a") == TRUE);
+  assert(glob_matches(oGlob, "r/ab") == FALSE);
+  assert(glob_matches(oGlob, "r") == FALSE);
+  Glob_free(oGlob);
+  assert(Glob_new("r/[!a-c]x", &oGlob) == SUCCESS);
+  assert(glob_matches(oGlob, "r/dx") == TRUE);
+  assert(glob_matches(oGlob, "r/bx") == FALSE);
+  assert(glob_matches(oGlob, "r/x") == FALSE);
+  Glob_free(oGlob);
+  assert(Glob_new("r/[^a]*", &oGlob) == SUCCESS);
+  assert(glob_matches(oGlob, "r/ba") == TRUE);
+  assert(glob_matches(oGlob, "r/ab") == FALSE);
+  Glob_free(oGlob);
+
+  /* '\' makes a wildcard match only itself */
+  assert(Glob_new("r/a\\*", &oGlob) == SUCCESS);
+  assert(glob_matches(oGlob, "r/a*") == TRUE);
+  assert(glob_matches(oGlob, "r/ab") == FALSE);
+  Glob_free(oGlob);
+  assert(Glob_new("r/\\?\\[", &oGlob) == SUCCESS);
+  assert(glob_matches(oGlob, "r/?[") == TRUE);
+  assert(glob_matches(oGlob, "r/a[") == FALSE);
+  Glob_free(oGlob);
+
+  /* the characters before a component's first wildcard, unescaped,
+     begin every name that can go on matching */
+  assert(Glob_new("r/ab*c/\\*x/[ab]", &oGlob) == SUCCESS);
+  pcPrefix = Glob_getPrefix(oGlob, Glob_start(oGlob), &bWhole);
+  assert(!strcmp(pcPrefix, "r") && bWhole == TRUE);
+  pcPrefix = Glob_getPrefix(oGlob, Glob_step(oGlob, Glob_start(oGlob),
+                                             "r"), &bWhole);
+  assert(!strcmp(pcPrefix, "ab") && bWhole == FALSE);
+  assert(Glob_step(oGlob, Glob_start(oGlob), "s") == 0);
+  assert(Glob_getPrefix(oGlob, 0, &bWhole) == NULL);
+  assert(glob_matches(oGlob, "r/abxc/*x/b") == TRUE);
+  Glob_free(oGlob);
+  assert(Glob_new("r/**/a", &oGlob) == SUCCESS);
+  pcPrefix = Glob_getPrefix(oGlob, Glob_step(oGlob, Glob_start(oGlob),
+                                             "r"), &bWhole);
+  assert(!strcmp(pcPrefix, "") && bWhole == FALSE);
+  Glob_free(oGlob);
+
+  /* patterns are well-formed paths of up to GLOB_MAX_COMPONENTS
+     components */
+  assert(Glob_new("", &oGlob) == BAD_PATH && oGlob == NULL);
+  assert(Glob_new("/r", &oGlob) == BAD_PATH);
+  assert(Glob_new("r/", &oGlob) == BAD_PATH);
+  assert(Glob_new("r//a", &oGlob) == BAD_PATH);
+  strcpy(acPattern, "r");
+  for(l = 1; l < GLOB_MAX_COMPONENTS; l++)
+    strcat(acPattern, "/*");
+  assert(Glob_new(acPattern, &oGlob) == SUCCESS);
+  Glob_free(oGlob);
+  strcat(acPattern, "/*");
+  assert(Glob_new(acPattern, &oGlob) == BAD_PATH);
+}
+
+/* Tests FT_glob on a hierarchy built with compression on if
+   bCompression, or off otherwise. */
+static void test_glob(boolean bCompression) {
+  static const char *const apcDirs[] = { "r", "r/abc", "r/x/c",
+                                         NULL };
+  static const char *const apcFiles[] = { "r/a/b/c", "r/a/c", "r/a*",
+                                          "r/ab", NULL };
+  struct Record sRecord;
+
+  fixture_build(bCompression, apcDirs, apcFiles);
+
+  record_reset(&sRecord, 0, NULL);
+  assert(FT_glob("r/**", record_entry, &sRecord) == SUCCESS);
+  assert(!strcmp(sRecord.acPaths, "r\nr/a\nr/a/b\nr/a/b/c\nr/a/c\n"
+                 "r/a*\nr/ab\nr/abc\nr/x\nr/x/c\n"));
+  record_reset(&sRecord, 0, NULL);
+  assert(FT_glob("r/**/c", record_entry, &sRecord) == SUCCESS);
+  assert(!strcmp(sRecord.acPaths, "r/a/b/c\nr/a/c\nr/x/c\n"));
+  record_reset(&sRecord, 0, NULL);
+  assert(FT_glob("r/a?", record_entry, &sRecord) == SUCCESS);
+  assert(!strcmp(sRecord.acPaths, "r/a*\nr/ab\n"));
+  record_reset(&sRecord, 0, NULL);
+  assert(FT_glob("r/a\\*", record_entry, &sRecord) == SUCCESS);
+  assert(!strcmp(sRecord.acPaths, "r/a*\n"));
+  record_reset(&sRecord, 0, NULL);
+  assert(FT_glob("r/[!a]*", record_entry, &sRecord) == SUCCESS);
+  assert(!strcmp(sRecord.acPaths, "r/x\n"));
+
+  /* names found from a literal prefix, or a whole literal name */
+  record_reset(&sRecord, 0, NULL);
+  assert(FT_glob("r/ab*", record_entry, &sRecord) == SUCCESS);
+  assert(!strcmp(sRecord.acPaths, "r/ab\nr/abc\n"));
+  record_reset(&sRecord, 0, NULL);
+  assert(FT_glob("r/a/b/c", record_entry, &sRecord) == SUCCESS);
+  assert(!strcmp(sRecord.acPaths, "r/a/b/c\n"));
+  record_reset(&sRecord, 0, NULL);
+  assert(FT_glob("r/a/b/d", record_entry, &sRecord) == SUCCESS);
+  assert(sRecord.ulVisits == 0);
+  record_reset(&sRecord, 0, NULL);
+  assert(FT_glob("s/**", record_entry, &sRecord) == SUCCESS);
+  assert(sRecord.ulVisits == 0);
+
+  /* the visitor can skip what is below a match, or stop the walk */
+  record_reset(&sRecord, 0, "a");
+  assert(FT_glob("r/**", record_entry, &sRecord) == SUCCESS);
+  assert(!strcmp(sRecord.acPaths,
+                 "r\nr/a\nr/a*\nr/ab\nr/abc\nr/x\nr/x/c\n"));
+  record_reset(&sRecord, 2, NULL);
+  assert(FT_glob("r/**", record_entry, &sRecord) == SUCCESS);
+  assert(!strcmp(sRecord.acPaths, "r\nr/a\n"));
+
+  assert(FT_glob("r//a", record_entry, &sRecord) == BAD_PATH);
+  fixture_destroy();
+  assert(FT_glob("r/**", record_entry, &sRecord) ==
+         INITIALIZATION_ERROR);
+}
+
+/* The most entries that a struct Collection holds. */
+enum { MAX_COLLECTED = 1000 };
+
+/* Copies of the paths that collect_entry has been given, in the
+   order it was given them, and the lock that it takes to add one. */
+struct Collection {
+  char *apcPaths[MAX_COLLECTED];
+  size_t ulLength;
+  pthread_mutex_t sMutex;
+};
+
+/* Adds a copy of the path of psEntry to the struct Collection at
+   pvExtra. Safe to call from several threads at once. */
+static void collect_entry(const struct FT_Entry *psEntry,
+                          void *pvExtra) {
+  struct Collection *psCollection = (struct Collection *) pvExtra;
+  char *pcPath;
+  int iStatus;
+
+  pcPath = malloc(psEntry->ulPathLength + 1);
+  assert(pcPath != NULL);
+  memcpy(pcPath, psEntry->pcPath, psEntry->ulPathLength);
+  pcPath[psEntry->ulPathLength] = '\0';
+  iStatus = pthread_mutex_lock(&psCollection->sMutex);
+  assert(iStatus == 0);
+  assert(psCollection->ulLength < MAX_COLLECTED);
+  psCollection->apcPaths[psCollection->ulLength++] = pcPath;
+  iStatus = pthread_mutex_unlock(&psCollection->sMutex);
+  assert(iStatus == 0);
+}
+
+/* Calls collect_entry for FT_walk. Returns FT_CONTINUE. */
+static enum FT_Action collect_walk(const struct FT_Entry *psEntry,
+                                   void *pvExtra) {
+  collect_entry(psEntry, pvExtra);
+  return FT_CONTINUE;
+}
+
+/* Compares the strings that pvPath1 and pvPath2 point to, for
+   qsort. */
+static int compare_paths(const void *pvPath1, const void *pvPath2) {
+  return strcmp(*(char *const *) pvPath1, *(char *const *) pvPath2);
+}
+
+/* An order-sensitive fold of a sequence of entries: a polynomial
+   hash of their paths, each followed by a newline, the factor that
+   appending the sequence multiplies a hash by, and the number of
+   entries. Since unsigned arithmetic wraps, joining folds with
+   fold_join is associative, but depends on their order. */
+struct Fold {
+  unsigned long ulHash;
+  unsigned long ulFactor;
+  size_t ulEntries;
+};
+
+/* Folds the path of psEntry into the struct Fold at pvAccumulator. */
+static void fold_entry(const struct FT_Entry *psEntry,
+                       void *pvAccumulator) {
+  struct Fold *psFold = (struct Fold *) pvAccumulator;
+  size_t l;
+
+  for(l = 0; l <= psEntry->ulPathLength; l++) {
+    psFold->ulHash = psFold->ulHash * 31 +
+      (unsigned char) (l < psEntry->ulPathLength ?
+                       psEntry->pcPath[l] : '\n');
+    psFold->ulFactor *= 31;
+  }
+  psFold->ulEntries++;
+}
+
+/* Calls fold_entry for FT_walk. Returns FT_CONTINUE. */
+static enum FT_Action fold_walk(const struct FT_Entry *psEntry,
+                                void *pvExtra) {
+  fold_entry(psEntry, pvExtra);
+  return FT_CONTINUE;
+}
+
+/* Appends the fold at pvPartial to the fold at pvAccumulator. */
+static void fold_join(void *pvAccumulator, void *pvPartial) {
+  struct Fold *psFold = (struct Fold *) pvAccumulator;
+  const struct Fold *psPartial = (const struct Fold *) pvPartial;
+
+  psFold->ulHash = psFold->ulHash * psPartial->ulFactor +
+    psPartial->ulHash;
+  psFold->ulFactor *= psPartial->ulFactor;
+  psFold->ulEntries += psPartial->ulEntries;
+}
+
+/* Tests that FT_mapParallel visits what FT_walk does in FT_PREORDER,
+   once each, and that FT_reduceParallel folds it in the same order,
+   with any number of threads, on a hierarchy built with compression
+   on if bCompression, or off otherwise. */
+static void test_parallel(boolean bCompression) {
+  static const size_t aulThreads[] = { 1, 2, 3, 8, (size_t) -1 };
+  static const char *apcStarts[] = { "r", "r/d3", "r/d3/f4" };
+  static const char *const apcRoot[] = { "r", NULL };
+  struct Collection sWalked;
+  struct Collection sMapped;
+  struct Fold sWalkFold;
+  struct Fold sReduceFold;
+  char acPath[100];
+  size_t i, j, t;
+  int iStatus;
+
+  fixture_build(bCompression, apcRoot, NULL);
+  for(i = 0; i < 20; i++)
+    for(j = 0; j < 10; j++) {
+      sprintf(acPath, "r/d%lu/f%lu", (unsigned long) i,
+              (unsigned long) j);
+      assert(FT_insertFile(acPath, NULL, j) == SUCCESS);
+      sprintf(acPath, "r/d%lu/s%lu/x", (unsigned long) i,
+              (unsigned long) j);
+      assert(FT_insertDir(acPath) == SUCCESS);
+    }
+  iStatus = pthread_mutex_init(&sWalked.sMutex, NULL);
+  assert(iStatus == 0);
+  iStatus = pthread_mutex_init(&sMapped.sMutex, NULL);
+  assert(iStatus == 0);
+
+  for(i = 0; i < sizeof(apcStarts) / sizeof(apcStarts[0]); i++) {
+    sWalked.ulLength = 0;
+    assert(FT_walk(apcStarts[i], collect_walk, &sWalked, FT_PREORDER)
+           == SUCCESS);
+    qsort(sWalked.apcPaths, sWalked.ulLength, sizeof(char *),
+          compare_paths);
+    sWalkFold.ulHash = 0;
+    sWalkFold.ulFactor = 1;
+    sWalkFold.ulEntries = 0;
+    assert(FT_walk(apcStarts[i], fold_walk, &sWalkFold, FT_PREORDER)
+           == SUCCESS);
+    assert(sWalkFold.ulEntries == sWalked.ulLength);
+
+    for(t = 0; t < sizeof(aulThreads) / sizeof(aulThreads[0]); t++) {
+      sMapped.ulLength = 0;
+      assert(FT_mapParallel(apcStarts[i], collect_entry, &sMapped,
+                            aulThreads[t]) == SUCCESS);
+      assert(sMapped.ulLength == sWalked.ulLength);
+      qsort(sMapped.apcPaths, sMapped.ulLength, sizeof(char *),
+            compare_paths);
+      for(j = 0; j < sMapped.ulLength; j++) {
+        assert(!strcmp(sMapped.apcPaths[j], sWalked.apcPaths[j]));
+        free(sMapped.apcPaths[j]);
+      }
+
+      sReduceFold.ulHash = 0;
+      sReduceFold.ulFactor = 1;
+      sReduceFold.ulEntries = 0;
+      assert(FT_reduceParallel(apcStarts[i], fold_entry, fold_join,
+                               &sReduceFold, sizeof(sReduceFold),
+                               aulThreads[t]) == SUCCESS);
+      assert(sReduceFold.ulEntries == sWalkFold.ulEntries);
+      assert(sReduceFold.ulHash == sWalkFold.ulHash);
+      assert(sReduceFold.ulFactor == sWalkFold.ulFactor);
+    }
+    for(j = 0; j < sWalked.ulLength; j++)
+      free(sWalked.apcPaths[j]);
+  }
+
+  assert(FT_mapParallel("r/nowhere", collect_entry, &sMapped, 2) ==
+         NO_SUCH_PATH);
+  iStatus = pthread_mutex_destroy(&sWalked.sMutex);
+  assert(iStatus == 0);
+  iStatus = pthread_mutex_destroy(&sMapped.sMutex);
+  assert(iStatus == 0);
+  fixture_destroy();
+}
+
+/* The read end of a pipe, and the bytes that drain_pipe has read from
+   it. */
+struct Drain {
+  int iFd;
+  char *pcBytes;
+  size_t ulLength;
+  size_t ulCapacity;
+};
+
+/* Reads the struct Drain at pvDrain's pipe until end of file, keeping
+   the bytes. Returns NULL. */
+static void *drain_pipe(void *pvDrain) {
+  struct Drain *psDrain = (struct Drain *) pvDrain;
+  ssize_t lRead;
+
+  for(;;) {
+    if(psDrain->ulLength == psDrain->ulCapacity) {
+      psDrain->ulCapacity = 2 * psDrain->ulCapacity + 4096;
+      psDrain->pcBytes = realloc(psDrain->pcBytes, psDrain->ulCapacity);
+      assert(psDrain->pcBytes != NULL);
+    }
+    lRead = read(psDrain->iFd, psDrain->pcBytes + psDrain->ulLength,
+                 psDrain->ulCapacity - psDrain->ulLength);
+    assert(lRead >= 0);
+    if(lRead == 0)
+      return NULL;
+    psDrain->ulLength += (size_t) lRead;
+  }
+}
+
+/* Asserts that FT_writeTo, with ulThreads threads, writes to a pipe
+   exactly the bytes of FT_toString. */
+static void check_write_to(size_t ulThreads) {
+  struct Drain sDrain;
+  pthread_t sReader;
+  int aiPipe[2];
+  char *pcExpected;
+  int iStatus;
+
+  iStatus = pipe(aiPipe);
+  assert(iStatus == 0);
+  sDrain.iFd = aiPipe[0];
+  sDrain.pcBytes = NULL;
+  sDrain.ulLength = 0;
+  sDrain.ulCapacity = 0;
+  /* the reader keeps a large representation from filling the pipe */
+  iStatus = pthread_create(&sReader, NULL, drain_pipe, &sDrain);
+  assert(iStatus == 0);
+  assert(FT_writeTo(aiPipe[1], ulThreads) == SUCCESS);
+  iStatus = close(aiPipe[1]);
+  assert(iStatus == 0);
+  iStatus = pthread_join(sReader, NULL);
+  assert(iStatus == 0);
+  iStatus = close(aiPipe[0]);
+  assert(iStatus == 0);
+
+  assert((pcExpected = FT_toString()) != NULL);
+  assert(sDrain.ulLength == strlen(pcExpected));
+  assert(!memcmp(sDrain.pcBytes, pcExpected, sDrain.ulLength));
+  free(pcExpected);
+  free(sDrain.pcBytes);
+}
+
+/* Tests that FT_writeTo writes what FT_toString returns, with any
+   number of threads, and reports a descriptor it cannot write to. */
+static void test_write_to(void) {
+  int aiPipe[2];
+  char acName[200];
+  char acPath[2 * sizeof(acName) + 10];
+  size_t i, j;
+  int iStatus;
+
+  assert(FT_writeTo(1, 1) == INITIALIZATION_ERROR);
+  fixture_build(FALSE, NULL, NULL);
+  check_write_to(1);
+  assert(FT_insertDir("r") == SUCCESS);
+  check_write_to(1);
+
+  /* long names, for about 100 KB, more than a pipe holds */
+  memset(acName, 'n', sizeof(acName) - 1);
+  acName[sizeof(acName) - 1] = '\0';
+  for(i = 0; i < 16; i++)
+    for(j = 0; j < 16; j++) {
+      sprintf(acPath, "r/%s%02lu/%s%02lu", acName, (unsigned long) i,
+              acName, (unsigned long) j);
+      assert(FT_insertFile(acPath, NULL, 0) == SUCCESS);
+    }
+  check_write_to(1);
+  check_write_to(2);
+  check_write_to(8);
+
+  assert(FT_writeTo(-1, 1) == WRITE_ERROR);
+  iStatus = pipe(aiPipe);
+  assert(iStatus == 0);
+  assert(FT_writeTo(aiPipe[0], 4) == WRITE_ERROR);
+  iStatus = close(aiPipe[0]);
+  assert(iStatus == 0);
+  iStatus = close(aiPipe[1]);
+  assert(iStatus == 0);
+  fixture_destroy();
+}
+
+/* Asserts that FT_toString, which regenerates only what has changed
+   since it was last called, returns pcExpected, as does
+   FT_toStringParallel, which generates everything anew. */
+static void check_to_string(const char *pcExpected) {
+  char *pcCached;
+  char *pcFresh;
+
+  pcCached = FT_toString();
+  pcFresh = FT_toStringParallel(1);
+  assert(pcCached != NULL && pcFresh != NULL);
+  assert(!strcmp(pcCached, pcExpected));
+  assert(!strcmp(pcFresh, pcExpected));
+  free(pcCached);
+  free(pcFresh);
+}
+
+/* Tests that FT_toString stays up to date as each kind of change is
+   made between calls to it, on a hierarchy built with compression on
+   if bCompression and with removals deferred if bDefer. */
+static void test_to_string(boolean bCompression, boolean bDefer) {
+  static const char *const apcDirs[] = { "r", NULL };
+  static const char *const apcFiles[] = { "r/f", NULL };
+
+  assert(FT_setDeferredRemoval(bDefer) == SUCCESS);
+  fixture_build(bCompression, apcDirs, apcFiles);
+  check_to_string("r\nr/f\n");
+  check_to_string("r\nr/f\n");
+
+  /* a chain of directories, and then inserts that split it */
+  assert(FT_insertFile("r/a/b/c/g", NULL, 0) == SUCCESS);
+  check_to_string("r\nr/f\nr/a\nr/a/b\nr/a/b/c\nr/a/b/c/g\n");
+  assert(FT_insertDir("r/a/x") == SUCCESS);
+  check_to_string("r\nr/f\nr/a\nr/a/b\nr/a/b/c\nr/a/b/c/g\n"
+                  "r/a/x\n");
+  assert(FT_insertDir("r/a/b/c/d") == SUCCESS);
+  assert(FT_insertFile("r/a/b/e", NULL, 0) == SUCCESS);
+  check_to_string("r\nr/f\nr/a\nr/a/b\nr/a/b/e\nr/a/b/c\n"
+                  "r/a/b/c/g\nr/a/b/c/d\nr/a/x\n");
+
+  /* removals, and inserts where something was removed */
+  assert(FT_insertFile("r/e", NULL, 0) == SUCCESS);
+  assert(FT_rmFile("r/f") == SUCCESS);
+  check_to_string("r\nr/e\nr/a\nr/a/b\nr/a/b/e\nr/a/b/c\n"
+                  "r/a/b/c/g\nr/a/b/c/d\nr/a/x\n");
+  assert(FT_rmDir("r/a/b") == SUCCESS);
+  check_to_string("r\nr/e\nr/a\nr/a/x\n");
+  assert(FT_insertDir("r/a/b/z") == SUCCESS);
+  assert(FT_rmDir("r/a/x") == SUCCESS);
+  check_to_string("r\nr/e\nr/a\nr/a/b\nr/a/b/z\n");
+  assert(FT_rmDir("r") == SUCCESS);
+  check_to_string("");
+  assert(FT_insertDir("s/t") == SUCCESS);
+  check_to_string("s\ns/t\n");
+
+  fixture_destroy();
+  assert(FT_setDeferredRemoval(FALSE) == SUCCESS);
+}
 
 /* Tests the FT implementation with an assortment of checks.
    Prints the status of the data structure along the way to stderr.
@@ -16,9 +641,14 @@
 int main(void) {
   enum {ARRLEN = 1000};
   char* temp;
+  char* temp2;
   boolean bIsFile;
   size_t l;
   char arr[ARRLEN];
+  FT_Iter_T oIter;
+  struct FT_Entry sEntry;
+  struct FT_Entry asEntries[2];
+  const char *pcCursor;
   arr[0] = '\0';
 
   /* Before the data structure is initialized:
@@ -34,6 +664,7 @@ int main(void) {
   assert(FT_containsFile("1root/2child/3gkid/4ggk") == FALSE);
   assert(FT_rmFile("1root/2child/3gkid/4ggk") == INITIALIZATION_ERROR);
   assert((temp = FT_toString()) == NULL);
+  assert((temp = FT_toStringParallel(3)) == NULL);
   assert(FT_destroy() == INITIALIZATION_ERROR);
 
   /* After initialization, the data structure is empty, so
@@ -235,11 +866,162 @@ int main(void) {
   fprintf(stderr, "Checkpoint 4.5:\n%s\n", temp);
   free(temp);
 
+  /* the parallel representation is the same, however many threads */
+  assert((temp = FT_toString()) != NULL);
+  assert((temp2 = FT_toStringParallel(3)) != NULL);
+  assert(!strcmp(temp, temp2));
+  free(temp2);
+
+  /* so is the one written to a buffer, once there is room for it */
+  assert(FT_toStringLength() == strlen(temp));
+  assert(FT_toStringInto(arr, strlen(temp)) == BUFFER_TOO_SMALL);
+  assert(FT_toStringInto(arr, ARRLEN) == SUCCESS);
+  assert(!strcmp(arr, temp));
+  free(temp);
+
   assert(FT_destroy() == SUCCESS);
   assert(FT_destroy() == INITIALIZATION_ERROR);
   assert(FT_containsDir("1root") == FALSE);
   assert(FT_containsFile("1root") == FALSE);
   assert((temp = FT_toString()) == NULL);
 
+  /* Collapsing chains of single-child directories into one node
+     must not change the behavior of any other function, and can
+     only be selected while the data structure is uninitialized
+  */
+  assert(FT_setCompression(TRUE) == SUCCESS);
+  assert(FT_init() == SUCCESS);
+  assert(FT_setCompression(FALSE) == INITIALIZATION_ERROR);
+  assert(FT_insertDir("1root") == SUCCESS);
+  assert(FT_insertFile("1root/2a/3b/4c/5file", NULL, 0) == SUCCESS);
+  assert(FT_containsDir("1root/2a/3b") == TRUE);
+  assert(FT_containsFile("1root/2a/3b") == FALSE);
+  assert(FT_containsFile("1root/2a/3b/4c/5file") == TRUE);
+  assert(FT_insertDir("1root/2a/3b") == ALREADY_IN_TREE);
+  assert(FT_insertDir("1root/2a/3other") == SUCCESS);
+  assert(FT_rmFile("1root/2a/3b/4c") == NOT_A_FILE);
+  assert(FT_rmDir("1root/2a/3b/4c") == SUCCESS);
+  assert(FT_containsDir("1root/2a/3b") == TRUE);
+  assert(FT_containsDir("1root/2a/3b/4c") == FALSE);
+  assert((temp = FT_toString()) != NULL);
+  assert(!strcmp(temp,
+                 "1root\n1root/2a\n1root/2a/3b\n1root/2a/3other\n"));
+  free(temp);
+  assert(FT_destroy() == SUCCESS);
+  assert(FT_setCompression(FALSE) == SUCCESS);
+
+  /* Lookups must also work on paths deeper than the components a
+     PathView locates in advance, and with components that appear
+     nowhere in the tree
+  */
+  assert(FT_init() == SUCCESS);
+  assert(FT_insertDir("1root") == SUCCESS);
+  strcpy(arr, "1root");
+  for(l = 0; l < 40; l++)
+    strcat(arr, "/d");
+  assert(FT_insertFile(arr, NULL, 0) == SUCCESS);
+  assert(FT_containsFile(arr) == TRUE);
+  assert(FT_stat(arr, &bIsFile, &l) == SUCCESS);
+  assert(bIsFile == TRUE);
+  assert(FT_containsDir(arr) == FALSE);
+  arr[strlen(arr) - 2] = '\0';
+  assert(FT_containsDir(arr) == TRUE);
+  strcat(arr, "/neverSeen");
+  assert(FT_containsDir(arr) == FALSE);
+  assert(FT_stat(arr, &bIsFile, &l) == NO_SUCH_PATH);
+  assert(FT_stat("neverSeen/d", &bIsFile, &l) == CONFLICTING_PATH);
+  assert(FT_destroy() == SUCCESS);
+
+  /* Walks visit each directory and file once, including those that
+     a compressed node stands for, and can skip what is below one
+  */
+  assert(FT_setCompression(TRUE) == SUCCESS);
+  assert(FT_init() == SUCCESS);
+  assert(FT_iterNew("1root", FT_PREORDER, &oIter) == NO_SUCH_PATH);
+  assert(FT_insertDir("1root") == SUCCESS);
+  assert(FT_insertFile("1root/2a/3b/4file", "Kernighan",
+                       strlen("Kernighan")+1) == SUCCESS);
+  assert(FT_insertDir("1root/2z") == SUCCESS);
+  assert(FT_iterNew("1root/2a", FT_POSTORDER, &oIter) == SUCCESS);
+  assert(FT_iterNext(oIter, &sEntry) == SUCCESS);
+  assert(sEntry.bIsFile == TRUE && sEntry.ulDepth == 4);
+  assert(sEntry.ulSize == strlen("Kernighan")+1);
+  assert(FT_iterNext(oIter, &sEntry) == SUCCESS);
+  assert(sEntry.bIsFile == FALSE && !strcmp(sEntry.pcName, "3b"));
+  assert(sEntry.ulPathLength == strlen("1root/2a/3b"));
+  assert(FT_iterNext(oIter, &sEntry) == SUCCESS);
+  assert(!strncmp(sEntry.pcPath, "1root/2a", sEntry.ulPathLength));
+  assert(FT_iterNext(oIter, &sEntry) == NO_SUCH_PATH);
+  FT_iterFree(oIter);
+  assert(FT_iterNew("1root", FT_PREORDER, &oIter) == SUCCESS);
+  assert(FT_iterNext(oIter, &sEntry) == SUCCESS);
+  assert(FT_iterNext(oIter, &sEntry) == SUCCESS);
+  assert(!strcmp(sEntry.pcName, "2a"));
+  FT_iterPrune(oIter);
+  assert(FT_iterNext(oIter, &sEntry) == SUCCESS);
+  assert(!strcmp(sEntry.pcName, "2z"));
+  assert(FT_iterNext(oIter, &sEntry) == NO_SUCH_PATH);
+  FT_iterFree(oIter);
+
+  /* Listings interleave files and directories by name, a page at a
+     time */
+  assert(FT_insertFile("1root/2m", NULL, 0) == SUCCESS);
+  assert(FT_readdir("1root", NULL, 2, asEntries, &l, &pcCursor) ==
+         SUCCESS);
+  assert(l == 2 && !strcmp(asEntries[1].pcName, "2m"));
+  assert(asEntries[1].bIsFile == TRUE && pcCursor != NULL);
+  assert(FT_readdir("1root", pcCursor, 2, asEntries, &l, &pcCursor) ==
+         SUCCESS);
+  assert(l == 1 && !strcmp(asEntries[0].pcName, "2z"));
+  assert(pcCursor == NULL);
+  assert(FT_readdir("1root/2m", NULL, 2, asEntries, &l, &pcCursor) ==
+         NOT_A_DIRECTORY);
+  assert(FT_destroy() == SUCCESS);
+  assert(FT_setCompression(FALSE) == SUCCESS);
+
+  /* A deferred removal is reflected at once, however long the
+     subtree takes to free, and the same paths can be reused */
+  assert(FT_setDeferredRemoval(TRUE) == SUCCESS);
+  assert(FT_init() == SUCCESS);
+  assert(FT_setDeferredRemoval(FALSE) == INITIALIZATION_ERROR);
+  assert(FT_insertDir("1root/2a/3b") == SUCCESS);
+  assert(FT_insertFile("1root/2a/3c", NULL, 0) == SUCCESS);
+  assert(FT_insertDir("1root/2z") == SUCCESS);
+  assert(FT_rmDir("1root/2a") == SUCCESS);
+  assert(FT_containsDir("1root/2a") == FALSE);
+  assert(FT_toStringLength() == strlen("1root\n1root/2z\n"));
+  assert(FT_insertFile("1root/2a/3c", NULL, 0) == SUCCESS);
+  assert(FT_rmDir("1root") == SUCCESS);
+  assert(FT_toStringLength() == 0);
+  assert(FT_destroy() == SUCCESS);
+  assert(FT_setDeferredRemoval(FALSE) == SUCCESS);
+
+  /* Ranges visit what is from one path through another, with or
+     without compression */
+  test_range(FALSE);
+  test_range(TRUE);
+
+  /* Glob patterns match what they should, and FT_glob visits just the
+     matches, with or without compression */
+  test_glob_patterns();
+  test_glob(FALSE);
+  test_glob(TRUE);
+
+  /* Parallel walks visit, and fold in order, what FT_walk does,
+     however many threads they use */
+  test_parallel(FALSE);
+  test_parallel(TRUE);
+
+  /* FT_toString keeps up with each kind of change, with or without
+     compression and deferred removal */
+  test_to_string(FALSE, FALSE);
+  test_to_string(TRUE, FALSE);
+  test_to_string(FALSE, TRUE);
+  test_to_string(TRUE, TRUE);
+
+  /* The representation written to a file descriptor is the one
+     FT_toString returns */
+  test_write_to();
+
   return 0;
 }
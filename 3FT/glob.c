@@ -0,0 +1,287 @@
+/*--------------------------------------------------------------------*/
+/* glob.c                                                             */
+/* Author: Josh Schoenberg and Jack Toubes                            */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "glob.h"
+
+/* A component of a compiled pattern. */
+struct GlobComponent {
+   /* The component as written, '\0'-terminated */
+   const char *pcText;
+   /* The characters that begin every name it matches, unescaped */
+   const char *pcPrefix;
+   /* Whether it matches only the name pcPrefix */
+   boolean bWhole;
+   /* Whether it is "**", matching any number of components */
+   boolean bAnyDepth;
+};
+
+/* A compiled pattern. State i of it means that components before the
+   i'th have matched, so state ulLength means that all have. */
+struct Glob {
+   /* The number of components */
+   size_t ulLength;
+   /* The components' text followed by their prefixes */
+   char *pcBuffer;
+   /* The components */
+   struct GlobComponent asComponents[GLOB_MAX_COMPONENTS];
+};
+
+/*--------------------------------------------------------------------*/
+
+/*
+  Returns TRUE if the single character that the start of pcPattern
+  (which must not be empty) stands for matches c, or FALSE otherwise,
+  and stores in *pulLength how many characters of pcPattern stand
+  for it.
+*/
+static boolean Glob_matchChar(const char *pcPattern, char c,
+                              size_t *pulLength) {
+   const char *pcNext;
+   boolean bNegate = FALSE;
+   boolean bMatch = FALSE;
+   unsigned char ucLow, ucHigh;
+
+   assert(pcPattern != NULL);
+   assert(*pcPattern != '\0');
+   assert(pulLength != NULL);
+
+   *pulLength = 1;
+   switch(*pcPattern) {
+      case '?':
+         return TRUE;
+      case '\\':
+         if(pcPattern[1] == '\0')
+            return (boolean) (c == '\\');
+         *pulLength = 2;
+         return (boolean) (c == pcPattern[1]);
+      case '[':
+         break;
+      default:
+         return (boolean) (c == *pcPattern);
+   }
+
+   /* a bracket expression; a ']' right after the opening bracket
+      is one of the characters, '\' escapes the character after it,
+      and a '[' never closed is literal */
+   pcNext = pcPattern + 1;
+   if(*pcNext == '!' || *pcNext == '^') {
+      bNegate = TRUE;
+      pcNext++;
+   }
+   do {
+      if(*pcNext == '\\' && pcNext[1] != '\0')
+         pcNext++;
+      if(*pcNext == '\0')
+         return (boolean) (c == '[');
+      ucLow = (unsigned char) *pcNext;
+      ucHigh = ucLow;
+      pcNext++;
+      if(*pcNext == '-' && pcNext[1] != ']' && pcNext[1] != '\0') {
+         pcNext++;
+         if(*pcNext == '\\' && pcNext[1] != '\0')
+            pcNext++;
+         ucHigh = (unsigned char) *pcNext;
+         pcNext++;
+      }
+      if(ucLow <= (unsigned char) c && (unsigned char) c <= ucHigh)
+         bMatch = TRUE;
+   } while(*pcNext != ']');
+
+   *pulLength = (size_t) (pcNext + 1 - pcPattern);
+   return (boolean) (bMatch != bNegate);
+}
+
+/*
+  Returns TRUE if the component pattern pcPattern matches pcName, or
+  FALSE otherwise.
+*/
+static boolean Glob_matchComponent(const char *pcPattern,
+                                   const char *pcName) {
+   /* where to try again if what follows the last '*' fails to match:
+      the pattern after it, and the name one character further on */
+   const char *pcAfterStar = NULL;
+   const char *pcRetry = NULL;
+   size_t ulLength;
+
+   assert(pcPattern != NULL);
+   assert(pcName != NULL);
+
+   while(*pcName != '\0') {
+      if(*pcPattern == '*') {
+         while(*pcPattern == '*')
+            pcPattern++;
+         pcAfterStar = pcPattern;
+         pcRetry = pcName;
+      }
+      else if(*pcPattern != '\0' &&
+              Glob_matchChar(pcPattern, *pcName, &ulLength)) {
+         pcPattern += ulLength;
+         pcName++;
+      }
+      else if(pcAfterStar != NULL) {
+         /* let the last '*' match one more character */
+         pcPattern = pcAfterStar;
+         pcName = ++pcRetry;
+      }
+      else
+         return FALSE;
+   }
+
+   while(*pcPattern == '*')
+      pcPattern++;
+   return (boolean) (*pcPattern == '\0');
+}
+
+/*
+  Returns ulStates together with the states of oGlob that follow
+  from them by letting a "**" match no components.
+*/
+static unsigned long Glob_close(Glob_T oGlob, unsigned long ulStates) {
+   size_t i;
+
+   assert(oGlob != NULL);
+
+   for(i = 0; i < oGlob->ulLength; i++)
+      if((ulStates >> i & 1UL) && oGlob->asComponents[i].bAnyDepth)
+         ulStates |= 1UL << (i + 1);
+   return ulStates;
+}
+
+/*--------------------------------------------------------------------*/
+
+int Glob_new(const char *pcPattern, Glob_T *poGlob) {
+   struct Glob *psGlob;
+   struct GlobComponent *psComponent;
+   size_t ulSize;
+   char *pcText, *pcPrefix;
+   const char *pcIn;
+
+   assert(pcPattern != NULL);
+   assert(poGlob != NULL);
+
+   *poGlob = NULL;
+   ulSize = strlen(pcPattern) + 1;
+   if(*pcPattern == '/' || *pcPattern == '\0' ||
+      pcPattern[ulSize - 2] == '/' || strstr(pcPattern, "//") != NULL)
+      return BAD_PATH;
+
+   psGlob = malloc(sizeof(struct Glob));
+   if(psGlob == NULL)
+      return MEMORY_ERROR;
+   psGlob->pcBuffer = malloc(2 * ulSize);
+   if(psGlob->pcBuffer == NULL) {
+      free(psGlob);
+      return MEMORY_ERROR;
+   }
+
+   /* each component's text is split off in place, and its prefix is
+      written after all of them */
+   pcText = strcpy(psGlob->pcBuffer, pcPattern);
+   pcPrefix = psGlob->pcBuffer + ulSize;
+   psGlob->ulLength = 0;
+   for(;;) {
+      if(psGlob->ulLength == GLOB_MAX_COMPONENTS) {
+         Glob_free(psGlob);
+         return BAD_PATH;
+      }
+      psComponent = &psGlob->asComponents[psGlob->ulLength];
+      psGlob->ulLength++;
+
+      psComponent->pcText = pcText;
+      pcText += strcspn(pcText, "/");
+      psComponent->bAnyDepth =
+         (boolean) (pcText - psComponent->pcText == 2 &&
+                    strncmp(psComponent->pcText, "**", 2) == 0);
+
+      psComponent->pcPrefix = pcPrefix;
+      for(pcIn = psComponent->pcText; pcIn != pcText &&
+          strchr("*?[", *pcIn) == NULL; pcIn++) {
+         if(*pcIn == '\\' && pcIn + 1 != pcText)
+            pcIn++;
+         *pcPrefix++ = *pcIn;
+      }
+      *pcPrefix++ = '\0';
+      psComponent->bWhole = (boolean) (pcIn == pcText);
+
+      if(*pcText == '\0')
+         break;
+      *pcText++ = '\0';
+   }
+
+   *poGlob = psGlob;
+   return SUCCESS;
+}
+
+void Glob_free(Glob_T oGlob) {
+   assert(oGlob != NULL);
+
+   free(oGlob->pcBuffer);
+   free(oGlob);
+}
+
+unsigned long Glob_start(Glob_T oGlob) {
+   assert(oGlob != NULL);
+
+   return Glob_close(oGlob, 1UL);
+}
+
+unsigned long Glob_step(Glob_T oGlob, unsigned long ulStates,
+                        const char *pcName) {
+   const struct GlobComponent *psComponent;
+   unsigned long ulNext = 0;
+   size_t i;
+
+   assert(oGlob != NULL);
+   assert(pcName != NULL);
+
+   for(i = 0; i < oGlob->ulLength; i++) {
+      if(!(ulStates >> i & 1UL))
+         continue;
+      psComponent = &oGlob->asComponents[i];
+      if(psComponent->bAnyDepth)
+         ulNext |= 1UL << i;
+      else if(psComponent->bWhole ?
+              strcmp(psComponent->pcPrefix, pcName) == 0 :
+              Glob_matchComponent(psComponent->pcText, pcName))
+         ulNext |= 1UL << (i + 1);
+   }
+   return Glob_close(oGlob, ulNext);
+}
+
+boolean Glob_accepts(Glob_T oGlob, unsigned long ulStates) {
+   assert(oGlob != NULL);
+
+   return (boolean) (ulStates >> oGlob->ulLength & 1UL);
+}
+
+const char *Glob_getPrefix(Glob_T oGlob, unsigned long ulStates,
+                           boolean *pbWhole) {
+   const struct GlobComponent *psComponent;
+   unsigned long ulLive;
+   size_t i;
+
+   assert(oGlob != NULL);
+   assert(pbWhole != NULL);
+
+   *pbWhole = FALSE;
+   ulLive = ulStates & ((1UL << oGlob->ulLength) - 1);
+   if(ulLive == 0)
+      return NULL;
+
+   /* only a set of one state narrows down the names */
+   if((ulLive & (ulLive - 1)) != 0)
+      return "";
+   for(i = 0; !(ulLive >> i & 1UL); i++)
+      ;
+   psComponent = &oGlob->asComponents[i];
+   if(psComponent->bAnyDepth)
+      return "";
+   *pbWhole = psComponent->bWhole;
+   return psComponent->pcPrefix;
+}
@@ -0,0 +1,72 @@
+/*--------------------------------------------------------------------*/
+/* glob.h                                                             */
+/* Author: Josh Schoenberg and Jack Toubes                            */
+/*--------------------------------------------------------------------*/
+
+#ifndef GLOB_INCLUDED
+#define GLOB_INCLUDED
+
+#include <stddef.h>
+#include "a4def.h"
+
+/*
+  A Glob_T is a compiled glob pattern for absolute paths. A pattern is
+  written as a path is, as components separated by '/'. A component
+  that is exactly "**" matches any number of components, including
+  none. In any other component, '*' matches any run of characters,
+  '?' matches any one character, "[...]" matches any one character
+  in the brackets (or, if they begin with '!' or '^', any one not in
+  them, with ranges such as "a-z" allowed), and '\' makes the
+  character after it match only itself; every other character
+  matches only itself.
+
+  A path is matched one component at a time, from a set of states
+  that says how much of the pattern the components so far have
+  matched in the ways that they can. Such a set is an unsigned long,
+  so a pattern has at most GLOB_MAX_COMPONENTS components.
+*/
+typedef struct Glob *Glob_T;
+
+enum { GLOB_MAX_COMPONENTS = 31 };
+
+/*
+  Compiles the glob pattern pcPattern. Returns SUCCESS and sets
+  *poGlob to the new Glob_T if successful. Otherwise, sets *poGlob to
+  NULL and returns status:
+  * BAD_PATH if pcPattern is the empty string
+             or begins with or ends with a '/'
+             or contains consecutive '/' delimiters
+             or has more than GLOB_MAX_COMPONENTS components
+  * MEMORY_ERROR if memory could not be allocated to complete request
+*/
+int Glob_new(const char *pcPattern, Glob_T *poGlob);
+
+/* Frees oGlob. */
+void Glob_free(Glob_T oGlob);
+
+/* Returns the set of states of oGlob before any component. */
+unsigned long Glob_start(Glob_T oGlob);
+
+/*
+  Returns the set of states of oGlob after a component named pcName
+  from the set ulStates. Returns 0 if no path that goes on that way
+  can match.
+*/
+unsigned long Glob_step(Glob_T oGlob, unsigned long ulStates,
+                        const char *pcName);
+
+/* Returns TRUE if the set of states ulStates of oGlob is one that a
+   path matching the pattern ends in, or FALSE otherwise. */
+boolean Glob_accepts(Glob_T oGlob, unsigned long ulStates);
+
+/*
+  Returns the characters that begin every name of a component that
+  Glob_step can take from ulStates to a nonempty set, as a string that
+  belongs to oGlob: "" if a name can begin with anything, or NULL if
+  no name can take such a step. Sets *pbWhole to TRUE if the string
+  is the only such name, or FALSE otherwise.
+*/
+const char *Glob_getPrefix(Glob_T oGlob, unsigned long ulStates,
+                           boolean *pbWhole);
+
+#endif
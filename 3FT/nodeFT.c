@@ -3,7 +3,7 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
-#include "dynarray.h"
+#include "childarray.h"
 #include "nodeFT.h"
 #include "checkerFT.h"
 #include <stdio.h>
@@ -20,9 +20,27 @@ struct node {
    Path_T oPPath;
    /* this node's parent */
    Node_T oNParent;
-   /* the object containing links to this node's children */
-   /* must be NULL if a file */
-   DynArray_T oDChildren;
+   /* the objects containing links to this node's children, keyed by
+      their first path component below this node: one for the files
+      directly below this node, allocated with the first of them so
+      that files and directories without files do not pay for it, and
+      one for the directories, including children that stand for a
+      chain of directories, which holds the first few without
+      allocating memory */
+   /* must be NULL and empty if a file */
+   ChildArray_T oFiles;
+   struct ChildArray sDirs;
+   /* the number of directories and files in this node's subtree,
+      counting those that nodes in it stand for, and the length of
+      their lines in the string representation of the FT */
+   size_t ulSubtreeCount;
+   size_t ulTextLength;
+   /* where the lines of this node's subtree began in the string
+      representation of the FT last generated, relative to where the
+      lines of its parent's children did; only meaningful while
+      bTextValid, which a change anywhere in the subtree clears */
+   size_t ulTextOffset;
+   boolean bTextValid;
 };
 
 /*
@@ -81,12 +99,104 @@ void * Node_replaceContents(Node_T oNNode, void * pvNewContents,
 }
 
 /*
-  Links new child oNChild into oNParent's children array at index
-  ulIndex. Returns SUCCESS if the new child was added successfully,
-  or  MEMORY_ERROR if allocation fails adding oNChild to the array.
+  Returns the depth of oNNode's parent's path, or 0 for the root.
 */
-static int Node_addChild(Node_T oNParent, Node_T oNChild,
-                         size_t ulIndex) {
+static size_t Node_getParentDepth(Node_T oNNode) {
+   assert(oNNode != NULL);
+
+   if(oNNode->oNParent == NULL)
+      return 0;
+   return Path_getDepth(oNNode->oNParent->oPPath);
+}
+
+/*
+  Returns the key of oNNode in its parent's children array: the
+  component of its path at level ulLevel, the parent's depth.
+*/
+static const char *Node_getKey(Node_T oNNode, size_t ulLevel) {
+   assert(oNNode != NULL);
+
+   return Path_getComponent(oNNode->oPPath, ulLevel);
+}
+
+/*
+  Adds the count and length of the subtree rooted at oNChild to those
+  of oNParent and each of its ancestors (if bLinked), or subtracts
+  them (otherwise), as oNChild is linked below oNParent or unlinked,
+  and marks their cached lines as out of date.
+*/
+static void Node_updateAncestors(Node_T oNParent, Node_T oNChild,
+                                 boolean bLinked) {
+   assert(oNChild != NULL);
+
+   while(oNParent != NULL) {
+      if(bLinked) {
+         oNParent->ulSubtreeCount += oNChild->ulSubtreeCount;
+         oNParent->ulTextLength += oNChild->ulTextLength;
+      }
+      else {
+         oNParent->ulSubtreeCount -= oNChild->ulSubtreeCount;
+         oNParent->ulTextLength -= oNChild->ulTextLength;
+      }
+      oNParent->bTextValid = FALSE;
+      oNParent = oNParent->oNParent;
+   }
+}
+
+/*
+  Returns the children array of oNParent that holds, or would hold,
+  oNChild: the files array if oNChild is a file directly below
+  oNParent, which is allocated if oNParent has none yet, or the
+  directories array otherwise. oNChild's parent need not be set yet.
+  Returns NULL if memory could not be allocated.
+*/
+static ChildArray_T Node_getChildArray(Node_T oNParent,
+                                       Node_T oNChild) {
+   assert(oNParent != NULL);
+   assert(oNChild != NULL);
+
+   if(oNChild->bisFile && Path_getDepth(oNChild->oPPath) ==
+                          Path_getDepth(oNParent->oPPath) + 1) {
+      if(oNParent->oFiles == NULL)
+         oNParent->oFiles = ChildArray_new();
+      return oNParent->oFiles;
+   }
+   return &oNParent->sDirs;
+}
+
+/*
+  Returns the children array of oNParent that holds the child with
+  identifier ulChildID, and sets *pulIndex to its index there.
+*/
+static ChildArray_T Node_locateChild(Node_T oNParent, size_t ulChildID,
+                                     size_t *pulIndex) {
+   size_t ulFiles;
+
+   assert(oNParent != NULL);
+   assert(pulIndex != NULL);
+
+   /* the files come first, then the directories */
+   ulFiles = Node_getNumFiles(oNParent);
+   if(ulChildID < ulFiles) {
+      *pulIndex = ulChildID;
+      return oNParent->oFiles;
+   }
+   *pulIndex = ulChildID - ulFiles;
+   return &oNParent->sDirs;
+}
+
+/*
+  Links new child oNChild, whose parent must not yet have a child on
+  its branch, into the right one of oNParent's children arrays.
+  Returns SUCCESS if the new child was added successfully, or
+  MEMORY_ERROR if allocation fails adding oNChild to the array.
+*/
+static int Node_addChild(Node_T oNParent, Node_T oNChild) {
+   ChildArray_T oChildren;
+   const char *pcKey;
+   size_t ulIndex;
+   int iFound;
+
    assert(oNParent != NULL);
    assert(oNChild != NULL);
 
@@ -94,144 +204,155 @@ static int Node_addChild(Node_T oNParent, Node_T oNChild,
    {
       return NOT_A_DIRECTORY;
    }
-   
 
-   if(DynArray_addAt(oNParent->oDChildren, ulIndex, oNChild))
+   oChildren = Node_getChildArray(oNParent, oNChild);
+   if(oChildren == NULL)
+      return MEMORY_ERROR;
+   pcKey = Node_getKey(oNChild, Path_getDepth(oNParent->oPPath));
+   iFound = ChildArray_bsearch(oChildren, pcKey, &ulIndex);
+   assert(!iFound);
+   (void) iFound;
+
+   if(ChildArray_addAt(oChildren, ulIndex, pcKey, oNChild))
       return SUCCESS;
    else
       return MEMORY_ERROR;
 }
 
 /*
-  Compares the string representation of oNfirst with a string
-  pcSecond representing a node's path.
-  Returns <0, 0, or >0 if oNFirst is "less than", "equal to", or
-  "greater than" pcSecond, respectively.
+  Allocates a node with a copy of path oPPath that is not yet linked
+  to any parent. If bIsFile, the node is a file containing pvContents
+  of length ulContentsSize; otherwise it is an empty directory.
+  Returns NULL if memory could not be allocated.
 */
-static int Node_compareString(const Node_T oNFirst,
-                                 const char *pcSecond) {
-   assert(oNFirst != NULL);
-   assert(pcSecond != NULL);
+static Node_T Node_alloc(Path_T oPPath, boolean bIsFile,
+                         void *pvContents, size_t ulContentsSize) {
+   struct node *psNew;
+   Path_T oPNewPath = NULL;
+
+   assert(oPPath != NULL);
+
+   psNew = malloc(sizeof(struct node));
+   if(psNew == NULL)
+      return NULL;
+
+   if(Path_dup(oPPath, &oPNewPath) != SUCCESS) {
+      free(psNew);
+      return NULL;
+   }
+   psNew->oPPath = oPNewPath;
+   psNew->oNParent = NULL;
+
+   /* File cannot have children */
+   psNew->oFiles = NULL;
+   ChildArray_init(&psNew->sDirs);
+   if(bIsFile) {
+      psNew->pvFileContents = pvContents;
+      psNew->ulContentsLength = ulContentsSize;
+   }
+   else {
+      psNew->pvFileContents = NULL;
+      psNew->ulContentsLength = 0;
+   }
+   psNew->bisFile = bIsFile;
+   psNew->ulSubtreeCount = 0;
+   psNew->ulTextLength = 0;
+   psNew->ulTextOffset = 0;
+   psNew->bTextValid = FALSE;
 
-   return Path_compareString(oNFirst->oPPath, pcSecond);
+   return psNew;
 }
 
+/*
+  Frees oNNode's own memory, without touching its parent or
+  children.
+*/
+static void Node_release(Node_T oNNode) {
+   assert(oNNode != NULL);
+
+   if(oNNode->oFiles != NULL)
+      ChildArray_free(oNNode->oFiles);
+   ChildArray_destroy(&oNNode->sDirs);
+   Path_free(oNNode->oPPath);
+   free(oNNode);
+}
 
 /*
-  Creates a new dir with path oPPath and parent oNParent.  Returns an
-  int SUCCESS status and sets *poNResult to be the new node if
-  successful. Otherwise, sets *poNResult to NULL and returns status:
+  Creates a new node with path oPPath and parent oNParent, as a file
+  with pvContents of length ulContentsSize if bIsFile or as a
+  directory otherwise. oPPath may be several levels below oNParent's
+  path, in which case the new node also stands for the single-child
+  directories in between. Returns an int SUCCESS status and sets
+  *poNResult to be the new node if successful. Otherwise, sets
+  *poNResult to NULL and returns status:
   * MEMORY_ERROR if memory could not be allocated to complete request
   * CONFLICTING_PATH if oNParent's path is not an ancestor of oPPath
-  * NO_SUCH_PATH if oPPath is of depth 0
-                 or oNParent's path is not oPPath's direct parent
-                 or oNParent is NULL but oPPath is not of depth 1
-  * ALREADY_IN_TREE if oNParent already has a child with this path
+  * NO_SUCH_PATH if oPPath is no deeper than oNParent's path
+  * ALREADY_IN_TREE if oNParent already has a child on oPPath's branch
   * NOT_A_DIRECTORY if oNParent is a file
 */
-int Node_dir_new(Path_T oPPath, Node_T oNParent, Node_T *poNResult) {
-   struct node *psNew;
-   Path_T oPParentPath = NULL;
-   Path_T oPNewPath = NULL;
-   size_t ulParentDepth;
+static int Node_new(Path_T oPPath, Node_T oNParent, boolean bIsFile,
+                    void *pvContents, size_t ulContentsSize,
+                    Node_T *poNResult) {
+   Node_T oNNew;
    size_t ulIndex = 0;
    int iStatus;
 
    assert(oPPath != NULL);
+   assert(poNResult != NULL);
    assert(oNParent == NULL || CheckerFT_Node_isValid(oNParent));
 
-   /* allocate space for a new node */
-   psNew = malloc(sizeof(struct node));
-   if(psNew == NULL) {
-      *poNResult = NULL;
-      return MEMORY_ERROR;
-   }
-
-   /* set the new node's path */
-   iStatus = Path_dup(oPPath, &oPNewPath);
-   if(iStatus != SUCCESS) {
-      free(psNew);
-      *poNResult = NULL;
-      return iStatus;
-   }
-   psNew->oPPath = oPNewPath;
-
-   /* validate and set the new node's parent */
+   /* validate the new node's parent */
    if(oNParent != NULL) {
-      size_t ulSharedDepth;
+      size_t ulParentDepth = Path_getDepth(oNParent->oPPath);
 
-      oPParentPath = oNParent->oPPath;
-      ulParentDepth = Path_getDepth(oPParentPath);
-      ulSharedDepth = Path_getSharedPrefixDepth(psNew->oPPath,
-                                                oPParentPath);
       /* parent must be an ancestor of child */
-      if(ulSharedDepth < ulParentDepth) {
-         Path_free(psNew->oPPath);
-         free(psNew);
+      if(Path_getSharedPrefixDepth(oPPath, oNParent->oPPath)
+         < ulParentDepth) {
          *poNResult = NULL;
          return CONFLICTING_PATH;
       }
 
       /* parent must be a directory */
       if(oNParent->bisFile) {
-         Path_free(psNew->oPPath);
-         free(psNew);
          *poNResult = NULL;
          return NOT_A_DIRECTORY;
       }
 
-      /* parent must be exactly one level up from child */
-      if(Path_getDepth(psNew->oPPath) != ulParentDepth + 1) {
-         Path_free(psNew->oPPath);
-         free(psNew);
+      /* parent must be above child */
+      if(Path_getDepth(oPPath) <= ulParentDepth) {
          *poNResult = NULL;
          return NO_SUCH_PATH;
       }
 
-      /* parent must not already have child with this path */
+      /* parent must not already have child on this branch */
       if(Node_hasChild(oNParent, oPPath, &ulIndex)) {
-         Path_free(psNew->oPPath);
-         free(psNew);
          *poNResult = NULL;
          return ALREADY_IN_TREE;
       }
    }
-   else {
-      /* new node must be root */
-      /* can only create one "level" at a time */
-      if(Path_getDepth(psNew->oPPath) != 1) {
-         Path_free(psNew->oPPath);
-         free(psNew);
-         *poNResult = NULL;
-         return NO_SUCH_PATH;
-      }
-   }
-   psNew->oNParent = oNParent;
 
-   /* initialize the new node */
-   psNew->oDChildren = DynArray_new(0);
-   if(psNew->oDChildren == NULL) {
-      Path_free(psNew->oPPath);
-      free(psNew);
+   oNNew = Node_alloc(oPPath, bIsFile, pvContents, ulContentsSize);
+   if(oNNew == NULL) {
       *poNResult = NULL;
       return MEMORY_ERROR;
    }
-   psNew->pvFileContents = NULL;
-   psNew->ulContentsLength = 0;
-   psNew->bisFile = FALSE;
+   oNNew->oNParent = oNParent;
+   oNNew->ulSubtreeCount = Node_getEdgeDepth(oNNew);
+   oNNew->ulTextLength = Node_getLinesLength(oNNew);
 
    /* Link into parent's children list */
    if(oNParent != NULL) {
-      iStatus = Node_addChild(oNParent, psNew, ulIndex);
+      iStatus = Node_addChild(oNParent, oNNew);
       if(iStatus != SUCCESS) {
-         Path_free(psNew->oPPath);
-         free(psNew);
+         Node_release(oNNew);
          *poNResult = NULL;
          return iStatus;
       }
+      Node_updateAncestors(oNParent, oNNew, TRUE);
    }
 
-   *poNResult = psNew;
+   *poNResult = oNNew;
 
    assert(oNParent == NULL || CheckerFT_Node_isValid(oNParent));
    assert(CheckerFT_Node_isValid(*poNResult));
@@ -239,6 +360,23 @@ int Node_dir_new(Path_T oPPath, Node_T oNParent, Node_T *poNResult) {
    return SUCCESS;
 }
 
+/*
+  Creates a new dir with path oPPath and parent oNParent.  Returns an
+  int SUCCESS status and sets *poNResult to be the new node if
+  successful. Otherwise, sets *poNResult to NULL and returns status:
+  * MEMORY_ERROR if memory could not be allocated to complete request
+  * CONFLICTING_PATH if oNParent's path is not an ancestor of oPPath
+  * NO_SUCH_PATH if oPPath is no deeper than oNParent's path
+  * ALREADY_IN_TREE if oNParent already has a child on oPPath's branch
+  * NOT_A_DIRECTORY if oNParent is a file
+*/
+int Node_dir_new(Path_T oPPath, Node_T oNParent, Node_T *poNResult) {
+   assert(oPPath != NULL);
+   assert(poNResult != NULL);
+
+   return Node_new(oPPath, oNParent, FALSE, NULL, 0, poNResult);
+}
+
 /*
   Creates a new file with path oPPath parent oNParent, containing
   pvContents and content length of ulContentSize. Returns an
@@ -246,159 +384,172 @@ int Node_dir_new(Path_T oPPath, Node_T oNParent, Node_T *poNResult) {
   successful. Otherwise, sets *poNResult to NULL and returns status:
   * MEMORY_ERROR if memory could not be allocated to complete request
   * CONFLICTING_PATH if oNParent's path is not an ancestor of oPPath
-  * NO_SUCH_PATH if oPPath is of depth 0
-                 or oNParent's path is not oPPath's direct parent
-                 or oNParent is NULL but oPPath is not of depth 1
-  * ALREADY_IN_TREE if oNParent already has a child with this path
+                     or if oPPath is of depth 1
+  * NO_SUCH_PATH if oPPath is no deeper than oNParent's path
+                 or oNParent is NULL
+  * ALREADY_IN_TREE if oNParent already has a child on oPPath's branch
   * NOT_A_DIRECTORY if oNParent is a file
 */
 int Node_file_new(Path_T oPPath, Node_T oNParent, Node_T *poNResult,
                      void * pvContents, size_t ulContentsSize) {
-
-   struct node *psNew;
-   Path_T oPParentPath = NULL;
-   Path_T oPNewPath = NULL;
-   size_t ulParentDepth;
-   size_t ulIndex = 0;
-   int iStatus;
-
    assert(oPPath != NULL);
-   assert(oNParent == NULL || CheckerFT_Node_isValid(oNParent));
+   assert(poNResult != NULL);
 
-   /* allocate space for a new node */
-   psNew = malloc(sizeof(struct node));
-   if(psNew == NULL) {
+   /* File cannot be the root */
+   if(Path_getDepth(oPPath) == 1) {
       *poNResult = NULL;
-      return MEMORY_ERROR;
+      return CONFLICTING_PATH;
    }
-
-   /* set the new node's path */
-   iStatus = Path_dup(oPPath, &oPNewPath);
-   if(iStatus != SUCCESS) {
-      free(psNew);
+   if(oNParent == NULL) {
       *poNResult = NULL;
-      return iStatus;
-   }
-   psNew->oPPath = oPNewPath;
-
-   /* File cannot be the root */
-   if (Path_getDepth(psNew->oPPath) == 1)
-   {
-      return CONFLICTING_PATH;
+      return NO_SUCH_PATH;
    }
 
-   /* validate and set the new node's parent */
-   if(oNParent != NULL) {
-      size_t ulSharedDepth;
-
-      oPParentPath = oNParent->oPPath;
-      ulParentDepth = Path_getDepth(oPParentPath);
-      ulSharedDepth = Path_getSharedPrefixDepth(psNew->oPPath,
-                                                oPParentPath);
-      /* parent must be an ancestor of child */
-      if(ulSharedDepth < ulParentDepth) {
-         Path_free(psNew->oPPath);
-         free(psNew);
-         *poNResult = NULL;
-         return CONFLICTING_PATH;
-      }
+   return Node_new(oPPath, oNParent, TRUE, pvContents, ulContentsSize,
+                   poNResult);
+}
 
-      /* parent must be a directory */
-      if(oNParent->bisFile) {
-         Path_free(psNew->oPPath);
-         free(psNew);
-         *poNResult = NULL;
-         return NOT_A_DIRECTORY;
-      }
+int Node_split(Node_T oNNode, size_t ulDepth, Node_T *poNResult) {
+   Node_T oNUpper;
+   ChildArray_T oChildren;
+   Path_T oPPrefix = NULL;
+   size_t ulIndex = 0;
+   int iStatus;
 
-      /* parent must be exactly one level up from child */
-      if(Path_getDepth(psNew->oPPath) != ulParentDepth + 1) {
-         Path_free(psNew->oPPath);
-         free(psNew);
-         *poNResult = NULL;
-         return NO_SUCH_PATH;
-      }
+   assert(oNNode != NULL);
+   assert(poNResult != NULL);
+   assert(ulDepth > Node_getParentDepth(oNNode));
+   assert(ulDepth < Path_getDepth(oNNode->oPPath));
 
-      /* parent must not already have child with this path */
-      if(Node_hasChild(oNParent, oPPath, &ulIndex)) {
-         Path_free(psNew->oPPath);
-         free(psNew);
-         *poNResult = NULL;
-         return ALREADY_IN_TREE;
-      }
-   }
-   else {
-      /* new file cannot be root */
-      Path_free(psNew->oPPath);
-      free(psNew);
+   iStatus = Path_prefix(oNNode->oPPath, ulDepth, &oPPrefix);
+   if(iStatus != SUCCESS) {
       *poNResult = NULL;
-      return NO_SUCH_PATH;
+      return iStatus;
    }
-   psNew->oNParent = oNParent;
 
-   /* initialize the new node */
-   /* File cannot have children */
-   psNew->oDChildren = NULL;
-   psNew->pvFileContents = pvContents;
-   psNew->ulContentsLength = ulContentsSize;
-   psNew->bisFile = TRUE;
+   oNUpper = Node_alloc(oPPrefix, FALSE, NULL, 0);
+   Path_free(oPPrefix);
+   if(oNUpper == NULL) {
+      *poNResult = NULL;
+      return MEMORY_ERROR;
+   }
 
+   oChildren = Node_getChildArray(oNUpper, oNNode);
+   if(oChildren == NULL ||
+      !ChildArray_addAt(oChildren, 0, Node_getKey(oNNode, ulDepth),
+                        oNNode)) {
+      Node_release(oNUpper);
+      *poNResult = NULL;
+      return MEMORY_ERROR;
+   }
 
-   /* Link into parent's children list */
-   if(oNParent != NULL) {
-      iStatus = Node_addChild(oNParent, psNew, ulIndex);
-      if(iStatus != SUCCESS) {
-         Path_free(psNew->oPPath);
-         free(psNew);
-         *poNResult = NULL;
-         return iStatus;
-      }
+   /* the upper node takes oNNode's place: it has the same first
+      component and, like oNNode, is among the directories, so its
+      position among the siblings is unchanged */
+   oNUpper->oNParent = oNNode->oNParent;
+   if(oNNode->oNParent != NULL) {
+      ChildArray_T oSiblings;
+      boolean bFound = Node_hasChild(oNNode->oNParent, oNNode->oPPath,
+                                     &ulIndex);
+      assert(bFound);
+      (void) bFound;
+      oSiblings = Node_locateChild(oNNode->oNParent, ulIndex, &ulIndex);
+      assert(oSiblings == &oNNode->oNParent->sDirs);
+      (void) ChildArray_set(oSiblings, ulIndex,
+                Node_getKey(oNUpper, Node_getParentDepth(oNUpper)),
+                oNUpper);
    }
+   oNNode->oNParent = oNUpper;
+
+   /* the upper node's subtree is what oNNode's was, with the same
+      lines, and oNNode's, which now lacks the directories the upper
+      node stands for, begins where the lines of its children do */
+   oNUpper->ulSubtreeCount = oNNode->ulSubtreeCount;
+   oNUpper->ulTextLength = oNNode->ulTextLength;
+   oNUpper->ulTextOffset = oNNode->ulTextOffset;
+   oNUpper->bTextValid = oNNode->bTextValid;
+   oNNode->ulSubtreeCount -= Node_getEdgeDepth(oNUpper);
+   oNNode->ulTextLength -= Node_getLinesLength(oNUpper);
+   oNNode->ulTextOffset = 0;
+
+   *poNResult = oNUpper;
+
+   assert(CheckerFT_Node_isValid(oNUpper));
+   assert(CheckerFT_Node_isValid(oNNode));
 
-   *poNResult = psNew;
+   return SUCCESS;
+}
 
-   assert(oNParent == NULL || CheckerFT_Node_isValid(oNParent));
-   assert(CheckerFT_Node_isValid(*poNResult));
+/*
+  Frees the subtree rooted at oNNode without unlinking oNNode from its
+  parent, whose children array the caller updates.
+*/
+static void Node_freeSubtree(Node_T oNNode) {
+   size_t ulIndex;
 
-   return SUCCESS;
+   assert(oNNode != NULL);
+
+   /* free every child, then drop them from the arrays all at once
+      rather than shifting the rest down after each one */
+   for(ulIndex = 0; ulIndex < Node_getNumFiles(oNNode); ulIndex++)
+      Node_freeSubtree(ChildArray_get(oNNode->oFiles, ulIndex));
+   if(oNNode->oFiles != NULL)
+      ChildArray_clear(oNNode->oFiles);
+   for(ulIndex = 0; ulIndex < ChildArray_getLength(&oNNode->sDirs);
+       ulIndex++)
+      Node_freeSubtree(ChildArray_get(&oNNode->sDirs, ulIndex));
+   ChildArray_clear(&oNNode->sDirs);
+
+   /* finally, free the struct node and its path */
+   Node_release(oNNode);
 }
 
-size_t Node_free(Node_T oNNode) {
+size_t Node_detach(Node_T oNNode) {
    size_t ulIndex;
-   size_t ulCount = 0;
 
    assert(oNNode != NULL);
-   assert(CheckerFT_Node_isValid(oNNode));
 
    /* remove from parent's list */
    if(oNNode->oNParent != NULL) {
-      if(DynArray_bsearch(
-            oNNode->oNParent->oDChildren,
-            oNNode, &ulIndex,
-            (int (*)(const void *, const void *)) Node_compare)
-        )
-         (void) DynArray_removeAt(oNNode->oNParent->oDChildren,
-                                  ulIndex);
-   }
-
-   /* recursively remove children */
-   if (!(oNNode->bisFile))
-   {  
-      while(DynArray_getLength(oNNode->oDChildren) != 0) {
-         ulCount += Node_free(DynArray_get(oNNode->oDChildren, 0));
+      Node_updateAncestors(oNNode->oNParent, oNNode, FALSE);
+      if(Node_hasChild(oNNode->oNParent, oNNode->oPPath, &ulIndex)) {
+         ChildArray_T oSiblings = Node_locateChild(oNNode->oNParent,
+                                                   ulIndex, &ulIndex);
+         (void) ChildArray_removeAt(oSiblings, ulIndex);
       }
-      DynArray_free(oNNode->oDChildren);
+      oNNode->oNParent = NULL;
    }
 
-   /* remove path */
-   Path_free(oNNode->oPPath);
+   return oNNode->ulSubtreeCount;
+}
 
-   /* finally, free the struct node */
-   free(oNNode);
-   ulCount++;
+size_t Node_free(Node_T oNNode) {
+   size_t ulCount;
+
+   assert(oNNode != NULL);
+   assert(CheckerFT_Node_isValid(oNNode));
+
+   ulCount = Node_detach(oNNode);
+   Node_freeSubtree(oNNode);
    return ulCount;
 }
 
+void Node_freeTop(Node_T oNNode) {
+   size_t ulIndex;
+
+   assert(oNNode != NULL);
+   assert(oNNode->oNParent == NULL);
+
+   for(ulIndex = 0; ulIndex < Node_getNumFiles(oNNode); ulIndex++)
+      ((Node_T) ChildArray_get(oNNode->oFiles, ulIndex))->oNParent =
+         NULL;
+   for(ulIndex = 0; ulIndex < ChildArray_getLength(&oNNode->sDirs);
+       ulIndex++)
+      ((Node_T) ChildArray_get(&oNNode->sDirs, ulIndex))->oNParent =
+         NULL;
+   Node_release(oNNode);
+}
+
 Path_T Node_getPath(Node_T oNNode) {
    assert(oNNode != NULL);
 
@@ -407,22 +558,53 @@ Path_T Node_getPath(Node_T oNNode) {
 
 boolean Node_hasChild(Node_T oNParent, Path_T oPPath,
                          size_t *pulChildID) {
+   const char *pcKey;
+
    assert(oNParent != NULL);
    assert(oPPath != NULL);
    assert(pulChildID != NULL);
 
+   /* children are keyed by the component just below oNParent */
+   pcKey = Path_getComponent(oPPath, Path_getDepth(oNParent->oPPath));
+   return Node_findChild(oNParent, pcKey, pulChildID);
+}
+
+boolean Node_findChild(Node_T oNParent, const char *pcComponent,
+                       size_t *pulChildID) {
+   size_t ulFiles;
+   size_t ulIndex;
+
+   assert(oNParent != NULL);
+   assert(pulChildID != NULL);
+
    /* assert(!(oNParent->bisFile)); */
 
    if (oNParent->bisFile)
    {
       return FALSE;
    }
-   
 
-   /* *pulChildID is the index into oNParent->oDChildren */
-   return DynArray_bsearch(oNParent->oDChildren,
-            (char*) Path_getPathname(oPPath), pulChildID,
-            (int (*)(const void*,const void*)) Node_compareString);
+   if(pcComponent == NULL) {
+      *pulChildID = 0;
+      return FALSE;
+   }
+
+   /* most lookups are on the way down to something deeper, so the
+      directories are searched first; a child's identifier is its
+      index into oNParent->oFiles, or the number of files plus its
+      index into oNParent->sDirs */
+   ulFiles = Node_getNumFiles(oNParent);
+   if(ChildArray_bsearch(&oNParent->sDirs, pcComponent, &ulIndex)) {
+      *pulChildID = ulFiles + ulIndex;
+      return TRUE;
+   }
+   if(oNParent->oFiles != NULL &&
+      ChildArray_bsearch(oNParent->oFiles, pcComponent, pulChildID))
+      return TRUE;
+
+   /* the identifier that a new directory would have */
+   *pulChildID = ulFiles + ulIndex;
+   return FALSE;
 }
 
 size_t Node_getNumChildren(Node_T oNParent) {
@@ -433,7 +615,40 @@ size_t Node_getNumChildren(Node_T oNParent) {
       return 0;
    }
 
-   return DynArray_getLength(oNParent->oDChildren);
+   return Node_getNumFiles(oNParent)
+          + ChildArray_getLength(&oNParent->sDirs);
+}
+
+size_t Node_getNumFiles(Node_T oNParent) {
+   assert(oNParent != NULL);
+
+   if(oNParent->oFiles == NULL)
+      return 0;
+   return ChildArray_getLength(oNParent->oFiles);
+}
+
+void Node_findChildrenAfter(Node_T oNParent, const char *pcName,
+                            size_t *pulFileID, size_t *pulDirID) {
+   size_t ulFiles;
+
+   assert(oNParent != NULL);
+   assert(pulFileID != NULL);
+   assert(pulDirID != NULL);
+   assert(!oNParent->bisFile);
+
+   ulFiles = Node_getNumFiles(oNParent);
+   *pulFileID = 0;
+   *pulDirID = ulFiles;
+   if(pcName == NULL)
+      return;
+
+   /* a child named pcName itself is skipped */
+   if(oNParent->oFiles != NULL &&
+      ChildArray_bsearch(oNParent->oFiles, pcName, pulFileID))
+      (*pulFileID)++;
+   if(ChildArray_bsearch(&oNParent->sDirs, pcName, pulDirID))
+      (*pulDirID)++;
+   *pulDirID += ulFiles;
 }
 
 int Node_getChild(Node_T oNParent, size_t ulChildID,
@@ -448,13 +663,14 @@ int Node_getChild(Node_T oNParent, size_t ulChildID,
       return NOT_A_DIRECTORY;
    }
 
-   /* ulChildID is the index into oNParent->oDChildren */
    if(ulChildID >= Node_getNumChildren(oNParent)) {
       *poNResult = NULL;
       return NO_SUCH_PATH;
    }
    else {
-      *poNResult = DynArray_get(oNParent->oDChildren, ulChildID);
+      ChildArray_T oChildren = Node_locateChild(oNParent, ulChildID,
+                                                &ulChildID);
+      *poNResult = ChildArray_get(oChildren, ulChildID);
       return SUCCESS;
    }
 }
@@ -465,6 +681,55 @@ Node_T Node_getParent(Node_T oNNode) {
    return oNNode->oNParent;
 }
 
+size_t Node_getEdgeDepth(Node_T oNNode) {
+   assert(oNNode != NULL);
+
+   return Path_getDepth(oNNode->oPPath) - Node_getParentDepth(oNNode);
+}
+
+size_t Node_getLinesLength(Node_T oNNode) {
+   const char *pcPath;
+   size_t ulLength;
+   size_t ulImplicit;
+   size_t ulTotal;
+
+   assert(oNNode != NULL);
+
+   pcPath = Path_getPathname(oNNode->oPPath);
+   ulLength = Path_getStrLength(oNNode->oPPath);
+   ulImplicit = Node_getEdgeDepth(oNNode) - 1;
+
+   ulTotal = ulLength + 1;
+   /* each implicit directory's path ends just before one of the
+      last ulImplicit delimiters */
+   while(ulImplicit > 0) {
+      ulLength--;
+      if(pcPath[ulLength] == '/') {
+         ulTotal += ulLength + 1;
+         ulImplicit--;
+      }
+   }
+   return ulTotal;
+}
+
+boolean Node_getText(Node_T oNNode, size_t *pulOffset,
+                     size_t *pulLength) {
+   assert(oNNode != NULL);
+   assert(pulOffset != NULL);
+   assert(pulLength != NULL);
+
+   *pulOffset = oNNode->ulTextOffset;
+   *pulLength = oNNode->ulTextLength;
+   return oNNode->bTextValid;
+}
+
+void Node_setTextOffset(Node_T oNNode, size_t ulOffset) {
+   assert(oNNode != NULL);
+
+   oNNode->ulTextOffset = ulOffset;
+   oNNode->bTextValid = TRUE;
+}
+
 int Node_compare(Node_T oNFirst, Node_T oNSecond) {
    assert(oNFirst != NULL);
    assert(oNSecond != NULL);
@@ -40,13 +40,14 @@ void * Node_replaceContents(Node_T oNNode, void * pvNewContents,
 /*
   Creates a new dir with path oPPath and parent oNParent.  Returns an
   int SUCCESS status and sets *poNResult to be the new node if
-  successful. Otherwise, sets *poNResult to NULL and returns status:
+  successful. oPPath may be more than one level below oNParent's path
+  (or, for a new root, deeper than depth 1); the new node then also
+  stands for the chain of single-child directories in between.
+  Otherwise, sets *poNResult to NULL and returns status:
   * MEMORY_ERROR if memory could not be allocated to complete request
   * CONFLICTING_PATH if oNParent's path is not an ancestor of oPPath
-  * NO_SUCH_PATH if oPPath is of depth 0
-                 or oNParent's path is not oPPath's direct parent
-                 or oNParent is NULL but oPPath is not of depth 1
-  * ALREADY_IN_TREE if oNParent already has a child with this path
+  * NO_SUCH_PATH if oPPath is no deeper than oNParent's path
+  * ALREADY_IN_TREE if oNParent already has a child on oPPath's branch
   * NOT_A_DIRECTORY if oNParent is a file
 */
 int Node_dir_new(Path_T oPPath, Node_T oNParent, Node_T *poNResult);
@@ -55,42 +56,106 @@ int Node_dir_new(Path_T oPPath, Node_T oNParent, Node_T *poNResult);
   Creates a new file with path oPPath parent oNParent, containing
   pvContents and content length of ulContentsSize. Returns an
   int SUCCESS status and sets *poNResult to be the new node if
-  successful. Otherwise, sets *poNResult to NULL and returns status:
+  successful. As with Node_dir_new, oPPath may be more than one level
+  below oNParent's path. Otherwise, sets *poNResult to NULL and
+  returns status:
   * MEMORY_ERROR if memory could not be allocated to complete request
   * CONFLICTING_PATH if oNParent's path is not an ancestor of oPPath
-  * NO_SUCH_PATH if oPPath is of depth 0
-                 or oNParent's path is not oPPath's direct parent
-                 or oNParent is NULL but oPPath is not of depth 1
-  * ALREADY_IN_TREE if oNParent already has a child with this path
+                     or if oPPath is of depth 1
+  * NO_SUCH_PATH if oPPath is no deeper than oNParent's path
+                 or oNParent is NULL
+  * ALREADY_IN_TREE if oNParent already has a child on oPPath's branch
   * NOT_A_DIRECTORY if oNParent is a file
 */
 int Node_file_new(Path_T oPPath, Node_T oNParent, Node_T *poNResult,
                      void *pvContents, size_t ulContentsSize);
+
+/*
+  Splits the chain of directories that oNNode stands for at depth
+  ulDepth, which must be strictly between the depth of oNNode's
+  parent's path and the depth of oNNode's path. A new directory node
+  with the depth-ulDepth prefix of oNNode's path takes oNNode's place
+  under its parent, and oNNode becomes its only child. Returns an int
+  SUCCESS status and sets *poNResult to be the new node if successful.
+  Otherwise, sets *poNResult to NULL, leaves oNNode unchanged, and
+  returns status:
+  * MEMORY_ERROR if memory could not be allocated to complete request
+*/
+int Node_split(Node_T oNNode, size_t ulDepth, Node_T *poNResult);
+
 /*
   Destroys and frees all memory allocated for the subtree rooted at
   oNNode, i.e., deletes this node and all its descendents. Returns the
-  number of nodes deleted.
+  number of directories and files deleted, including those that nodes
+  in the subtree stood for implicitly.
 */
 size_t Node_free(Node_T oNNode);
 
+/*
+  Unlinks oNNode from its parent, if it has one, leaving the subtree
+  rooted at it intact but parentless, in time proportional to the
+  depth of oNNode. Returns the number of directories and files in the
+  subtree, including those that nodes in it stand for implicitly.
+*/
+size_t Node_detach(Node_T oNNode);
+
+/*
+  Frees oNNode, which must have no parent, but not its children, which
+  are left parentless for the caller to free in turn.
+*/
+void Node_freeTop(Node_T oNNode);
+
 /* Returns the path object representing oNNode's absolute path. */
 Path_T Node_getPath(Node_T oNNode);
 
 /*
-  Returns TRUE if oNParent has a child with path oPPath. Returns
-  FALSE if it does not.
+  Returns TRUE if oNParent has a child on oPPath's branch, i.e., one
+  whose path has the same component as oPPath just below oNParent's
+  path (for a child directly below oNParent, a child with path
+  oPPath). Returns FALSE if it does not.
   If oNParent is a file, then returns FALSE and sets pulChildId to NULL
   If oNParent has such a child, stores in *pulChildID the child's
   identifier (as used in Node_getChild). If oNParent does not have
   such a child, stores in *pulChildID the identifier that such a
-  child _would_ have if inserted.
+  child _would_ have if inserted as a directory.
 */
 boolean Node_hasChild(Node_T oNParent, Path_T oPPath,
                          size_t *pulChildID);
 
+/*
+  Returns TRUE if oNParent has a child whose path has pcComponent, an
+  interned string, just below oNParent's path, as Node_hasChild does
+  for a path with that component. Returns FALSE if it does not, or if
+  pcComponent is NULL. Sets *pulChildID as Node_hasChild does.
+*/
+boolean Node_findChild(Node_T oNParent, const char *pcComponent,
+                       size_t *pulChildID);
+
 /* Returns the number of children that oNParent has. */
 size_t Node_getNumChildren(Node_T oNParent);
 
+/*
+  Returns the number of oNParent's children that are files directly
+  below it. Children are identified with these files first, in
+  ascending order of name, from 0 up to one less than this number;
+  the directories follow, in ascending order of first component, up
+  to one less than Node_getNumChildren. A child that stands for a
+  chain of directories counts as a directory, even if the chain ends
+  in a file.
+*/
+size_t Node_getNumFiles(Node_T oNParent);
+
+/*
+  Stores in *pulFileID the identifier of oNParent's first file child
+  whose name follows pcName in lexicographic order, or
+  Node_getNumFiles(oNParent) if there is none, and in *pulDirID that
+  of its first directory child whose first component follows pcName,
+  or Node_getNumChildren(oNParent) if there is none. pcName need not
+  be interned; if it is NULL, the first children are found.
+*/
+void Node_findChildrenAfter(Node_T oNParent, const char *pcName,
+                            size_t *pulFileID, size_t *pulDirID);
+
 /*
   Returns an int SUCCESS status and sets *poNResult to be the child
   node of oNParent with identifier ulChildID, if one exists.
@@ -106,6 +171,42 @@ int Node_getChild(Node_T oNParent, size_t ulChildID,
 */
 Node_T Node_getParent(Node_T oNNode);
 
+/*
+  Returns the number of levels between oNNode's parent's path (or the
+  empty path, for the root) and oNNode's own path. This is 1 unless
+  oNNode also stands for a chain of single-child directories above it.
+*/
+size_t Node_getEdgeDepth(Node_T oNNode);
+
+/*
+  Returns the number of characters in the lines of the string
+  representation of the FT for oNNode, one for each directory it
+  stands for and one for itself, each a path followed by a newline.
+*/
+size_t Node_getLinesLength(Node_T oNNode);
+
+/*
+  Returns TRUE if the lines of the subtree rooted at oNNode in the
+  string representation of the FT last generated are still up to
+  date, or FALSE if the subtree has changed since (or they were never
+  generated). Stores in *pulOffset where they began, relative to
+  where the lines of oNNode's parent's children did (or to the start,
+  for the root), as last set with Node_setTextOffset, and in
+  *pulLength their length, which is always current. Adding a child to
+  a node or removing one marks the node and its ancestors as out of
+  date; splitting a node keeps the lines of both parts up to date if
+  they were.
+*/
+boolean Node_getText(Node_T oNNode, size_t *pulOffset,
+                     size_t *pulLength);
+
+/*
+  Records that the lines of the subtree rooted at oNNode begin at
+  ulOffset, relative to those of its parent's children (or to the
+  start, for the root), and marks them as up to date.
+*/
+void Node_setTextOffset(Node_T oNNode, size_t ulOffset);
+
 /*
   Compares oNFirst and oNSecond lexicographically based on their paths.
   Returns <0, 0, or >0 if onFirst is "less than", "equal to", or
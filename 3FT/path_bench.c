@@ -0,0 +1,130 @@
+/*--------------------------------------------------------------------*/
+/* path_bench.c                                                       */
+/* Author: Josh Schoenberg and Jack Toubes                            */
+/*--------------------------------------------------------------------*/
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "pathscan.h"
+#include "path.h"
+
+/* The number of components in the benchmark path, and the number of
+   times each operation is repeated. */
+enum { BENCH_DEPTH = 200, BENCH_REPEATS = 200000 };
+
+/*
+  Scans pcPath a byte at a time as Path_new did before PathScan_scan,
+  with the same results as PathScan_scan.
+*/
+static int bench_scanBytes(const char *pcPath, size_t *pulOffsets,
+                           size_t ulCapacity, size_t *pulLength,
+                           size_t *pulDepth) {
+   size_t ulDepth = 0;
+   size_t i;
+
+   if(*pcPath == '\0' || *pcPath == '/')
+      return BAD_PATH;
+   for(i = 0; pcPath[i] != '\0'; i++) {
+      if(i == 0 || pcPath[i - 1] == '/') {
+         if(pcPath[i] == '/')
+            return BAD_PATH;
+         if(ulDepth < ulCapacity)
+            pulOffsets[ulDepth] = i;
+         ulDepth++;
+      }
+   }
+   if(pcPath[i - 1] == '/')
+      return BAD_PATH;
+   *pulLength = i;
+   *pulDepth = ulDepth;
+   return SUCCESS;
+}
+
+/* Returns the seconds of processor time since uStart. */
+static double bench_since(clock_t uStart) {
+   return (double) (clock() - uStart) / CLOCKS_PER_SEC;
+}
+
+/* Times the scanners, Path_parseInto, and Path_new on a path of
+   BENCH_DEPTH components, printing the results to stdout.
+   Returns 0, or EXIT_FAILURE if the scanners disagree or memory runs
+   out. */
+int main(void) {
+   static size_t aulOffsets[BENCH_DEPTH];
+   static size_t aulExpected[BENCH_DEPTH];
+   char *pcPath;
+   size_t ulLength, ulDepth, ulExpectedLength, ulExpectedDepth;
+   size_t i;
+   PathView sView;
+   Path_T oPPath;
+   clock_t uStart;
+   long lSum = 0;
+
+   /* components of 9 or 10 characters, about 2 KB in all */
+   pcPath = malloc(BENCH_DEPTH * 11);
+   if(pcPath == NULL) {
+      fprintf(stderr, "out of memory\n");
+      return EXIT_FAILURE;
+   }
+   pcPath[0] = '\0';
+   for(i = 0; i < BENCH_DEPTH; i++)
+      sprintf(pcPath + strlen(pcPath), "%scomp%05lu",
+              i == 0 ? "" : "/", (unsigned long) i);
+
+   if(bench_scanBytes(pcPath, aulExpected, BENCH_DEPTH,
+                      &ulExpectedLength, &ulExpectedDepth) != SUCCESS ||
+      PathScan_scan(pcPath, aulOffsets, BENCH_DEPTH, &ulLength,
+                    &ulDepth) != SUCCESS ||
+      ulLength != ulExpectedLength || ulDepth != ulExpectedDepth ||
+      memcmp(aulOffsets, aulExpected, sizeof(aulOffsets)) != 0) {
+      fprintf(stderr, "the scanners disagree\n");
+      return EXIT_FAILURE;
+   }
+   printf("path of %lu components, %lu bytes, %d repeats\n",
+          (unsigned long) ulDepth, (unsigned long) ulLength,
+          BENCH_REPEATS);
+
+   uStart = clock();
+   for(i = 0; i < BENCH_REPEATS; i++) {
+      (void) bench_scanBytes(pcPath, aulOffsets, BENCH_DEPTH,
+                             &ulLength, &ulDepth);
+      lSum += (long) aulOffsets[i % BENCH_DEPTH];
+   }
+   printf("byte-at-a-time scan: %.3f s\n", bench_since(uStart));
+
+   uStart = clock();
+   for(i = 0; i < BENCH_REPEATS; i++) {
+      (void) PathScan_scan(pcPath, aulOffsets, BENCH_DEPTH,
+                           &ulLength, &ulDepth);
+      lSum += (long) aulOffsets[i % BENCH_DEPTH];
+   }
+   printf("PathScan_scan:       %.3f s\n", bench_since(uStart));
+
+   uStart = clock();
+   for(i = 0; i < BENCH_REPEATS; i++) {
+      (void) Path_parseInto(pcPath, &sView);
+      lSum += (long) Path_getViewDepth(&sView);
+   }
+   printf("Path_parseInto:      %.3f s\n", bench_since(uStart));
+
+   uStart = clock();
+   for(i = 0; i < BENCH_REPEATS / 10; i++) {
+      if(Path_new(pcPath, &oPPath) != SUCCESS) {
+         fprintf(stderr, "out of memory\n");
+         return EXIT_FAILURE;
+      }
+      lSum += (long) Path_getDepth(oPPath);
+      Path_free(oPPath);
+   }
+   printf("Path_new/Path_free:  %.3f s (%d repeats)\n",
+          bench_since(uStart), BENCH_REPEATS / 10);
+
+   /* keep the loops from being optimized away */
+   if(lSum == 0)
+      printf("%ld\n", lSum);
+   free(pcPath);
+   return 0;
+}
@@ -0,0 +1 @@
+../0shared/pathscan.c
\ No newline at end of file